@@ -0,0 +1,480 @@
+/*
+*   Description:
+*
+*      HOOPS Exchange Polygonica Bridge benchmarks
+*      Helpers shared by the benchmarks: start up and shut down of HOOPS Exchange
+*      and Polygonica, timing, and synthetic assemblies built with the
+*      HOOPS Exchange Create API so that no CAD file is needed.
+*
+*      Define INITIALIZE_A3D_API and include <A3DSDKIncludes.h> before this header
+*      in the benchmark's only translation unit.
+*/
+#pragma once
+
+#include "pg/pgapi.h"
+#include "pg/pgrender.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__linux__)
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#endif
+
+/*********************************************************************/
+/***session***********************************************************/
+/*********************************************************************/
+
+/* Loads HOOPS Exchange and initialises Polygonica for the lifetime of the object */
+struct BenchmarkSession
+{
+   BenchmarkSession() : m_sLoader(stLibraryPath().c_str())
+   {
+      if (m_sLoader.m_eSDKStatus != A3D_SUCCESS)
+      {
+         fprintf(stderr, "Failed to load HOOPS Exchange (%d)\n", (int)m_sLoader.m_eSDKStatus);
+         return;
+      }
+
+      PTInitialiseOpts sInitialiseOpts;
+      PMInitInitialiseOpts(&sInitialiseOpts);
+      if (PFInitialise(PV_LICENSE, &sInitialiseOpts) != PV_STATUS_OK)
+      {
+         fprintf(stderr, "Failed to initialise Polygonica\n");
+         return;
+      }
+      m_bReady = true;
+   }
+
+   ~BenchmarkSession()
+   {
+      if (m_bReady)
+      {
+         PFTerminate();
+      }
+   }
+
+   static std::string stLibraryPath()
+   {
+      const char* pcInstallDir = getenv("HEXCHANGE_INSTALL_DIR");
+      std::string sPath = pcInstallDir ? pcInstallDir : "";
+#ifdef _WIN32
+      return sPath + "\\bin\\win64_v142";
+#else
+      return sPath + "/bin/linux64";
+#endif
+   }
+
+   A3DSDKHOOPSExchangeLoader m_sLoader;
+   bool m_bReady = false;
+};
+/***BenchmarkSession**************************************************/
+
+/*********************************************************************/
+/***timing************************************************************/
+/*********************************************************************/
+
+/* Returns the shortest wall time in seconds of uiRepeats calls of fnRun; fnReset runs untimed after each call */
+template <typename Run, typename Reset>
+double BenchmarkBestSeconds(unsigned uiRepeats, Run fnRun, Reset fnReset)
+{
+   double dBest = 0.;
+   for (unsigned ui = 0; ui < uiRepeats; ui++)
+   {
+      auto tStart = std::chrono::steady_clock::now();
+      fnRun();
+      double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+      fnReset();
+      if (ui == 0 || dSeconds < dBest)
+      {
+         dBest = dSeconds;
+      }
+   }
+   return dBest;
+}
+/***BenchmarkBestSeconds**********************************************/
+
+/* Returns the resident memory of the process in bytes, or 0 where it is not known. On glibc the freed heap is
+   first returned to the system so that successive readings can be compared */
+inline size_t BenchmarkResidentBytes()
+{
+#ifdef _WIN32
+   PROCESS_MEMORY_COUNTERS sCounters;
+   return GetProcessMemoryInfo(GetCurrentProcess(), &sCounters, sizeof(sCounters)) ? (size_t)sCounters.WorkingSetSize : 0;
+#elif defined(__linux__)
+#ifdef __GLIBC__
+   malloc_trim(0);
+#endif
+   size_t uiPages = 0, uiResident = 0;
+   FILE* pFile = fopen("/proc/self/statm", "r");
+   if (!pFile)
+   {
+      return 0;
+   }
+   if (fscanf(pFile, "%zu %zu", &uiPages, &uiResident) != 2)
+   {
+      uiResident = 0;
+   }
+   fclose(pFile);
+   return uiResident * (size_t)sysconf(_SC_PAGESIZE);
+#else
+   return 0;
+#endif
+}
+/***BenchmarkResidentBytes********************************************/
+
+/*********************************************************************/
+/***synthetic assemblies**********************************************/
+/*********************************************************************/
+
+/* Creates a poly brep with a single triangle */
+inline A3DRiRepresentationItem* BenchmarkCreateTriangleRepItem()
+{
+   double adCoords[] = { 0., 0., 0., 1., 0., 0., 0., 1., 0. };
+   double adNormals[] = { 0., 0., 1. };
+   A3DUns32 auiIndexes[] = { 0, 0, 0, 3, 0, 6 };
+   A3DUns32 auiSizes[] = { 1 };
+
+   A3DTessFaceData sFaceData;
+   A3D_INITIALIZE_DATA(A3DTessFaceData, sFaceData);
+   sFaceData.m_usUsedEntitiesFlags = kA3DTessFaceDataTriangle;
+   sFaceData.m_uiSizesTriangulatedSize = 1;
+   sFaceData.m_puiSizesTriangulated = auiSizes;
+
+   A3DTess3DData sTessData;
+   A3D_INITIALIZE_DATA(A3DTess3DData, sTessData);
+   sTessData.m_uiNormalSize = 3;
+   sTessData.m_pdNormals = adNormals;
+   sTessData.m_uiTriangulatedIndexSize = 6;
+   sTessData.m_puiTriangulatedIndexes = auiIndexes;
+   sTessData.m_uiFaceTessSize = 1;
+   sTessData.m_psFaceTessData = &sFaceData;
+
+   A3DTess3D* pTess = NULL;
+   A3DTess3DCreate(&sTessData, &pTess);
+
+   A3DTessBaseData sBaseData;
+   A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseData);
+   sBaseData.m_uiCoordSize = 9;
+   sBaseData.m_pdCoords = adCoords;
+   A3DTessBaseSet(pTess, &sBaseData);
+
+   A3DRiPolyBrepModelData sPolyBrepData;
+   A3D_INITIALIZE_DATA(A3DRiPolyBrepModelData, sPolyBrepData);
+   A3DRiPolyBrepModel* pRepItem = NULL;
+   A3DRiPolyBrepModelCreate(&sPolyBrepData, &pRepItem);
+
+   A3DRiRepresentationItemData sRiData;
+   A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sRiData);
+   sRiData.m_pTessBase = pTess;
+   A3DRiRepresentationItemSet(pRepItem, &sRiData);
+
+   return pRepItem;
+}
+
+/* Creates a poly brep with a flat grid of at least uiTriangles triangles at height dZ, one face per row of the grid.
+   A fraction dFans of the rows, drawn with uiSeed, are fans of one quad each and a fraction dStrips are strips.
+   With bSeparateFaces each face has its own copy of its vertices, as Exchange tessellations have along the
+   boundaries of the CAD faces */
+inline A3DRiRepresentationItem* BenchmarkCreateGridRepItem(size_t uiTriangles, double dZ, size_t& uiCreated,
+                                                           double dFans = 0., double dStrips = 0., unsigned uiSeed = 0,
+                                                           bool bSeparateFaces = false)
+{
+   size_t uiColumns = 1;
+   while (2 * uiColumns * uiColumns < uiTriangles)
+   {
+      uiColumns++;
+   }
+   size_t uiRows = std::max<size_t>(1, (uiTriangles + 2 * uiColumns - 1) / (2 * uiColumns));
+   uiCreated = 2 * uiRows * uiColumns;
+
+   std::vector<double> adCoords;
+   auto fnAddRow = [&](size_t uiRow)
+   {
+      for (size_t uiColumn = 0; uiColumn <= uiColumns; uiColumn++)
+      {
+         adCoords.insert(adCoords.end(), { (double)uiColumn, (double)uiRow, dZ });
+      }
+   };
+   for (size_t uiRow = 0; uiRow <= uiRows && !bSeparateFaces; uiRow++)
+   {
+      fnAddRow(uiRow);
+   }
+   double adNormals[] = { 0., 0., 1. };
+
+   // A normal index, then a coordinate index, for each corner
+   std::mt19937 rng(uiSeed);
+   std::uniform_real_distribution<double> sFlavour(0., 1.);
+   std::vector<A3DUns32> auiIndexes;
+   std::vector<A3DTessFaceData> asFaces(uiRows);
+   std::vector<A3DUns32> auiSizes;
+   std::vector<size_t> auiSizeStarts(uiRows);
+   for (size_t uiRow = 0; uiRow < uiRows; uiRow++)
+   {
+      double dFlavour = (dFans > 0. || dStrips > 0.) ? sFlavour(rng) : 1.;
+      A3DTessFaceData& sFaceData = asFaces[uiRow];
+      A3D_INITIALIZE_DATA(A3DTessFaceData, sFaceData);
+      sFaceData.m_uiStartTriangulated = (A3DUns32)auiIndexes.size();
+      auiSizeStarts[uiRow] = auiSizes.size();
+
+      A3DUns32 uiRowStart = (A3DUns32)(3 * uiRow * (uiColumns + 1));
+      if (bSeparateFaces)
+      {
+         uiRowStart = (A3DUns32)adCoords.size();
+         fnAddRow(uiRow);
+         fnAddRow(uiRow + 1);
+      }
+      A3DUns32 uiAboveStart = uiRowStart + (A3DUns32)(3 * (uiColumns + 1));
+      if (dFlavour < dFans)
+      {
+         sFaceData.m_usUsedEntitiesFlags = kA3DTessFaceDataTriangleFan;
+         auiSizes.push_back((A3DUns32)uiColumns);
+         for (size_t uiColumn = 0; uiColumn < uiColumns; uiColumn++)
+         {
+            A3DUns32 uiCorner = uiRowStart + (A3DUns32)(3 * uiColumn);
+            A3DUns32 uiAbove = uiAboveStart + (A3DUns32)(3 * uiColumn);
+            auiSizes.push_back(4);
+            auiIndexes.insert(auiIndexes.end(), { 0, uiCorner, 0, uiCorner + 3, 0, uiAbove + 3, 0, uiAbove });
+         }
+      }
+      else if (dFlavour < dFans + dStrips)
+      {
+         sFaceData.m_usUsedEntitiesFlags = kA3DTessFaceDataTriangleStripe;
+         auiSizes.insert(auiSizes.end(), { 1, (A3DUns32)(2 * (uiColumns + 1)) });
+         for (size_t uiColumn = 0; uiColumn <= uiColumns; uiColumn++)
+         {
+            auiIndexes.insert(auiIndexes.end(), { 0, uiRowStart + (A3DUns32)(3 * uiColumn), 0, uiAboveStart + (A3DUns32)(3 * uiColumn) });
+         }
+      }
+      else
+      {
+         sFaceData.m_usUsedEntitiesFlags = kA3DTessFaceDataTriangle;
+         auiSizes.push_back((A3DUns32)(2 * uiColumns));
+         for (size_t uiColumn = 0; uiColumn < uiColumns; uiColumn++)
+         {
+            A3DUns32 uiCorner = uiRowStart + (A3DUns32)(3 * uiColumn);
+            A3DUns32 uiAbove = uiAboveStart + (A3DUns32)(3 * uiColumn);
+            auiIndexes.insert(auiIndexes.end(), { 0, uiCorner, 0, uiCorner + 3, 0, uiAbove + 3,
+                                                  0, uiCorner, 0, uiAbove + 3, 0, uiAbove });
+         }
+      }
+      sFaceData.m_uiSizesTriangulatedSize = (A3DUns32)(auiSizes.size() - auiSizeStarts[uiRow]);
+   }
+   for (size_t uiRow = 0; uiRow < uiRows; uiRow++)
+   {
+      asFaces[uiRow].m_puiSizesTriangulated = &auiSizes[auiSizeStarts[uiRow]];
+   }
+
+   A3DTess3DData sTessData;
+   A3D_INITIALIZE_DATA(A3DTess3DData, sTessData);
+   sTessData.m_uiNormalSize = 3;
+   sTessData.m_pdNormals = adNormals;
+   sTessData.m_uiTriangulatedIndexSize = (A3DUns32)auiIndexes.size();
+   sTessData.m_puiTriangulatedIndexes = auiIndexes.data();
+   sTessData.m_uiFaceTessSize = (A3DUns32)asFaces.size();
+   sTessData.m_psFaceTessData = asFaces.data();
+
+   A3DTess3D* pTess = NULL;
+   A3DTess3DCreate(&sTessData, &pTess);
+
+   A3DTessBaseData sBaseData;
+   A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseData);
+   sBaseData.m_uiCoordSize = (A3DUns32)adCoords.size();
+   sBaseData.m_pdCoords = adCoords.data();
+   A3DTessBaseSet(pTess, &sBaseData);
+
+   A3DRiPolyBrepModelData sPolyBrepData;
+   A3D_INITIALIZE_DATA(A3DRiPolyBrepModelData, sPolyBrepData);
+   A3DRiPolyBrepModel* pRepItem = NULL;
+   A3DRiPolyBrepModelCreate(&sPolyBrepData, &pRepItem);
+
+   A3DRiRepresentationItemData sRiData;
+   A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sRiData);
+   sRiData.m_pTessBase = pTess;
+   A3DRiRepresentationItemSet(pRepItem, &sRiData);
+
+   return pRepItem;
+}
+
+/* Creates a translation */
+inline A3DMiscCartesianTransformation* BenchmarkCreateLocation(double dX, double dY, double dZ)
+{
+   A3DMiscCartesianTransformationData sData;
+   A3D_INITIALIZE_DATA(A3DMiscCartesianTransformationData, sData);
+   sData.m_sOrigin.m_dX = dX;
+   sData.m_sOrigin.m_dY = dY;
+   sData.m_sOrigin.m_dZ = dZ;
+   sData.m_sXVector.m_dX = 1.;
+   sData.m_sYVector.m_dY = 1.;
+   sData.m_sScale.m_dX = sData.m_sScale.m_dY = sData.m_sScale.m_dZ = 1.;
+
+   A3DMiscCartesianTransformation* pLocation = NULL;
+   A3DMiscCartesianTransformationCreate(&sData, &pLocation);
+   return pLocation;
+}
+
+/* Creates a part definition holding the given representation items */
+inline A3DAsmPartDefinition* BenchmarkCreatePart(std::vector<A3DRiRepresentationItem*> apRepItems)
+{
+   A3DAsmPartDefinitionData sData;
+   A3D_INITIALIZE_DATA(A3DAsmPartDefinitionData, sData);
+   sData.m_uiRepItemsSize = (A3DUns32)apRepItems.size();
+   sData.m_ppRepItems = apRepItems.data();
+
+   A3DAsmPartDefinition* pPart = NULL;
+   A3DAsmPartDefinitionCreate(&sData, &pPart);
+   return pPart;
+}
+
+/* Creates a product occurrence; every argument may be empty or NULL */
+inline A3DAsmProductOccurrence* BenchmarkCreateOccurrence(std::vector<A3DAsmProductOccurrence*> apChildren,
+                                                          A3DAsmPartDefinition* pPart,
+                                                          A3DAsmProductOccurrence* pPrototype,
+                                                          A3DMiscCartesianTransformation* pLocation)
+{
+   A3DAsmProductOccurrenceData sData;
+   A3D_INITIALIZE_DATA(A3DAsmProductOccurrenceData, sData);
+   sData.m_uiPOccurrencesSize = (A3DUns32)apChildren.size();
+   sData.m_ppPOccurrences = apChildren.data();
+   sData.m_pPart = pPart;
+   sData.m_pPrototype = pPrototype;
+   sData.m_pLocation = pLocation;
+
+   A3DAsmProductOccurrence* pOccurrence = NULL;
+   A3DAsmProductOccurrenceCreate(&sData, &pOccurrence);
+   return pOccurrence;
+}
+
+/* Creates a model file from its root occurrences */
+inline A3DAsmModelFile* BenchmarkCreateModelFile(std::vector<A3DAsmProductOccurrence*> apRoots)
+{
+   A3DAsmModelFileData sData;
+   A3D_INITIALIZE_DATA(A3DAsmModelFileData, sData);
+   sData.m_uiPOccurrencesSize = (A3DUns32)apRoots.size();
+   sData.m_ppPOccurrences = apRoots.data();
+
+   A3DAsmModelFile* pModelFile = NULL;
+   A3DAsmModelFileCreate(&sData, &pModelFile);
+   return pModelFile;
+}
+
+/* The shape of an assembly built by BenchmarkCreateAssembly */
+struct BenchmarkAssemblyShape
+{
+   unsigned m_uiDepth = 3;        // levels of sub-assemblies above the parts, each level multiplying the instances by the fan-out
+   unsigned m_uiFanOut = 4;       // child occurrences of each sub-assembly
+   double m_dInstancing = 0.75;   // probability that an instance reuses an earlier part definition rather than a new one
+   size_t m_uiTriangles = 1000;   // triangles of each part
+   double m_dFans = 0.25;         // fraction of the faces that are fans
+   double m_dStrips = 0.25;       // fraction of the faces that are strips, the others being triangles
+   unsigned m_uiColours = 16;     // distinct colours given to the instances, none if 0
+   bool m_bSeparateFaces = false; // each face of a part has its own copy of its vertices
+   unsigned m_uiSeed = 1;         // the same seed and shape give the same assembly
+};
+/***BenchmarkAssemblyShape********************************************/
+
+/* An assembly built by BenchmarkCreateAssembly, to delete with A3DAsmModelFileDelete */
+struct BenchmarkAssembly
+{
+   A3DAsmModelFile* m_pModelFile = NULL;
+   size_t m_uiParts = 0;               // distinct part definitions
+   size_t m_uiInstances = 0;           // occurrences of the part definitions
+   size_t m_uiTriangles = 0;           // triangles of the distinct part definitions
+   size_t m_uiInstancedTriangles = 0;  // triangles of all the instances
+};
+/***BenchmarkAssembly*************************************************/
+
+/* Creates an assembly of the given shape: a tree of sub-assemblies whose leaves instance the parts */
+inline BenchmarkAssembly BenchmarkCreateAssembly(const BenchmarkAssemblyShape& sShape)
+{
+   BenchmarkAssembly sAssembly;
+   std::mt19937 rng(sShape.m_uiSeed);
+   std::uniform_real_distribution<double> sUnit(0., 1.);
+
+   std::vector<A3DUns32> auiStyles;
+   for (unsigned ui = 0; ui < sShape.m_uiColours; ui++)
+   {
+      A3DGraphRgbColorData sColour;
+      A3D_INITIALIZE_DATA(A3DGraphRgbColorData, sColour);
+      sColour.m_dRed = sUnit(rng);
+      sColour.m_dGreen = sUnit(rng);
+      sColour.m_dBlue = sUnit(rng);
+      A3DGraphStyleData sStyle;
+      A3D_INITIALIZE_DATA(A3DGraphStyleData, sStyle);
+      A3DGlobalInsertGraphRgbColor(&sColour, &sStyle.m_uiRgbColorIndex);
+      A3DUns32 uiStyle = A3D_DEFAULT_STYLE_INDEX;
+      A3DGlobalInsertGraphStyle(&sStyle, &uiStyle);
+      auiStyles.push_back(uiStyle);
+   }
+
+   std::vector<A3DAsmPartDefinition*> apParts;
+   std::vector<size_t> auiPartTriangles;
+   std::function<A3DAsmProductOccurrence*(unsigned)> fnCreate = [&](unsigned uiLevel) -> A3DAsmProductOccurrence*
+   {
+      A3DMiscCartesianTransformation* pLocation = BenchmarkCreateLocation(100. * sUnit(rng), 100. * sUnit(rng), 100. * sUnit(rng));
+      if (uiLevel < sShape.m_uiDepth)
+      {
+         std::vector<A3DAsmProductOccurrence*> apChildren;
+         for (unsigned ui = 0; ui < sShape.m_uiFanOut; ui++)
+         {
+            apChildren.push_back(fnCreate(uiLevel + 1));
+         }
+         return BenchmarkCreateOccurrence(apChildren, NULL, NULL, pLocation);
+      }
+
+      // Each new part is at its own height so that no two tessellations are identical
+      size_t uiPart = apParts.size();
+      if (apParts.empty() || sUnit(rng) >= sShape.m_dInstancing)
+      {
+         size_t uiCreated = 0;
+         apParts.push_back(BenchmarkCreatePart({ BenchmarkCreateGridRepItem(sShape.m_uiTriangles, (double)uiPart, uiCreated,
+                                                                            sShape.m_dFans, sShape.m_dStrips,
+                                                                            sShape.m_uiSeed + (unsigned)uiPart,
+                                                                            sShape.m_bSeparateFaces) }));
+         auiPartTriangles.push_back(uiCreated);
+         sAssembly.m_uiTriangles += uiCreated;
+      }
+      else
+      {
+         uiPart = std::uniform_int_distribution<size_t>(0, apParts.size() - 1)(rng);
+      }
+      sAssembly.m_uiInstances++;
+      sAssembly.m_uiInstancedTriangles += auiPartTriangles[uiPart];
+
+      A3DAsmProductOccurrence* pLeaf = BenchmarkCreateOccurrence({}, apParts[uiPart], NULL, pLocation);
+      if (!auiStyles.empty())
+      {
+         A3DGraphicsData sGraphicsData;
+         A3D_INITIALIZE_DATA(A3DGraphicsData, sGraphicsData);
+         sGraphicsData.m_uiLayerIndex = (A3DUns32)-1;
+         sGraphicsData.m_uiStyleIndex = auiStyles[std::uniform_int_distribution<size_t>(0, auiStyles.size() - 1)(rng)];
+         sGraphicsData.m_usBehaviour = kA3DGraphicsShow;
+         A3DRootBaseWithGraphicsData sBaseData;
+         A3D_INITIALIZE_DATA(A3DRootBaseWithGraphicsData, sBaseData);
+         A3DGraphicsCreate(&sGraphicsData, &sBaseData.m_pGraphics);
+         A3DRootBaseWithGraphicsSet(pLeaf, &sBaseData);
+      }
+      return pLeaf;
+   };
+
+   sAssembly.m_pModelFile = BenchmarkCreateModelFile({ fnCreate(0) });
+   sAssembly.m_uiParts = apParts.size();
+   return sAssembly;
+}
+/***BenchmarkCreateAssembly*******************************************/
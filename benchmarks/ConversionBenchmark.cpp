@@ -0,0 +1,126 @@
+/*
+*   Description:
+*
+*      Conversion benchmark
+*      Times A3DModelCreatePGWorld end to end on a synthetic assembly and reports its
+*      throughput in instances and triangles per second.
+*
+*      The assembly has one part definition per distinct part, each holding a poly brep
+*      with a grid of triangles, and every part is instanced several times under a group
+*      occurrence of the root. The PTSolid of each part is built once and then instanced.
+*
+*      Usage: ConversionBenchmark [parts = 200] [triangles per part = 5000] [instances per part = 20]
+*                                 [threads = 0] [repeats = 3] [mesh cache directory]
+*      With a mesh cache directory the first conversion writes the cache and is timed on its own; the
+*      others read their meshes from it.
+*      Built against the stand-in SDK it also reports the Exchange and Polygonica calls
+*      of one conversion.
+*/
+
+#define INITIALIZE_A3D_API
+#include <A3DSDKIncludes.h>
+
+#include "BenchmarkCommon.hpp"
+#include "ExchangePolygonicaBridge.h"
+
+#ifdef BRIDGE_STANDIN_SDK
+#include "StandInRecorder.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+int main(int iArgc, char** ppcArgv)
+{
+   size_t uiParts = iArgc > 1 ? (size_t)atol(ppcArgv[1]) : 200;
+   size_t uiTriangles = iArgc > 2 ? (size_t)atol(ppcArgv[2]) : 5000;
+   size_t uiInstances = iArgc > 3 ? (size_t)atol(ppcArgv[3]) : 20;
+   unsigned uiThreads = iArgc > 4 ? (unsigned)atoi(ppcArgv[4]) : 0;
+   unsigned uiRepeats = iArgc > 5 ? (unsigned)atoi(ppcArgv[5]) : 3;
+   const char* pcMeshCache = iArgc > 6 ? ppcArgv[6] : NULL;
+
+   BenchmarkSession sSession;
+   if (!sSession.m_bReady)
+   {
+      return 1;
+   }
+
+   // Each part is at its own height so that no two tessellations are identical
+   size_t uiPartTriangles = 0;
+   std::vector<A3DAsmProductOccurrence*> apGroups;
+   for (size_t uiPart = 0; uiPart < uiParts; uiPart++)
+   {
+      size_t uiCreated = 0;
+      A3DAsmPartDefinition* pPart = BenchmarkCreatePart({ BenchmarkCreateGridRepItem(uiTriangles, (double)uiPart, uiCreated) });
+      uiPartTriangles += uiCreated;
+
+      std::vector<A3DAsmProductOccurrence*> apInstances;
+      for (size_t uiInstance = 0; uiInstance < uiInstances; uiInstance++)
+      {
+         apInstances.push_back(BenchmarkCreateOccurrence({}, pPart, NULL, BenchmarkCreateLocation(0., 0., 1000. * (double)uiInstance)));
+      }
+      apGroups.push_back(BenchmarkCreateOccurrence(apInstances, NULL, NULL, BenchmarkCreateLocation((double)uiPart, 0., 0.)));
+   }
+   A3DAsmModelFile* pModelFile = BenchmarkCreateModelFile({ BenchmarkCreateOccurrence(apGroups, NULL, NULL, NULL) });
+
+   PTEnvironment environment = PV_ENTITY_NULL;
+   PFEnvironmentCreate(NULL, &environment);
+
+   A3DPolygonicaOptions pgOpts;
+   pgOpts.m_Environment = environment;
+   pgOpts.m_uiThreadCount = uiThreads;
+   PFWorldCreate(environment, NULL, &pgOpts.m_World);
+
+   size_t uiEntities = 0;
+   auto fnConvert = [&]()
+   {
+#ifdef BRIDGE_STANDIN_SDK
+      StandInResetCallCounts();
+#endif
+      A3DModelCreatePGWorld(pModelFile, pgOpts);
+      uiEntities = pgOpts.m_entities.size();
+   };
+   auto fnDestroy = [&]()
+   {
+      A3DDestroyBridgeWorldEntities(pgOpts);
+      A3DDestroyBridgeSolids(pgOpts);
+      A3DDestroyBridgeData(pgOpts);
+      pgOpts.m_iTopoFaceCount = 0;
+   };
+
+   if (pcMeshCache)
+   {
+      // The key names the synthetic model, whose meshes depend only on the parts and their triangles
+      pgOpts.m_sMeshCacheDirectory = pcMeshCache;
+      pgOpts.m_sMeshCacheKey = "ConversionBenchmark-" + std::to_string(uiParts) + "-" + std::to_string(uiTriangles);
+      remove((pgOpts.m_sMeshCacheDirectory + "/" + pgOpts.m_sMeshCacheKey + ".a3dmesh").c_str());
+      double dColdSeconds = BenchmarkBestSeconds(1, fnConvert, fnDestroy);
+      printf("writing the mesh cache: %.4f seconds\n", dColdSeconds);
+   }
+
+   double dSeconds = BenchmarkBestSeconds(uiRepeats, fnConvert, fnDestroy);
+   if (pcMeshCache)
+   {
+      printf("representation items read from the mesh cache: %zu\n", pgOpts.m_uiMeshCacheHits);
+   }
+
+   // Triangles built once per part, and triangles placed in the world once per instance
+   double dInstanced = uiParts ? (double)uiPartTriangles * (double)uiEntities / (double)uiParts : 0.;
+   printf("%8s %10s %12s %14s %8s %10s %14s %16s %16s\n", "parts", "instances", "triangles", "inst.triangles",
+          "threads", "seconds", "instances/s", "triangles/s", "inst.triangles/s");
+   printf("%8zu %10zu %12zu %14.0f %8u %10.4f %14.0f %16.0f %16.0f\n", uiParts, uiEntities, uiPartTriangles, dInstanced,
+          uiThreads, dSeconds, (double)uiEntities / dSeconds, (double)uiPartTriangles / dSeconds, dInstanced / dSeconds);
+
+#ifdef BRIDGE_STANDIN_SDK
+   printf("calls of the last conversion: Exchange %llu, Polygonica %llu, PFSolidCreateFromMesh %llu, PFWorldAddEntity %llu\n",
+          StandInGetExchangeCallCount(), StandInGetPolygonicaCallCount(), StandInGetCallCount("PFSolidCreateFromMesh"),
+          StandInGetCallCount("PFWorldAddEntity"));
+#endif
+
+   PFWorldDestroy(pgOpts.m_World);
+   PFEnvironmentDestroy(environment);
+   A3DAsmModelFileDelete(pModelFile);
+   return 0;
+}
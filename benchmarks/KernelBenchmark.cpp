@@ -0,0 +1,1172 @@
+/*
+*   Description:
+*
+*      Kernel benchmark
+*      Times the inner kernels of the bridge on synthetic, reproducible inputs:
+*
+*      IndicesPerFaceAsTriangles/<flavour> - one flavour of face tessellation per kernel   ns/triangle
+*                                            after checking it against a reference decoder on random faces
+*      MultiplyMatrix                      - chained 4x4 compositions                       ns/compose
+*      stTransform                         - Cartesian transformations composed by a traversal  ns/call
+*      LookupRenderStyleByColor            - lookups among 256 colours                      ns/lookup
+*      stReorderMesh                       - a scattered mesh of 512k triangles             ns/triangle
+*      PFSolidCreateFromMesh/<order>       - that mesh scattered and reordered              ns/triangle
+*      PFSolidBoolean/<order>              - a box subtracted from the solid of that mesh   ns/triangle
+*      PFSolidBoolean/slice/<order>        - the solid intersected with a thin slab         ns/triangle
+*      A3DDestroyBridge*                   - the destroy functions after a conversion       ns/entity
+*
+*      Usage: KernelBenchmark [--json results.json] [--baseline baseline.json] [--threshold percent = 10]
+*                             [--repeats n = 5] [--filter text] [--check tessellations = 200]
+*      --json writes the results as JSON. --baseline compares them with a file written by --json and
+*      returns 2 if a kernel is slower than its baseline by more than the threshold. --check sets the random
+*      tessellations IndicesPerFaceAsTriangles and stDecodeRepresentationItem, with and without a thread pool, are checked
+*      on; the benchmark returns 1 if they differ from the reference. With --check, a seeded assembly is also converted
+*      on one thread and on four, and on four through a mesh cache written to and read from the current directory; the
+*      benchmark returns 1 if the conversions differ. The PFSolidBoolean kernels are only built against the real
+*      Polygonica, the stand-in SDK having no Boolean operations.
+*/
+
+#define INITIALIZE_A3D_API
+#include <A3DSDKIncludes.h>
+
+#include "BenchmarkCommon.hpp"
+#include "ExchangePolygonicaBridge.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct KernelResult
+{
+   std::string m_sName;
+   const char* m_pcUnit;
+   double m_dValue;
+   size_t m_uiOperations;
+};
+/***KernelResult******************************************************/
+
+/*********************************************************************/
+/***tessellations*****************************************************/
+/*********************************************************************/
+
+/* A tessellation of one flavour, with only the index data IndicesPerFaceAsTriangles reads */
+struct KernelTessellation
+{
+   std::vector<A3DUns32> m_auiIndexes;
+   std::vector<A3DUns32> m_auiSizes;
+   std::vector<A3DTessFaceData> m_asFaces;
+   A3DTess3DData m_sData;
+   size_t m_uiTriangles = 0;
+};
+/***KernelTessellation************************************************/
+
+enum KernelFlavour
+{
+   kTriangles,
+   kFans,
+   kStrips,
+   kOneNormal,
+   kOneNormalFans,
+   kOneNormalStrips,
+   kTextured,
+   kTexturedFans,
+   kTexturedStrips
+};
+
+/* Points the faces at their sizes and the tessellation at its faces, once the arrays no longer grow */
+static void stFinishTessellation(const std::vector<size_t>& auiSizeStarts, KernelTessellation& sTess)
+{
+   for (size_t uiFace = 0; uiFace < sTess.m_asFaces.size(); uiFace++)
+   {
+      sTess.m_asFaces[uiFace].m_puiSizesTriangulated = sTess.m_auiSizes.data() + auiSizeStarts[uiFace];
+   }
+   A3D_INITIALIZE_DATA(A3DTess3DData, sTess.m_sData);
+   sTess.m_sData.m_uiTriangulatedIndexSize = (A3DUns32)sTess.m_auiIndexes.size();
+   sTess.m_sData.m_puiTriangulatedIndexes = sTess.m_auiIndexes.data();
+   sTess.m_sData.m_uiFaceTessSize = (A3DUns32)sTess.m_asFaces.size();
+   sTess.m_sData.m_psFaceTessData = sTess.m_asFaces.data();
+}
+
+/* Builds uiFaces faces of about uiFaceTriangles triangles; fans and strips have 8 and 16 triangles each */
+static void stCreateTessellation(KernelFlavour eFlavour, size_t uiFaces, size_t uiFaceTriangles, KernelTessellation& sTess)
+{
+   std::mt19937 rng(7 + (unsigned)eFlavour);
+   std::uniform_int_distribution<A3DUns32> sPoint(0, 1023);
+   auto fnOffset = [&]() { return 3 * sPoint(rng); };
+
+   std::vector<size_t> auiSizeStarts;
+   sTess.m_asFaces.resize(uiFaces);
+   for (size_t uiFace = 0; uiFace < uiFaces; uiFace++)
+   {
+      A3DTessFaceData& sFace = sTess.m_asFaces[uiFace];
+      A3D_INITIALIZE_DATA(A3DTessFaceData, sFace);
+      sFace.m_uiStartTriangulated = (A3DUns32)sTess.m_auiIndexes.size();
+      auiSizeStarts.push_back(sTess.m_auiSizes.size());
+
+      switch (eFlavour)
+      {
+         case kTriangles:
+         case kOneNormal:
+         case kTextured:
+         {
+            sFace.m_usUsedEntitiesFlags = eFlavour == kTriangles ? kA3DTessFaceDataTriangle :
+                                          eFlavour == kOneNormal ? kA3DTessFaceDataTriangleOneNormal : kA3DTessFaceDataTriangleTextured;
+            sTess.m_auiSizes.push_back((A3DUns32)uiFaceTriangles);
+            for (size_t ui = 0; ui < uiFaceTriangles; ui++)
+            {
+               if (eFlavour == kOneNormal)
+               {
+                  sTess.m_auiIndexes.insert(sTess.m_auiIndexes.end(), { fnOffset(), fnOffset(), fnOffset(), fnOffset() });
+                  continue;
+               }
+               for (int iCorner = 0; iCorner < 3; iCorner++)
+               {
+                  // A textured corner has one texture coordinate index between its normal and its vertex
+                  sTess.m_auiIndexes.push_back(fnOffset());
+                  if (eFlavour == kTextured)
+                  {
+                     sTess.m_auiIndexes.push_back(sPoint(rng));
+                  }
+                  sTess.m_auiIndexes.push_back(fnOffset());
+               }
+            }
+            sFace.m_uiTextureCoordIndexesSize = eFlavour == kTextured ? 1 : 0;
+            sTess.m_uiTriangles += uiFaceTriangles;
+            break;
+         }
+         default:
+         {
+            bool bFan = eFlavour == kFans || eFlavour == kOneNormalFans || eFlavour == kTexturedFans;
+            bool bOneNormal = eFlavour == kOneNormalFans || eFlavour == kOneNormalStrips;
+            bool bTextured = eFlavour == kTexturedFans || eFlavour == kTexturedStrips;
+            A3DUns32 uiPoints = bFan ? 10 : 18;
+            size_t uiStrips = std::max<size_t>(1, uiFaceTriangles / (uiPoints - 2));
+            sFace.m_usUsedEntitiesFlags = bFan ? (bOneNormal ? kA3DTessFaceDataTriangleFanOneNormal : kA3DTessFaceDataTriangleFan) :
+                                                 (bOneNormal ? kA3DTessFaceDataTriangleStripeOneNormal : kA3DTessFaceDataTriangleStripe);
+            if (bTextured)
+            {
+               sFace.m_usUsedEntitiesFlags = bFan ? kA3DTessFaceDataTriangleFanTextured : kA3DTessFaceDataTriangleStripeTextured;
+               sFace.m_uiTextureCoordIndexesSize = 1;
+            }
+            sTess.m_auiSizes.push_back((A3DUns32)uiStrips);
+            for (size_t uiStrip = 0; uiStrip < uiStrips; uiStrip++)
+            {
+               sTess.m_auiSizes.push_back(bOneNormal ? (uiPoints | kA3DTessFaceDataNormalSingle) : uiPoints);
+               if (bOneNormal)
+               {
+                  sTess.m_auiIndexes.push_back(fnOffset());
+               }
+               for (A3DUns32 ui = 0; ui < uiPoints; ui++)
+               {
+                  if (!bOneNormal)
+                  {
+                     sTess.m_auiIndexes.push_back(fnOffset());
+                  }
+                  if (bTextured)
+                  {
+                     sTess.m_auiIndexes.push_back(sPoint(rng));
+                  }
+                  sTess.m_auiIndexes.push_back(fnOffset());
+               }
+            }
+            sTess.m_uiTriangles += uiStrips * (uiPoints - 2);
+            break;
+         }
+      }
+      sFace.m_uiSizesTriangulatedSize = (A3DUns32)(sTess.m_auiSizes.size() - auiSizeStarts.back());
+   }
+
+   stFinishTessellation(auiSizeStarts, sTess);
+}
+
+/* The entity kinds of a face in the order they are stored, those IndicesPerFaceAsTriangles decodes */
+static const A3DUns16 s_ausDecodedKinds[] = { kA3DTessFaceDataTriangle, kA3DTessFaceDataTriangleFan,
+                                              kA3DTessFaceDataTriangleStripe, kA3DTessFaceDataTriangleOneNormal,
+                                              kA3DTessFaceDataTriangleFanOneNormal, kA3DTessFaceDataTriangleStripeOneNormal,
+                                              kA3DTessFaceDataTriangleTextured, kA3DTessFaceDataTriangleFanTextured,
+                                              kA3DTessFaceDataTriangleStripeTextured };
+
+/* Builds faces of random kinds, texture coordinates, entity sizes and indexes, including entities of fewer than */
+/* 3 points and faces without triangles */
+static void stCreateRandomTessellation(unsigned uiSeed, KernelTessellation& sTess)
+{
+   std::mt19937 rng(uiSeed);
+   auto fnRandom = [&](A3DUns32 uiMax) { return std::uniform_int_distribution<A3DUns32>(0, uiMax)(rng); };
+
+   sTess = KernelTessellation();
+   std::vector<size_t> auiSizeStarts;
+   sTess.m_asFaces.resize(1 + fnRandom(7));
+   for (A3DTessFaceData& sFace : sTess.m_asFaces)
+   {
+      A3D_INITIALIZE_DATA(A3DTessFaceData, sFace);
+      sFace.m_uiStartTriangulated = (A3DUns32)sTess.m_auiIndexes.size();
+      sFace.m_uiTextureCoordIndexesSize = fnRandom(4);
+      auiSizeStarts.push_back(sTess.m_auiSizes.size());
+      for (A3DUns16 usKind : s_ausDecodedKinds)
+      {
+         if (fnRandom(2))
+         {
+            continue;
+         }
+         sFace.m_usUsedEntitiesFlags |= usKind;
+         const bool bOneNormal = usKind == kA3DTessFaceDataTriangleOneNormal || usKind == kA3DTessFaceDataTriangleFanOneNormal ||
+                                 usKind == kA3DTessFaceDataTriangleStripeOneNormal;
+         const bool bTextured = usKind == kA3DTessFaceDataTriangleTextured || usKind == kA3DTessFaceDataTriangleFanTextured ||
+                                usKind == kA3DTessFaceDataTriangleStripeTextured;
+         const A3DUns32 uiTextureCoords = bTextured ? sFace.m_uiTextureCoordIndexesSize : 0;
+         const A3DUns32 uiPointIndexes = bOneNormal ? 1 : 2 + uiTextureCoords;
+         const A3DUns32 uiEntities = fnRandom(5);
+         sTess.m_auiSizes.push_back(uiEntities);
+         for (A3DUns32 uiEntity = 0; uiEntity < uiEntities; uiEntity++)
+         {
+            A3DUns32 uiPoints = 3;
+            if (usKind != kA3DTessFaceDataTriangle && usKind != kA3DTessFaceDataTriangleOneNormal &&
+                usKind != kA3DTessFaceDataTriangleTextured)
+            {
+               uiPoints = fnRandom(9);
+               sTess.m_auiSizes.push_back(bOneNormal && fnRandom(1) ? uiPoints | kA3DTessFaceDataNormalSingle : uiPoints);
+               uiPoints = std::max<A3DUns32>(uiPoints, 2);
+            }
+            for (A3DUns32 ui = 0; ui < (bOneNormal ? 1 : 0) + uiPoints * uiPointIndexes; ui++)
+            {
+               sTess.m_auiIndexes.push_back(fnRandom(0xFFFFFF));
+            }
+         }
+      }
+      sFace.m_uiSizesTriangulatedSize = (A3DUns32)(sTess.m_auiSizes.size() - auiSizeStarts.back());
+   }
+   stFinishTessellation(auiSizeStarts, sTess);
+}
+
+/* Decodes a face point by point as IndicesPerFaceAsTriangles did before its kernels were specialised */
+static void stReferenceDecode(const A3DTess3DData& sData, unsigned uFace, std::vector<unsigned>& auiIndices,
+                              std::vector<PTInt32>& aiNormalIndices)
+{
+   const A3DTessFaceData& sFace = sData.m_psFaceTessData[uFace];
+   if (!sFace.m_uiSizesTriangulatedSize)
+   {
+      return;
+   }
+   const A3DUns32* puiSizes = sFace.m_puiSizesTriangulated;
+   const A3DUns32* puiNext = sData.m_puiTriangulatedIndexes + sFace.m_uiStartTriangulated;
+   struct Point
+   {
+      A3DUns32 m_uiNormal;
+      A3DUns32 m_uiVertex;
+   };
+   auto fnCorner = [&](const Point& sPoint)
+   {
+      aiNormalIndices.push_back((PTInt32)(sPoint.m_uiNormal / 3));
+      auiIndices.push_back(sPoint.m_uiVertex / 3);
+   };
+
+   for (A3DUns16 usKind : s_ausDecodedKinds)
+   {
+      if (!(sFace.m_usUsedEntitiesFlags & usKind))
+      {
+         continue;
+      }
+      const bool bOneNormal = usKind == kA3DTessFaceDataTriangleOneNormal || usKind == kA3DTessFaceDataTriangleFanOneNormal ||
+                              usKind == kA3DTessFaceDataTriangleStripeOneNormal;
+      const bool bFan = usKind == kA3DTessFaceDataTriangleFan || usKind == kA3DTessFaceDataTriangleFanOneNormal ||
+                        usKind == kA3DTessFaceDataTriangleFanTextured;
+      const bool bTriangles = usKind == kA3DTessFaceDataTriangle || usKind == kA3DTessFaceDataTriangleOneNormal ||
+                              usKind == kA3DTessFaceDataTriangleTextured;
+      const bool bTextured = usKind == kA3DTessFaceDataTriangleTextured || usKind == kA3DTessFaceDataTriangleFanTextured ||
+                             usKind == kA3DTessFaceDataTriangleStripeTextured;
+      const A3DUns32 uiTextureCoords = bTextured ? sFace.m_uiTextureCoordIndexesSize : 0;
+
+      // A point is its normal, unless the entity has one, its texture coordinates and its vertex
+      A3DUns32 uiNormal = 0;
+      auto fnPoint = [&]()
+      {
+         Point sPoint;
+         sPoint.m_uiNormal = bOneNormal ? uiNormal : *puiNext++;
+         puiNext += uiTextureCoords;
+         sPoint.m_uiVertex = *puiNext++;
+         return sPoint;
+      };
+
+      const A3DUns32 uiEntities = *puiSizes++;
+      for (A3DUns32 uiEntity = 0; uiEntity < uiEntities; uiEntity++)
+      {
+         A3DUns32 uiPoints = 3;
+         if (!bTriangles)
+         {
+            uiPoints = *puiSizes++ & (bOneNormal ? (A3DUns32)kA3DTessFaceDataNormalMask : 0xFFFFFFFF);
+         }
+         if (bOneNormal)
+         {
+            uiNormal = *puiNext++;
+         }
+         std::vector<Point> asPoints;
+         for (A3DUns32 ui = 0; ui < std::max<A3DUns32>(uiPoints, 2); ui++)
+         {
+            asPoints.push_back(fnPoint());
+         }
+         for (A3DUns32 uiK = 2; uiK < uiPoints; uiK++)
+         {
+            if (bTriangles || bFan)
+            {
+               fnCorner(asPoints[bTriangles ? uiK - 2 : 0]);
+               fnCorner(asPoints[uiK - 1]);
+               fnCorner(asPoints[uiK]);
+            }
+            else
+            {
+               // Strips flip every other triangle to keep the winding
+               fnCorner(asPoints[uiK - 1]);
+               fnCorner(asPoints[uiK % 2 ? uiK - 2 : uiK]);
+               fnCorner(asPoints[uiK % 2 ? uiK : uiK - 2]);
+            }
+         }
+      }
+   }
+}
+
+/* Checks IndicesPerFaceAsTriangles and TrianglesPerFace against stReferenceDecode on uiTessellations random */
+/* tessellations, and returns the faces that differ */
+static size_t stCheckDecoders(unsigned uiTessellations, size_t& uiFaces)
+{
+   size_t uiMismatches = 0;
+   uiFaces = 0;
+   for (unsigned uiSeed = 0; uiSeed < uiTessellations; uiSeed++)
+   {
+      KernelTessellation sTess;
+      stCreateRandomTessellation(uiSeed, sTess);
+      for (unsigned uFace = 0; uFace < sTess.m_sData.m_uiFaceTessSize; uFace++)
+      {
+         std::vector<unsigned> auiExpected;
+         std::vector<PTInt32> aiExpectedNormals;
+         stReferenceDecode(sTess.m_sData, uFace, auiExpected, aiExpectedNormals);
+
+         const size_t uiCounted = TrianglesPerFace(&sTess.m_sData.m_psFaceTessData[uFace]);
+         std::vector<unsigned> auiIndices(3 * uiCounted);
+         std::vector<PTInt32> aiNormalIndices(3 * uiCounted);
+         A3DUns32 uiTriangles = 0;
+         A3DStatus iRet = IndicesPerFaceAsTriangles(sTess.m_sData, uFace, auiIndices.data(), aiNormalIndices.data(), uiTriangles,
+                                                    nullptr);
+         uiFaces++;
+         if (iRet != A3D_SUCCESS || uiTriangles != uiCounted || auiIndices != auiExpected || aiNormalIndices != aiExpectedNormals)
+         {
+            fprintf(stderr, "IndicesPerFaceAsTriangles differs from the reference on face %u of seed %u, flags 0x%x\n", uFace,
+                    uiSeed, (unsigned)sTess.m_sData.m_psFaceTessData[uFace].m_usUsedEntitiesFlags);
+            uiMismatches++;
+         }
+      }
+   }
+   return uiMismatches;
+}
+
+/* Creates an A3DRiPolyBrepModel holding a tessellation, with one point and one normal */
+static A3DRiRepresentationItem* stCreateRepItem(const KernelTessellation& sTess)
+{
+   double adPoint[] = { 0., 0., 1. };
+   A3DTess3DData sTessData = sTess.m_sData;
+   sTessData.m_uiNormalSize = 3;
+   sTessData.m_pdNormals = adPoint;
+   A3DTess3D* pTess = NULL;
+   A3DTess3DCreate(&sTessData, &pTess);
+
+   A3DTessBaseData sBaseData;
+   A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseData);
+   sBaseData.m_uiCoordSize = 3;
+   sBaseData.m_pdCoords = adPoint;
+   A3DTessBaseSet(pTess, &sBaseData);
+
+   A3DRiPolyBrepModelData sPolyBrepData;
+   A3D_INITIALIZE_DATA(A3DRiPolyBrepModelData, sPolyBrepData);
+   A3DRiPolyBrepModel* pRepItem = NULL;
+   A3DRiPolyBrepModelCreate(&sPolyBrepData, &pRepItem);
+
+   A3DRiRepresentationItemData sRiData;
+   A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sRiData);
+   sRiData.m_pTessBase = pTess;
+   A3DRiRepresentationItemSet(pRepItem, &sRiData);
+   return pRepItem;
+}
+
+/* Checks stDecodeRepresentationItem on one thread and with its faces split across a pool against stReferenceDecode */
+/* on uiTessellations random tessellations, covering IndicesPerFaceRangeAsTriangles, the offsets of the faces and the */
+/* compaction of the arrays, and returns the tessellations that differ */
+static size_t stCheckParallelDecode(unsigned uiTessellations)
+{
+   A3DBridgeThreadPool sPool(4);
+   size_t uiMismatches = 0;
+   std::vector<A3DRiRepresentationItem*> apRepItems;
+   for (unsigned uiSeed = 0; uiSeed < uiTessellations; uiSeed++)
+   {
+      KernelTessellation sTess;
+      stCreateRandomTessellation(uiSeed, sTess);
+      apRepItems.push_back(stCreateRepItem(sTess));
+
+      A3DBridgeMesh sExpected;
+      for (unsigned uFace = 0; uFace < sTess.m_sData.m_uiFaceTessSize; uFace++)
+      {
+         stReferenceDecode(sTess.m_sData, uFace, sExpected.m_auiIndices, sExpected.m_aiNormalIndices);
+         sExpected.m_auiTriangleFaces.resize(sExpected.m_auiIndices.size() / 3, uFace);
+      }
+
+      for (int iPool = 0; iPool < 2; iPool++)
+      {
+         A3DBridgeMesh sMesh;
+         A3DStatus iRet = stDecodeRepresentationItem(apRepItems.back(), sMesh, nullptr, nullptr, nullptr,
+                                                     iPool ? &sPool : nullptr, 0);
+         if (iRet != A3D_SUCCESS || sMesh.m_uiFaceCount != sTess.m_sData.m_uiFaceTessSize ||
+             sMesh.m_auiIndices != sExpected.m_auiIndices || sMesh.m_aiNormalIndices != sExpected.m_aiNormalIndices ||
+             sMesh.m_auiTriangleFaces != sExpected.m_auiTriangleFaces)
+         {
+            fprintf(stderr, "stDecodeRepresentationItem %s differs from the reference on seed %u\n",
+                    iPool ? "on the thread pool" : "on one thread", uiSeed);
+            uiMismatches++;
+         }
+      }
+   }
+   // The representation items are freed with a model file owning them
+   A3DAsmModelFileDelete(BenchmarkCreateModelFile({ BenchmarkCreateOccurrence({}, BenchmarkCreatePart(apRepItems), NULL, NULL) }));
+   return uiMismatches;
+}
+
+/*********************************************************************/
+/***conversions*******************************************************/
+/*********************************************************************/
+
+/* What a conversion gives that must not depend on the thread count or the mesh cache. The PTSolids differ between */
+/* conversions, so each is given by its topological face base */
+struct KernelConversion
+{
+   long m_iTopoFaceCount = 0;
+   std::vector<long> m_aiPartFaceBases;     // the face base of the PTSolid of each item of m_parts, in item order
+   std::vector<double> m_adPartTransforms;  // 16 per item of m_part_transforms, in item order
+   std::vector<A3DUns32> m_auiPaths;
+   std::vector<long> m_aiEntityFaceBases;   // the face base of the PTSolid of each entity, as they were added
+   std::vector<double> m_adEntityTransforms; // 16 per entity
+   std::vector<PTSolid> m_aEntitySolids;
+   PTBounds m_adBounds = {};
+   bool operator==(const KernelConversion& sOther) const
+   {
+      return m_iTopoFaceCount == sOther.m_iTopoFaceCount && m_aiPartFaceBases == sOther.m_aiPartFaceBases &&
+             m_adPartTransforms == sOther.m_adPartTransforms && m_auiPaths == sOther.m_auiPaths &&
+             m_aiEntityFaceBases == sOther.m_aiEntityFaceBases && m_adEntityTransforms == sOther.m_adEntityTransforms &&
+             !memcmp(m_adBounds, sOther.m_adBounds, sizeof(m_adBounds));
+   }
+};
+/***KernelConversion**************************************************/
+
+static void stRecordEntity(PTWorldEntity, PTSolid solid, const PTTransformMatrix transform, PTRenderStyle, A3DUns32,
+                           void* pData)
+{
+   KernelConversion* pConversion = (KernelConversion*)pData;
+   pConversion->m_aEntitySolids.push_back(solid);
+   pConversion->m_adEntityTransforms.insert(pConversion->m_adEntityTransforms.end(), &transform[0][0], &transform[0][0] + 16);
+}
+
+/* Sets the options of a conversion of stCheckThreadedConversion: bits 0-1 of iOptions select no sharing, identical, */
+/* congruent, or congruent with reordering, bit 2 the prototypes and bit 3 welding */
+static void stSetCheckOptions(int iOptions, unsigned uiThreads, PTEnvironment environment, A3DPolygonicaOptions& pgOpts)
+{
+   pgOpts.m_Environment = environment;
+   pgOpts.m_uiThreadCount = uiThreads;
+   pgOpts.m_uiParallelBatchSize = 8;
+   pgOpts.m_bShareIdenticalMeshes = (iOptions & 3) != 0;
+   pgOpts.m_bShareCongruentMeshes = (iOptions & 3) >= 2;
+   pgOpts.m_bCachePrototypes = (iOptions & 4) != 0;
+   pgOpts.m_bWeldVertices = (iOptions & 8) != 0;
+   pgOpts.m_dWeldTolerance = 1e-9;
+   // Every item is large enough to be reordered and to have its faces decoded across the pool
+   pgOpts.m_bReorderTriangles = (iOptions & 3) == 3;
+   pgOpts.m_uiReorderMinTriangles = 0;
+   pgOpts.m_dReorderMinFetches = 0.;
+   pgOpts.m_uiParallelDecodeMinTriangles = 0;
+}
+
+/* Converts a model into a fresh world with the options set in pgOpts, records the result and destroys it */
+static void stConvert(A3DAsmModelFile* pModelFile, A3DPolygonicaOptions& pgOpts, KernelConversion& sConversion)
+{
+   pgOpts.m_pEntityCallback = stRecordEntity;
+   pgOpts.m_pEntityCallbackData = &sConversion;
+   PFWorldCreate(pgOpts.m_Environment, NULL, &pgOpts.m_World);
+
+   sConversion = KernelConversion();
+   A3DModelCreatePGWorld(pModelFile, pgOpts);
+
+   std::vector<const A3DRiRepresentationItem*> apItems;
+   for (const auto& part : pgOpts.m_parts)
+   {
+      apItems.push_back(part.first);
+   }
+   std::sort(apItems.begin(), apItems.end());
+   for (const A3DRiRepresentationItem* pItem : apItems)
+   {
+      auto base = pgOpts.m_topo_face_base.find(pgOpts.m_parts[pItem]);
+      sConversion.m_aiPartFaceBases.push_back(base != pgOpts.m_topo_face_base.end() ? base->second : -1);
+      auto transform = pgOpts.m_part_transforms.find(pItem);
+      if (transform != pgOpts.m_part_transforms.end())
+      {
+         sConversion.m_adPartTransforms.insert(sConversion.m_adPartTransforms.end(), transform->second.begin(),
+                                               transform->second.end());
+      }
+   }
+   for (PTSolid solid : sConversion.m_aEntitySolids)
+   {
+      auto base = pgOpts.m_topo_face_base.find(solid);
+      sConversion.m_aiEntityFaceBases.push_back(base != pgOpts.m_topo_face_base.end() ? base->second : -1);
+   }
+   sConversion.m_iTopoFaceCount = pgOpts.m_iTopoFaceCount;
+   sConversion.m_auiPaths = pgOpts.m_paths;
+   PFEntityGetBoundsProperty(pgOpts.m_World, PV_WORLD_PROP_BOUNDS, sConversion.m_adBounds);
+
+   A3DDestroyBridgeWorldEntities(pgOpts);
+   A3DDestroyBridgeSolids(pgOpts);
+   A3DDestroyBridgeData(pgOpts);
+   PFWorldDestroy(pgOpts.m_World);
+}
+
+/* Checks that A3DModelCreatePGWorld gives on a pool of uiThreads threads what it gives on one, on a seeded assembly */
+/* with each combination of the sharing, prototype and weld options, and that a mesh cache written and then read */
+/* changes nothing; returns the conversions that differ */
+static size_t stCheckThreadedConversion(unsigned uiThreads, size_t& uiConversions)
+{
+   BenchmarkAssemblyShape sShape;
+   sShape.m_uiTriangles = 400;
+   sShape.m_bSeparateFaces = true;
+   sShape.m_uiSeed = 7;
+   BenchmarkAssembly sAssembly = BenchmarkCreateAssembly(sShape);
+
+   PTEnvironment environment = PV_ENTITY_NULL;
+   PFEnvironmentCreate(NULL, &environment);
+   size_t uiMismatches = 0;
+   uiConversions = 0;
+   for (int iOptions = 0; iOptions < 16; iOptions++)
+   {
+      KernelConversion sExpected, sConversion;
+      {
+         A3DPolygonicaOptions pgOpts;
+         stSetCheckOptions(iOptions, 0, environment, pgOpts);
+         stConvert(sAssembly.m_pModelFile, pgOpts, sExpected);
+      }
+      {
+         A3DPolygonicaOptions pgOpts;
+         stSetCheckOptions(iOptions, uiThreads, environment, pgOpts);
+         stConvert(sAssembly.m_pModelFile, pgOpts, sConversion);
+      }
+      uiConversions++;
+      if (!(sConversion == sExpected))
+      {
+         fprintf(stderr, "A3DModelCreatePGWorld on %u threads differs from one thread with options %d\n", uiThreads, iOptions);
+         uiMismatches++;
+      }
+
+      // The first conversion writes the mesh cache and the second reads it
+      const std::string sKey = "KernelBenchmark-" + std::to_string(iOptions);
+      const std::string sPath = "./" + sKey + ".a3dmesh";
+      remove(sPath.c_str());
+      for (int iPass = 0; iPass < 2; iPass++)
+      {
+         A3DPolygonicaOptions pgOpts;
+         stSetCheckOptions(iOptions, uiThreads, environment, pgOpts);
+         pgOpts.m_sMeshCacheDirectory = ".";
+         pgOpts.m_sMeshCacheKey = sKey;
+         stConvert(sAssembly.m_pModelFile, pgOpts, sConversion);
+         uiConversions++;
+         if (!(sConversion == sExpected) || (iPass && !pgOpts.m_uiMeshCacheHits))
+         {
+            fprintf(stderr, "A3DModelCreatePGWorld %s the mesh cache differs from one thread with options %d\n",
+                    iPass ? "reading" : "writing", iOptions);
+            uiMismatches++;
+         }
+      }
+      remove(sPath.c_str());
+   }
+   PFEnvironmentDestroy(environment);
+   A3DAsmModelFileDelete(sAssembly.m_pModelFile);
+   return uiMismatches;
+}
+
+/*********************************************************************/
+/***meshes************************************************************/
+/*********************************************************************/
+
+/* Builds a wavy grid of 2 * uiSide * uiSide triangles in 64 faces, with its vertices and triangles shuffled like */
+/* those of a scanned mesh */
+static void stCreateScatteredMesh(size_t uiSide, A3DBridgeMesh& sMesh)
+{
+   std::mt19937 rng(13);
+   const size_t uiRow = uiSide + 1;
+   std::vector<unsigned> auiShuffled(uiRow * uiRow);
+   for (size_t ui = 0; ui < auiShuffled.size(); ui++)
+   {
+      auiShuffled[ui] = (unsigned)ui;
+   }
+   std::shuffle(auiShuffled.begin(), auiShuffled.end(), rng);
+
+   sMesh = A3DBridgeMesh();
+   sMesh.m_adCoords.resize(3 * auiShuffled.size());
+   for (size_t uiY = 0; uiY < uiRow; uiY++)
+   {
+      for (size_t uiX = 0; uiX < uiRow; uiX++)
+      {
+         double* pdPoint = &sMesh.m_adCoords[3 * auiShuffled[uiY * uiRow + uiX]];
+         pdPoint[0] = (double)uiX;
+         pdPoint[1] = (double)uiY;
+         pdPoint[2] = 4. * std::sin(0.05 * (double)uiX) * std::cos(0.05 * (double)uiY);
+      }
+   }
+   sMesh.m_adNormals = { 0., 0., 1. };
+   sMesh.m_uiFaceCount = 64;
+
+   std::vector<size_t> auiTriangles(2 * uiSide * uiSide);
+   for (size_t ui = 0; ui < auiTriangles.size(); ui++)
+   {
+      auiTriangles[ui] = ui;
+   }
+   std::shuffle(auiTriangles.begin(), auiTriangles.end(), rng);
+   for (size_t uiTriangle : auiTriangles)
+   {
+      size_t uiQuad = uiTriangle / 2, uiX = uiQuad % uiSide, uiY = uiQuad / uiSide;
+      size_t auiCorners[4] = { uiY * uiRow + uiX, uiY * uiRow + uiX + 1, (uiY + 1) * uiRow + uiX + 1, (uiY + 1) * uiRow + uiX };
+      bool bFirst = uiTriangle % 2 == 0;
+      for (size_t uiCorner : { auiCorners[0], auiCorners[bFirst ? 1 : 2], auiCorners[bFirst ? 2 : 3] })
+      {
+         sMesh.m_auiIndices.push_back(auiShuffled[uiCorner]);
+         sMesh.m_aiNormalIndices.push_back(0);
+      }
+      sMesh.m_auiTriangleFaces.push_back((unsigned)(uiY * 64 / uiSide));
+   }
+}
+
+#ifndef BRIDGE_STANDIN_SDK
+/* Builds the 12 triangles of an axis-aligned box as one face */
+static void stCreateBoxMesh(const double adMin[3], const double adMax[3], A3DBridgeMesh& sMesh)
+{
+   sMesh = A3DBridgeMesh();
+   for (int iCorner = 0; iCorner < 8; iCorner++)
+   {
+      sMesh.m_adCoords.push_back((iCorner & 1) ? adMax[0] : adMin[0]);
+      sMesh.m_adCoords.push_back((iCorner & 2) ? adMax[1] : adMin[1]);
+      sMesh.m_adCoords.push_back((iCorner & 4) ? adMax[2] : adMin[2]);
+   }
+   sMesh.m_adNormals = { 0., 0., 1. };
+   sMesh.m_uiFaceCount = 1;
+   // Two outward triangles per side
+   const unsigned auiQuads[6][4] = { { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+   for (const unsigned* puiQuad : auiQuads)
+   {
+      sMesh.m_auiIndices.insert(sMesh.m_auiIndices.end(), { puiQuad[0], puiQuad[1], puiQuad[2], puiQuad[0], puiQuad[2], puiQuad[3] });
+   }
+   sMesh.m_aiNormalIndices.assign(sMesh.m_auiIndices.size(), 0);
+   sMesh.m_auiTriangleFaces.assign(sMesh.m_auiIndices.size() / 3, 0);
+}
+#endif
+
+/*********************************************************************/
+/***baseline**********************************************************/
+/*********************************************************************/
+
+static void stWriteJson(const std::vector<KernelResult>& asResults, FILE* pFile)
+{
+   fprintf(pFile, "{\n  \"benchmark\": \"KernelBenchmark\",\n  \"kernels\": [\n");
+   for (size_t ui = 0; ui < asResults.size(); ui++)
+   {
+      const KernelResult& sResult = asResults[ui];
+      fprintf(pFile, "    { \"name\": \"%s\", \"unit\": \"%s\", \"value\": %.6g, \"operations\": %zu }%s\n",
+              sResult.m_sName.c_str(), sResult.m_pcUnit, sResult.m_dValue, sResult.m_uiOperations,
+              ui + 1 < asResults.size() ? "," : "");
+   }
+   fprintf(pFile, "  ]\n}\n");
+}
+
+/* Reads the name and value of each kernel of a file written by stWriteJson */
+static bool stReadJson(const char* pcPath, std::vector<KernelResult>& asResults)
+{
+   FILE* pFile = fopen(pcPath, "rb");
+   if (!pFile)
+   {
+      return false;
+   }
+   std::string sText;
+   char acBuffer[4096];
+   size_t uiRead;
+   while ((uiRead = fread(acBuffer, 1, sizeof(acBuffer), pFile)) > 0)
+   {
+      sText.append(acBuffer, uiRead);
+   }
+   fclose(pFile);
+
+   for (size_t uiPos = sText.find("\"name\""); uiPos != std::string::npos; uiPos = sText.find("\"name\"", uiPos + 1))
+   {
+      size_t uiStart = sText.find('"', sText.find(':', uiPos)) + 1;
+      size_t uiEnd = sText.find('"', uiStart);
+      size_t uiValue = sText.find("\"value\"", uiEnd);
+      if (uiStart == 0 || uiEnd == std::string::npos || uiValue == std::string::npos)
+      {
+         return false;
+      }
+      KernelResult sResult;
+      sResult.m_sName = sText.substr(uiStart, uiEnd - uiStart);
+      sResult.m_pcUnit = "";
+      sResult.m_dValue = strtod(sText.c_str() + sText.find(':', uiValue) + 1, NULL);
+      sResult.m_uiOperations = 0;
+      asResults.push_back(sResult);
+   }
+   return true;
+}
+
+/* Prints each kernel against its baseline and returns the number slower by more than dThreshold percent */
+static size_t stCompare(const std::vector<KernelResult>& asResults, const std::vector<KernelResult>& asBaseline, double dThreshold)
+{
+   size_t uiRegressions = 0;
+   printf("\n%-44s %12s %12s %9s\n", "kernel", "baseline", "current", "change");
+   for (const KernelResult& sResult : asResults)
+   {
+      const KernelResult* pBaseline = NULL;
+      for (const KernelResult& sCandidate : asBaseline)
+      {
+         if (sCandidate.m_sName == sResult.m_sName)
+         {
+            pBaseline = &sCandidate;
+         }
+      }
+      if (!pBaseline || pBaseline->m_dValue <= 0.)
+      {
+         printf("%-44s %12s %12.3f %9s\n", sResult.m_sName.c_str(), "-", sResult.m_dValue, "new");
+         continue;
+      }
+      double dChange = 100. * (sResult.m_dValue / pBaseline->m_dValue - 1.);
+      bool bRegressed = dChange > dThreshold;
+      uiRegressions += bRegressed ? 1 : 0;
+      printf("%-44s %12.3f %12.3f %+8.1f%%%s\n", sResult.m_sName.c_str(), pBaseline->m_dValue, sResult.m_dValue, dChange,
+             bRegressed ? "  REGRESSION" : "");
+   }
+   return uiRegressions;
+}
+
+/*********************************************************************/
+/***main**************************************************************/
+/*********************************************************************/
+
+int main(int iArgc, char** ppcArgv)
+{
+   const char* pcJson = NULL;
+   const char* pcBaseline = NULL;
+   const char* pcFilter = "";
+   double dThreshold = 10.;
+   unsigned uiRepeats = 5;
+   unsigned uiCheckTessellations = 200;
+   for (int i = 1; i + 1 < iArgc; i += 2)
+   {
+      if (!strcmp(ppcArgv[i], "--json")) pcJson = ppcArgv[i + 1];
+      else if (!strcmp(ppcArgv[i], "--baseline")) pcBaseline = ppcArgv[i + 1];
+      else if (!strcmp(ppcArgv[i], "--threshold")) dThreshold = atof(ppcArgv[i + 1]);
+      else if (!strcmp(ppcArgv[i], "--repeats")) uiRepeats = (unsigned)atoi(ppcArgv[i + 1]);
+      else if (!strcmp(ppcArgv[i], "--filter")) pcFilter = ppcArgv[i + 1];
+      else if (!strcmp(ppcArgv[i], "--check")) uiCheckTessellations = (unsigned)atoi(ppcArgv[i + 1]);
+      else
+      {
+         fprintf(stderr, "Unknown option %s\n", ppcArgv[i]);
+         return 1;
+      }
+   }
+
+   BenchmarkSession sSession;
+   if (!sSession.m_bReady)
+   {
+      return 1;
+   }
+
+   std::vector<KernelResult> asResults;
+   auto fnWanted = [&](const std::string& sName) { return sName.find(pcFilter) != std::string::npos; };
+   auto fnReport = [&](const std::string& sName, const char* pcUnit, double dSeconds, size_t uiOperations)
+   {
+      KernelResult sResult = { sName, pcUnit, 1e9 * dSeconds / (double)uiOperations, uiOperations };
+      printf("%-44s %12.3f %s\n", sName.c_str(), sResult.m_dValue, pcUnit);
+      asResults.push_back(sResult);
+   };
+
+   // The specialised kernels of IndicesPerFaceAsTriangles must decode exactly like the reference
+   if (fnWanted("IndicesPerFaceAsTriangles") && uiCheckTessellations)
+   {
+      size_t uiFaces = 0;
+      size_t uiMismatches = stCheckDecoders(uiCheckTessellations, uiFaces);
+      if (uiMismatches)
+      {
+         fprintf(stderr, "IndicesPerFaceAsTriangles differs from the reference on %zu of %zu random faces\n", uiMismatches, uiFaces);
+         return 1;
+      }
+      printf("IndicesPerFaceAsTriangles matches the reference on %zu random faces\n", uiFaces);
+
+      // The faces of an item decoded across the pool, whatever its size, must give the same mesh as one thread
+      uiMismatches = stCheckParallelDecode(uiCheckTessellations);
+      if (uiMismatches)
+      {
+         fprintf(stderr, "stDecodeRepresentationItem differs from the reference on %zu of %u random tessellations\n",
+                 uiMismatches, uiCheckTessellations);
+         return 1;
+      }
+      printf("stDecodeRepresentationItem matches the reference with and without a thread pool on %u random tessellations\n",
+             uiCheckTessellations);
+
+      // The threads and the mesh cache must not change what a conversion gives
+      size_t uiConversions = 0;
+      uiMismatches = stCheckThreadedConversion(4, uiConversions);
+      if (uiMismatches)
+      {
+         fprintf(stderr, "A3DModelCreatePGWorld differs from one thread on %zu of %zu conversions\n", uiMismatches, uiConversions);
+         return 1;
+      }
+      printf("A3DModelCreatePGWorld on 4 threads and through the mesh cache matches one thread on %zu conversions\n",
+             uiConversions);
+   }
+
+   // IndicesPerFaceAsTriangles, about 256k triangles per flavour
+   const char* apcFlavours[] = { "triangles", "fans", "strips", "one_normal", "one_normal_fans", "one_normal_strips", "textured",
+                                 "textured_fans", "textured_strips" };
+   for (int iFlavour = kTriangles; iFlavour <= kTexturedStrips; iFlavour++)
+   {
+      std::string sName = std::string("IndicesPerFaceAsTriangles/") + apcFlavours[iFlavour];
+      if (!fnWanted(sName))
+      {
+         continue;
+      }
+      KernelTessellation sTess;
+      stCreateTessellation((KernelFlavour)iFlavour, 64, 4096, sTess);
+      std::vector<unsigned> auiIndices(3 * sTess.m_uiTriangles);
+      std::vector<PTInt32> aiNormalIndices(3 * sTess.m_uiTriangles);
+
+      size_t uiDecoded = 0;
+      double dSeconds = BenchmarkBestSeconds(uiRepeats,
+         [&]()
+         {
+            uiDecoded = 0;
+            for (unsigned uFace = 0; uFace < sTess.m_sData.m_uiFaceTessSize; uFace++)
+            {
+               A3DUns32 uiFaceTriangles = 0;
+               IndicesPerFaceAsTriangles(sTess.m_sData, uFace, &auiIndices[3 * uiDecoded], &aiNormalIndices[3 * uiDecoded],
+                                         uiFaceTriangles, nullptr);
+               uiDecoded += uiFaceTriangles;
+            }
+         },
+         []() {});
+      if (uiDecoded != sTess.m_uiTriangles)
+      {
+         fprintf(stderr, "%s decoded %zu triangles of %zu\n", sName.c_str(), uiDecoded, sTess.m_uiTriangles);
+         return 1;
+      }
+      fnReport(sName, "ns/triangle", dSeconds, sTess.m_uiTriangles);
+   }
+
+   std::mt19937 rng(11);
+   std::uniform_real_distribution<double> sDistribution(-1., 1.);
+
+   if (fnWanted("MultiplyMatrix"))
+   {
+      const size_t uiCompositions = 1000000;
+      std::vector<double> adMatrices(16 * 1024);
+      for (size_t ui = 0; ui < adMatrices.size(); ui++)
+      {
+         adMatrices[ui] = (ui % 16) % 4 == 3 ? ((ui % 16) == 15 ? 1. : 0.) : sDistribution(rng);
+      }
+      double adResult[2][16], dSink = 0.;
+      double dSeconds = BenchmarkBestSeconds(uiRepeats,
+         [&]()
+         {
+            memcpy(adResult[0], &adMatrices[0], sizeof(adResult[0]));
+            for (size_t ui = 0; ui < uiCompositions; ui++)
+            {
+               // Restart the chain regularly so that it stays finite
+               const double* pdFather = (ui % 64) ? adResult[ui & 1] : &adMatrices[16 * ((ui / 64) % 1024)];
+               MultiplyMatrix(pdFather, &adMatrices[16 * (ui % 1024)], adResult[(ui + 1) & 1]);
+            }
+            dSink += adResult[uiCompositions & 1][12];
+         },
+         []() {});
+      fnReport("MultiplyMatrix", "ns/compose", dSeconds, uiCompositions);
+      if (dSink != dSink)
+      {
+         printf("MultiplyMatrix diverged\n");
+      }
+   }
+
+   if (fnWanted("stTransform"))
+   {
+      // Each transformation is decoded once per traversal and then composed from the traversal's cache. The
+      // transformations are owned by occurrences of a model file so that deleting it frees them
+      std::vector<A3DMiscCartesianTransformation*> apLocations;
+      std::vector<A3DAsmProductOccurrence*> apOwners;
+      for (int i = 0; i < 1024; i++)
+      {
+         apLocations.push_back(BenchmarkCreateLocation(100. * sDistribution(rng), 100. * sDistribution(rng), 100. * sDistribution(rng)));
+         apOwners.push_back(BenchmarkCreateOccurrence({}, NULL, NULL, apLocations.back()));
+      }
+      A3DAsmModelFile* pOwner = BenchmarkCreateModelFile(apOwners);
+      const size_t uiRounds = 64;
+      double dSink = 0.;
+      double dSeconds = BenchmarkBestSeconds(uiRepeats,
+         [&]()
+         {
+            A3DBridgeTraversal sTraversal;
+            PTTransformMatrix parent, local;
+            PMInitTransformMatrix(parent);
+            for (size_t uiRound = 0; uiRound < uiRounds; uiRound++)
+            {
+               for (A3DMiscCartesianTransformation* pLocation : apLocations)
+               {
+                  stTransform(pLocation, parent, local, sTraversal, nullptr);
+                  dSink += local[3][0];
+               }
+            }
+         },
+         []() {});
+      fnReport("stTransform", "ns/call", dSeconds, uiRounds * apLocations.size());
+      A3DAsmModelFileDelete(pOwner);
+      if (dSink != dSink)
+      {
+         printf("stTransform diverged\n");
+      }
+   }
+
+   PTEnvironment environment = PV_ENTITY_NULL;
+   PFEnvironmentCreate(NULL, &environment);
+
+   if (fnWanted("LookupRenderStyleByColor"))
+   {
+      const size_t uiLookups = 1000000;
+      std::uniform_int_distribution<int> sColour(0, 255);
+      std::vector<float> afColours(3 * 256);
+      for (float& fChannel : afColours)
+      {
+         fChannel = (float)sColour(rng) / 255.f;
+      }
+      std::vector<int> aiSequence(uiLookups);
+      for (int& iColour : aiSequence)
+      {
+         iColour = sColour(rng);
+      }
+
+      A3DPolygonicaOptions pgOpts;
+      pgOpts.m_Environment = environment;
+      double dSeconds = BenchmarkBestSeconds(uiRepeats,
+         [&]()
+         {
+            for (int iColour : aiSequence)
+            {
+               LookupRenderStyleByColor(afColours[3 * iColour], afColours[3 * iColour + 1], afColours[3 * iColour + 2],
+                                        pgOpts, nullptr);
+            }
+         },
+         [&]() { A3DDestroyBridgeStylesData(pgOpts); });
+      fnReport("LookupRenderStyleByColor", "ns/lookup", dSeconds, uiLookups);
+   }
+
+   if (fnWanted("stReorderMesh") || fnWanted("PFSolidCreateFromMesh"))
+   {
+      A3DBridgeMesh sScattered, sReordered, sWork;
+      stCreateScatteredMesh(512, sScattered);
+      const size_t uiTriangles = sScattered.m_auiTriangleFaces.size();
+      sWork = sReordered = sScattered;
+      double dSeconds = BenchmarkBestSeconds(uiRepeats,
+         [&]() { stReorderMesh(sWork, nullptr); },
+         [&]() { sWork = sScattered; });
+      stReorderMesh(sReordered, nullptr);
+      if (fnWanted("stReorderMesh"))
+      {
+         fnReport("stReorderMesh", "ns/triangle", dSeconds, uiTriangles);
+      }
+      printf("   vertices fetched per triangle through a 32 vertex FIFO: scattered %.3f, reordered %.3f\n",
+             stVertexFetchesPerTriangle(sScattered, 32), stVertexFetchesPerTriangle(sReordered, 32));
+
+      // The solid alone, its groups being left to A3DBridgeGetSurfaceGroup
+      const char* apcOrders[] = { "scattered", "reordered" };
+      for (int iOrder = 0; iOrder < 2; iOrder++)
+      {
+         std::string sName = std::string("PFSolidCreateFromMesh/") + apcOrders[iOrder];
+         if (!fnWanted(sName))
+         {
+            continue;
+         }
+         const A3DBridgeMesh& sMesh = iOrder ? sReordered : sScattered;
+         PTSolid solid = PV_ENTITY_NULL;
+         std::vector<PTEntityGroup>* pGroups = NULL;
+         dSeconds = BenchmarkBestSeconds(uiRepeats,
+            [&]() { stCreatePTSolidFromMesh(sMesh, environment, 0, true, &solid, &pGroups, nullptr, nullptr); },
+            [&]()
+            {
+               PFSolidDestroy(solid);
+               delete pGroups;
+            });
+         fnReport(sName, "ns/triangle", dSeconds, uiTriangles);
+      }
+   }
+
+#ifndef BRIDGE_STANDIN_SDK
+   if (fnWanted("PFSolidBoolean"))
+   {
+      // The operations that follow the conversion, on the solids of the scattered and reordered mesh: a box subtracted
+      // from the middle of the wavy grid, and a slice of it as the intersection with a slab of one unit across it
+      A3DBridgeMesh sScattered, sReordered, sTool;
+      stCreateScatteredMesh(512, sScattered);
+      const size_t uiTriangles = sScattered.m_auiTriangleFaces.size();
+      sReordered = sScattered;
+      stReorderMesh(sReordered, nullptr);
+
+      struct BooleanKernel
+      {
+         const char* m_pcName;
+         PTNat32 m_uiOperation;
+         double m_adMin[3];
+         double m_adMax[3];
+         PTSolid m_tool;
+      };
+      BooleanKernel asKernels[] = { { "PFSolidBoolean/", PV_BOOLEAN_SUBTRACTION, { 128., 128., -8. }, { 384., 384., 8. }, PV_ENTITY_NULL },
+                                    { "PFSolidBoolean/slice/", PV_BOOLEAN_INTERSECTION, { 255.5, -1., -8. }, { 256.5, 513., 8. },
+                                      PV_ENTITY_NULL } };
+      std::vector<PTEntityGroup>* pToolGroups = NULL;
+      for (BooleanKernel& sKernel : asKernels)
+      {
+         stCreateBoxMesh(sKernel.m_adMin, sKernel.m_adMax, sTool);
+         stCreatePTSolidFromMesh(sTool, environment, 0, true, &sKernel.m_tool, &pToolGroups, nullptr, nullptr);
+         delete pToolGroups;
+      }
+
+      const char* apcOrders[] = { "scattered", "reordered" };
+      for (int iOrder = 0; iOrder < 2; iOrder++)
+      {
+         PTSolid solid = PV_ENTITY_NULL;
+         std::vector<PTEntityGroup>* pGroups = NULL;
+         stCreatePTSolidFromMesh(iOrder ? sReordered : sScattered, environment, 0, true, &solid, &pGroups, nullptr, nullptr);
+         for (const BooleanKernel& sKernel : asKernels)
+         {
+            std::string sName = std::string(sKernel.m_pcName) + apcOrders[iOrder];
+            if (!fnWanted(sName))
+            {
+               continue;
+            }
+            PTSolid result = PV_ENTITY_NULL;
+            PTStatus status = PV_STATUS_OK;
+            double dSeconds = BenchmarkBestSeconds(uiRepeats,
+               [&]() { status = PFSolidBoolean(solid, sKernel.m_tool, sKernel.m_uiOperation, NULL, &result); },
+               [&]()
+               {
+                  PFSolidDestroy(result);
+                  result = PV_ENTITY_NULL;
+               });
+            if (status != PV_STATUS_OK)
+            {
+               fprintf(stderr, "%s failed with status %d\n", sName.c_str(), (int)status);
+               continue;
+            }
+            fnReport(sName, "ns/triangle", dSeconds, uiTriangles);
+         }
+         PFSolidDestroy(solid);
+         delete pGroups;
+      }
+      for (BooleanKernel& sKernel : asKernels)
+      {
+         PFSolidDestroy(sKernel.m_tool);
+      }
+   }
+#endif
+
+   if (fnWanted("A3DDestroyBridge"))
+   {
+      // 500 parts of 200 triangles, 20 instances each
+      std::vector<A3DAsmProductOccurrence*> apInstances;
+      for (int iPart = 0; iPart < 500; iPart++)
+      {
+         size_t uiCreated = 0;
+         A3DAsmPartDefinition* pPart = BenchmarkCreatePart({ BenchmarkCreateGridRepItem(200, (double)iPart, uiCreated) });
+         for (int iInstance = 0; iInstance < 20; iInstance++)
+         {
+            apInstances.push_back(BenchmarkCreateOccurrence({}, pPart, NULL, BenchmarkCreateLocation((double)iInstance, 0., 0.)));
+         }
+      }
+      A3DAsmModelFile* pModelFile = BenchmarkCreateModelFile({ BenchmarkCreateOccurrence(apInstances, NULL, NULL, NULL) });
+
+      A3DPolygonicaOptions pgOpts;
+      pgOpts.m_Environment = environment;
+      PFWorldCreate(environment, NULL, &pgOpts.m_World);
+
+      // The destroy functions only run once each and in this order, so the one timed is preceded and followed by
+      // the others, untimed, on a fresh conversion
+      struct DestroyKernel
+      {
+         const char* m_pcName;
+         int (*m_pfnDestroy)(A3DPolygonicaOptions&);
+      };
+      const DestroyKernel asKernels[] = { { "A3DDestroyBridgeWorldEntities", A3DDestroyBridgeWorldEntities },
+                                          { "A3DDestroyBridgeSolids", A3DDestroyBridgeSolids },
+                                          { "A3DDestroyBridgeData", A3DDestroyBridgeData } };
+      const size_t uiKernels = sizeof(asKernels) / sizeof(asKernels[0]);
+      auto fnConvert = [&](size_t uiTimed)
+      {
+         pgOpts.m_iTopoFaceCount = 0;
+         A3DModelCreatePGWorld(pModelFile, pgOpts);
+         for (size_t ui = 0; ui < uiTimed; ui++)
+         {
+            asKernels[ui].m_pfnDestroy(pgOpts);
+         }
+      };
+      auto fnFinish = [&](size_t uiTimed)
+      {
+         for (size_t ui = uiTimed + 1; ui < uiKernels; ui++)
+         {
+            asKernels[ui].m_pfnDestroy(pgOpts);
+         }
+      };
+      for (size_t uiTimed = 0; uiTimed < uiKernels; uiTimed++)
+      {
+         if (!fnWanted(asKernels[uiTimed].m_pcName))
+         {
+            continue;
+         }
+         fnConvert(uiTimed);
+         size_t uiEntities = pgOpts.m_entities.size();
+         double dSeconds = BenchmarkBestSeconds(uiRepeats,
+            [&]() { asKernels[uiTimed].m_pfnDestroy(pgOpts); },
+            [&]()
+            {
+               fnFinish(uiTimed);
+               fnConvert(uiTimed);
+            });
+         asKernels[uiTimed].m_pfnDestroy(pgOpts);
+         fnFinish(uiTimed);
+         fnReport(asKernels[uiTimed].m_pcName, "ns/entity", dSeconds, uiEntities);
+      }
+
+      PFWorldDestroy(pgOpts.m_World);
+      A3DAsmModelFileDelete(pModelFile);
+   }
+
+   PFEnvironmentDestroy(environment);
+
+   if (pcJson)
+   {
+      FILE* pFile = fopen(pcJson, "wb");
+      if (!pFile)
+      {
+         fprintf(stderr, "Cannot write %s\n", pcJson);
+         return 1;
+      }
+      stWriteJson(asResults, pFile);
+      fclose(pFile);
+   }
+
+   if (pcBaseline)
+   {
+      std::vector<KernelResult> asBaseline;
+      if (!stReadJson(pcBaseline, asBaseline))
+      {
+         fprintf(stderr, "Cannot read the baseline %s\n", pcBaseline);
+         return 1;
+      }
+      size_t uiRegressions = stCompare(asResults, asBaseline, dThreshold);
+      printf("%zu kernel(s) slower than the baseline by more than %.1f%%\n", uiRegressions, dThreshold);
+      return uiRegressions ? 2 : 0;
+   }
+   return 0;
+}
@@ -0,0 +1,228 @@
+/*
+*   Description:
+*
+*      Scaling benchmark
+*      Times A3DModelCreatePGWorld and the memory it adds over a grid of assembly sizes, so that the
+*      time and memory can be charted against the instances and the triangles.
+*
+*      Each assembly is built by BenchmarkCreateAssembly from a seed: every depth from 1 to --depth is
+*      run with every part size of --triangles, the other parameters of the shape being shared.
+*
+*      Usage: ScalingBenchmark [--depth 4] [--fanout 5] [--instancing 0.75] [--triangles 500,2000,8000]
+*                              [--fans 0.25] [--strips 0.25] [--colours 16] [--separate-faces 0] [--seed 1]
+*                              [--weld tolerance] [--reorder min triangles] [--threads 0] [--repeats 3]
+*                              [--csv scaling.csv]
+*      The memory is the growth of the resident memory of the process during the first conversion.
+*      --separate-faces 1 gives each face its own vertices and --weld welds them again in the bridge; the
+*      vertices before and after welding are reported, and with A3D_BRIDGE_STATS the milliseconds of welding
+*      and of PFSolidCreateFromMesh in the fastest conversion. --reorder reorders the triangles of the meshes of at
+*      least that many triangles for locality, with its milliseconds reported likewise.
+*/
+
+#define INITIALIZE_A3D_API
+#include <A3DSDKIncludes.h>
+
+#include "BenchmarkCommon.hpp"
+#include "ExchangePolygonicaBridge.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct ScalingPoint
+{
+   BenchmarkAssembly m_sAssembly;
+   unsigned m_uiDepth;
+   size_t m_uiTriangles;
+   double m_dSeconds;
+   double m_dMegabytes;
+   size_t m_uiVerticesBefore;
+   size_t m_uiVerticesAfter;
+   double m_dWeldMs;
+   double m_dReorderMs;
+   double m_dSolidMs;
+};
+/***ScalingPoint******************************************************/
+
+/* Prints a bar of up to 40 characters proportional to dValue / dMax */
+static void stPrintBar(double dValue, double dMax)
+{
+   int iWidth = dMax > 0. ? (int)(40. * dValue / dMax + 0.5) : 0;
+   printf(" |%s%*s|", std::string((size_t)iWidth, '#').c_str(), 40 - iWidth, "");
+}
+
+int main(int iArgc, char** ppcArgv)
+{
+   BenchmarkAssemblyShape sShape;
+   sShape.m_uiFanOut = 5;
+   unsigned uiMaxDepth = 4;
+   std::vector<size_t> auiTriangles = { 500, 2000, 8000 };
+   unsigned uiThreads = 0;
+   unsigned uiRepeats = 3;
+   const char* pcCsv = NULL;
+   double dWeldTolerance = -1.;
+   long lReorderMin = -1;
+   for (int i = 1; i + 1 < iArgc; i += 2)
+   {
+      const char* pcValue = ppcArgv[i + 1];
+      if (!strcmp(ppcArgv[i], "--depth")) uiMaxDepth = (unsigned)atoi(pcValue);
+      else if (!strcmp(ppcArgv[i], "--fanout")) sShape.m_uiFanOut = (unsigned)atoi(pcValue);
+      else if (!strcmp(ppcArgv[i], "--instancing")) sShape.m_dInstancing = atof(pcValue);
+      else if (!strcmp(ppcArgv[i], "--fans")) sShape.m_dFans = atof(pcValue);
+      else if (!strcmp(ppcArgv[i], "--strips")) sShape.m_dStrips = atof(pcValue);
+      else if (!strcmp(ppcArgv[i], "--colours")) sShape.m_uiColours = (unsigned)atoi(pcValue);
+      else if (!strcmp(ppcArgv[i], "--separate-faces")) sShape.m_bSeparateFaces = atoi(pcValue) != 0;
+      else if (!strcmp(ppcArgv[i], "--seed")) sShape.m_uiSeed = (unsigned)atoi(pcValue);
+      else if (!strcmp(ppcArgv[i], "--weld")) dWeldTolerance = atof(pcValue);
+      else if (!strcmp(ppcArgv[i], "--reorder")) lReorderMin = atol(pcValue);
+      else if (!strcmp(ppcArgv[i], "--threads")) uiThreads = (unsigned)atoi(pcValue);
+      else if (!strcmp(ppcArgv[i], "--repeats")) uiRepeats = (unsigned)atoi(pcValue);
+      else if (!strcmp(ppcArgv[i], "--csv")) pcCsv = pcValue;
+      else if (!strcmp(ppcArgv[i], "--triangles"))
+      {
+         auiTriangles.clear();
+         for (const char* pc = pcValue; *pc; pc += strcspn(pc, ",") + (pc[strcspn(pc, ",")] ? 1 : 0))
+         {
+            auiTriangles.push_back((size_t)atol(pc));
+         }
+      }
+      else
+      {
+         fprintf(stderr, "Unknown option %s\n", ppcArgv[i]);
+         return 1;
+      }
+   }
+
+   BenchmarkSession sSession;
+   if (!sSession.m_bReady)
+   {
+      return 1;
+   }
+
+   PTEnvironment environment = PV_ENTITY_NULL;
+   PFEnvironmentCreate(NULL, &environment);
+
+   std::vector<ScalingPoint> asPoints;
+   for (unsigned uiDepth = 1; uiDepth <= uiMaxDepth; uiDepth++)
+   {
+      for (size_t uiTriangles : auiTriangles)
+      {
+         ScalingPoint sPoint;
+         sPoint.m_uiDepth = sShape.m_uiDepth = uiDepth;
+         sPoint.m_uiTriangles = sShape.m_uiTriangles = uiTriangles;
+         sPoint.m_sAssembly = BenchmarkCreateAssembly(sShape);
+
+         A3DPolygonicaOptions pgOpts;
+         pgOpts.m_Environment = environment;
+         pgOpts.m_uiThreadCount = uiThreads;
+         pgOpts.m_bWeldVertices = dWeldTolerance >= 0.;
+         pgOpts.m_dWeldTolerance = std::max(0., dWeldTolerance);
+         pgOpts.m_bReorderTriangles = lReorderMin >= 0;
+         pgOpts.m_uiReorderMinTriangles = (size_t)std::max(0L, lReorderMin);
+         PFWorldCreate(environment, NULL, &pgOpts.m_World);
+
+         size_t uiBefore = BenchmarkResidentBytes(), uiAfter = 0;
+         double dBestSeconds = -1.;
+         sPoint.m_dWeldMs = sPoint.m_dReorderMs = sPoint.m_dSolidMs = 0.;
+         sPoint.m_dSeconds = BenchmarkBestSeconds(uiRepeats,
+            [&]()
+            {
+               A3DModelCreatePGWorld(sPoint.m_sAssembly.m_pModelFile, pgOpts);
+            },
+            [&]()
+            {
+               if (!uiAfter)
+               {
+                  uiAfter = BenchmarkResidentBytes();
+               }
+               sPoint.m_uiVerticesBefore = pgOpts.m_uiVerticesBeforeWelding;
+               sPoint.m_uiVerticesAfter = pgOpts.m_uiVerticesAfterWelding;
+#ifdef A3D_BRIDGE_STATS
+               if (dBestSeconds < 0. || pgOpts.m_dTotalSeconds < dBestSeconds)
+               {
+                  dBestSeconds = pgOpts.m_dTotalSeconds;
+                  sPoint.m_dWeldMs = 1e-6 * (double)pgOpts.m_stats.m_auiWallNs[A3D_PHASE_WELD];
+                  sPoint.m_dReorderMs = 1e-6 * (double)pgOpts.m_stats.m_auiWallNs[A3D_PHASE_REORDER];
+                  sPoint.m_dSolidMs = 1e-6 * (double)pgOpts.m_stats.m_auiWallNs[A3D_PHASE_SOLIDS];
+               }
+#else
+               (void)dBestSeconds;
+#endif
+               A3DDestroyBridgeWorldEntities(pgOpts);
+               A3DDestroyBridgeSolids(pgOpts);
+               A3DDestroyBridgeData(pgOpts);
+               pgOpts.m_iTopoFaceCount = 0;
+            });
+         sPoint.m_dMegabytes = uiAfter > uiBefore ? (double)(uiAfter - uiBefore) / (1024. * 1024.) : 0.;
+
+         PFWorldDestroy(pgOpts.m_World);
+         A3DAsmModelFileDelete(sPoint.m_sAssembly.m_pModelFile);
+         sPoint.m_sAssembly.m_pModelFile = NULL;
+         asPoints.push_back(sPoint);
+      }
+   }
+
+   PFEnvironmentDestroy(environment);
+
+   double dMaxSeconds = 0., dMaxMegabytes = 0.;
+   for (const ScalingPoint& sPoint : asPoints)
+   {
+      dMaxSeconds = std::max(dMaxSeconds, sPoint.m_dSeconds);
+      dMaxMegabytes = std::max(dMaxMegabytes, sPoint.m_dMegabytes);
+   }
+
+   printf("fan-out %u, instancing %.2f, fans %.2f, strips %.2f, colours %u, separate faces %d, seed %u, threads %u, weld %s, reorder %s\n",
+          sShape.m_uiFanOut, sShape.m_dInstancing, sShape.m_dFans, sShape.m_dStrips, sShape.m_uiColours,
+          (int)sShape.m_bSeparateFaces, sShape.m_uiSeed, uiThreads, dWeldTolerance >= 0. ? std::to_string(dWeldTolerance).c_str() : "off",
+          lReorderMin >= 0 ? std::to_string(lReorderMin).c_str() : "off");
+   printf("%5s %10s %7s %9s %11s %14s %10s %9s  %-42s %-42s\n", "depth", "triangles", "parts", "instances", "part.tris",
+          "inst.triangles", "seconds", "MB", "seconds", "MB");
+   for (const ScalingPoint& sPoint : asPoints)
+   {
+      const BenchmarkAssembly& sAssembly = sPoint.m_sAssembly;
+      printf("%5u %10zu %7zu %9zu %11zu %14zu %10.4f %9.1f ", sPoint.m_uiDepth, sPoint.m_uiTriangles, sAssembly.m_uiParts,
+             sAssembly.m_uiInstances, sAssembly.m_uiTriangles, sAssembly.m_uiInstancedTriangles, sPoint.m_dSeconds,
+             sPoint.m_dMegabytes);
+      stPrintBar(sPoint.m_dSeconds, dMaxSeconds);
+      stPrintBar(sPoint.m_dMegabytes, dMaxMegabytes);
+      printf("\n");
+   }
+
+   if (dWeldTolerance >= 0. || lReorderMin >= 0)
+   {
+      printf("\n%5s %10s %14s %14s %9s %10s %11s %12s\n", "depth", "triangles", "vertices", "welded", "reduced", "weld ms",
+             "reorder ms", "solids ms");
+      for (const ScalingPoint& sPoint : asPoints)
+      {
+         double dReduced = sPoint.m_uiVerticesBefore ?
+            100. * (1. - (double)sPoint.m_uiVerticesAfter / (double)sPoint.m_uiVerticesBefore) : 0.;
+         printf("%5u %10zu %14zu %14zu %8.1f%% %10.2f %11.2f %12.2f\n", sPoint.m_uiDepth, sPoint.m_uiTriangles,
+                sPoint.m_uiVerticesBefore, sPoint.m_uiVerticesAfter, dReduced, sPoint.m_dWeldMs, sPoint.m_dReorderMs,
+                sPoint.m_dSolidMs);
+      }
+   }
+
+   if (pcCsv)
+   {
+      FILE* pFile = fopen(pcCsv, "wb");
+      if (!pFile)
+      {
+         fprintf(stderr, "Cannot write %s\n", pcCsv);
+         return 1;
+      }
+      fprintf(pFile, "depth,triangles_per_part,parts,instances,part_triangles,instanced_triangles,seconds,megabytes,"
+                     "vertices_before_welding,vertices_after_welding,weld_ms,reorder_ms,solids_ms\n");
+      for (const ScalingPoint& sPoint : asPoints)
+      {
+         const BenchmarkAssembly& sAssembly = sPoint.m_sAssembly;
+         fprintf(pFile, "%u,%zu,%zu,%zu,%zu,%zu,%.6f,%.3f,%zu,%zu,%.3f,%.3f,%.3f\n", sPoint.m_uiDepth, sPoint.m_uiTriangles,
+                 sAssembly.m_uiParts, sAssembly.m_uiInstances, sAssembly.m_uiTriangles, sAssembly.m_uiInstancedTriangles,
+                 sPoint.m_dSeconds, sPoint.m_dMegabytes, sPoint.m_uiVerticesBefore, sPoint.m_uiVerticesAfter,
+                 sPoint.m_dWeldMs, sPoint.m_dReorderMs, sPoint.m_dSolidMs);
+      }
+      fclose(pFile);
+   }
+   return 0;
+}
@@ -0,0 +1,121 @@
+/*
+*   Description:
+*
+*      Transform benchmark
+*      Times the composition of random affine transforms with the general 4x4
+*      MultiplyMatrix and with the affine kernel stComposeAffine, and checks that the
+*      two give the same results.
+*
+*      The kernel is the AVX2 or SSE2 one when the compiler targets them; build with
+*      A3D_BRIDGE_NO_SIMD defined to time the scalar one.
+*
+*      Usage: TransformBenchmark [compositions = 10000000] [repeats = 5]
+*      Returns 1 if a composition differs from MultiplyMatrix by more than the sign of a zero.
+*/
+
+#define INITIALIZE_A3D_API
+#include <A3DSDKIncludes.h>
+
+#include "BenchmarkCommon.hpp"
+#include "ExchangePolygonicaBridge.h"
+
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/* Fills 16 doubles with a random rotation, scale and translation; the last row is 0 0 0 1 */
+static void stRandomAffine(std::mt19937& rng, double* m)
+{
+   std::uniform_real_distribution<double> sDistribution(-1., 1.);
+   for (int iCol = 0; iCol < 4; iCol++)
+   {
+      for (int iRow = 0; iRow < 3; iRow++)
+      {
+         m[4 * iCol + iRow] = iCol == 3 ? 100. * sDistribution(rng) : sDistribution(rng);
+      }
+      m[4 * iCol + 3] = iCol == 3 ? 1. : 0.;
+   }
+}
+
+/* Composes the transforms as a chain, each with the result of the previous one, so that the work cannot be skipped */
+template <typename Compose>
+static double stCompose(const std::vector<double>& adMatrices, size_t uiCompositions, Compose fnCompose)
+{
+   size_t uiMatrices = adMatrices.size() / 16;
+   double adResult[2][16];
+   memcpy(adResult[0], &adMatrices[0], 16 * sizeof(double));
+   for (size_t ui = 0; ui < uiCompositions; ui++)
+   {
+      // Renormalise the chain regularly so that it stays finite
+      const double* pdFather = (ui % 64) ? adResult[ui & 1] : &adMatrices[16 * ((ui / 64) % uiMatrices)];
+      fnCompose(pdFather, &adMatrices[16 * (ui % uiMatrices)], adResult[(ui + 1) & 1]);
+   }
+   return adResult[uiCompositions & 1][12];
+}
+
+int main(int iArgc, char** ppcArgv)
+{
+   size_t uiCompositions = iArgc > 1 ? (size_t)atol(ppcArgv[1]) : 10000000;
+   unsigned uiRepeats = iArgc > 2 ? (unsigned)atoi(ppcArgv[2]) : 5;
+
+#if defined(A3D_BRIDGE_AFFINE_AVX2)
+   const char* pcKernel = "avx2";
+#elif defined(A3D_BRIDGE_AFFINE_SSE2)
+   const char* pcKernel = "sse2";
+#else
+   const char* pcKernel = "scalar";
+#endif
+
+   std::mt19937 rng(1);
+   std::vector<double> adMatrices(16 * 1024);
+   for (size_t ui = 0; ui < adMatrices.size(); ui += 16)
+   {
+      stRandomAffine(rng, &adMatrices[ui]);
+   }
+
+   // Equivalence: every pair composed both ways
+   size_t uiMismatches = 0;
+   for (size_t uiFather = 0; uiFather < adMatrices.size(); uiFather += 16)
+   {
+      for (size_t uiThis = 0; uiThis < adMatrices.size(); uiThis += 16 * 7)
+      {
+         double adExpected[16], adResult[16];
+         MultiplyMatrix(&adMatrices[uiFather], &adMatrices[uiThis], adExpected);
+         stComposeAffine(&adMatrices[uiFather], &adMatrices[uiThis], adResult);
+         for (int i = 0; i < 16; i++)
+         {
+            if (adResult[i] != adExpected[i])
+            {
+               uiMismatches++;
+               break;
+            }
+         }
+      }
+   }
+
+   auto fnGeneral = [](const double* pdFather, const double* pdThis, double* pdResult)
+   {
+      MultiplyMatrix(pdFather, pdThis, pdResult);
+   };
+   auto fnAffine = [](const double* pdFather, const double* pdThis, double* pdResult)
+   {
+      stComposeAffine(pdFather, pdThis, pdResult);
+   };
+
+   // The chains of both kernels must end on the same matrix
+   double dGeneralEnd = 0., dAffineEnd = 0.;
+   double dGeneral = BenchmarkBestSeconds(uiRepeats, [&]() { dGeneralEnd = stCompose(adMatrices, uiCompositions, fnGeneral); }, []() {});
+   double dAffine = BenchmarkBestSeconds(uiRepeats, [&]() { dAffineEnd = stCompose(adMatrices, uiCompositions, fnAffine); }, []() {});
+   if (dAffineEnd != dGeneralEnd)
+   {
+      uiMismatches++;
+   }
+
+   printf("%-14s %-8s %12s %12s\n", "kernel", "isa", "seconds", "ns/compose");
+   printf("%-14s %-8s %12.4f %12.2f\n", "MultiplyMatrix", "scalar", dGeneral, 1e9 * dGeneral / (double)uiCompositions);
+   printf("%-14s %-8s %12.4f %12.2f\n", "ComposeAffine", pcKernel, dAffine, 1e9 * dAffine / (double)uiCompositions);
+   printf("speedup %.2fx, mismatches %zu, chain difference %g\n", dGeneral / dAffine, uiMismatches, dGeneralEnd - dAffineEnd);
+
+   return uiMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+*   Description:
+*
+*      Traversal benchmark
+*      Times A3DModelCreatePGWorld on synthetic assemblies whose cost is dominated by
+*      the assembly traversal: every part holds the same one-triangle poly brep, so a
+*      single PTSolid is built and the time goes into visiting the occurrences.
+*
+*      deep     - chains of occurrences, each level with a location and a part
+*      wide     - one root with every occurrence as a direct child
+*      balanced - a tree with 10 children per occurrence and parts on the leaves
+*
+*      Usage: TraversalBenchmark [occurrences = 100000] [chain depth = 1000] [repeats = 3]
+*      The program only uses the public bridge functions, so it can be built against
+*      earlier versions of ExchangePolygonicaBridge.h to compare them.
+*/
+
+#define INITIALIZE_A3D_API
+#include <A3DSDKIncludes.h>
+
+#include "BenchmarkCommon.hpp"
+#include "ExchangePolygonicaBridge.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+struct TraversalShape
+{
+   const char* m_pcName;
+   A3DAsmModelFile* m_pModelFile;
+   size_t m_uiOccurrences;
+   size_t m_uiDepth;
+};
+/***TraversalShape****************************************************/
+
+static TraversalShape stCreateDeep(A3DRiRepresentationItem* pRepItem, size_t uiOccurrences, size_t uiDepth)
+{
+   A3DAsmPartDefinition* pPart = BenchmarkCreatePart({ pRepItem });
+   size_t uiChains = std::max<size_t>(1, uiOccurrences / uiDepth);
+
+   std::vector<A3DAsmProductOccurrence*> apRoots;
+   for (size_t uiChain = 0; uiChain < uiChains; uiChain++)
+   {
+      // Built from the leaf up
+      A3DAsmProductOccurrence* pChild = NULL;
+      for (size_t uiLevel = 0; uiLevel < uiDepth; uiLevel++)
+      {
+         std::vector<A3DAsmProductOccurrence*> apChildren;
+         if (pChild)
+         {
+            apChildren.push_back(pChild);
+         }
+         pChild = BenchmarkCreateOccurrence(apChildren, pPart, NULL, BenchmarkCreateLocation(0., 0., 1.));
+      }
+      apRoots.push_back(pChild);
+   }
+
+   return { "deep", BenchmarkCreateModelFile(apRoots), uiChains * uiDepth, uiDepth };
+}
+
+static TraversalShape stCreateWide(A3DRiRepresentationItem* pRepItem, size_t uiOccurrences)
+{
+   A3DAsmPartDefinition* pPart = BenchmarkCreatePart({ pRepItem });
+
+   std::vector<A3DAsmProductOccurrence*> apChildren;
+   for (size_t ui = 0; ui < uiOccurrences; ui++)
+   {
+      apChildren.push_back(BenchmarkCreateOccurrence({}, pPart, NULL, BenchmarkCreateLocation((double)ui, 0., 0.)));
+   }
+   A3DAsmProductOccurrence* pRoot = BenchmarkCreateOccurrence(apChildren, NULL, NULL, NULL);
+
+   return { "wide", BenchmarkCreateModelFile({ pRoot }), uiOccurrences + 1, 2 };
+}
+
+static A3DAsmProductOccurrence* stCreateBalancedLevel(A3DAsmPartDefinition* pPart, size_t uiLevels, size_t& uiOccurrences)
+{
+   uiOccurrences++;
+   if (uiLevels == 0)
+   {
+      return BenchmarkCreateOccurrence({}, pPart, NULL, BenchmarkCreateLocation(1., 0., 0.));
+   }
+
+   std::vector<A3DAsmProductOccurrence*> apChildren;
+   for (int i = 0; i < 10; i++)
+   {
+      apChildren.push_back(stCreateBalancedLevel(pPart, uiLevels - 1, uiOccurrences));
+   }
+   return BenchmarkCreateOccurrence(apChildren, NULL, NULL, BenchmarkCreateLocation(0., 1., 0.));
+}
+
+static TraversalShape stCreateBalanced(A3DRiRepresentationItem* pRepItem, size_t uiOccurrences)
+{
+   A3DAsmPartDefinition* pPart = BenchmarkCreatePart({ pRepItem });
+
+   // Enough levels of 10 children for the requested number of leaves
+   size_t uiLevels = 1;
+   for (size_t uiLeaves = 10; uiLeaves < uiOccurrences; uiLeaves *= 10)
+   {
+      uiLevels++;
+   }
+
+   size_t uiCount = 0;
+   A3DAsmProductOccurrence* pRoot = stCreateBalancedLevel(pPart, uiLevels, uiCount);
+   return { "balanced", BenchmarkCreateModelFile({ pRoot }), uiCount, uiLevels + 1 };
+}
+
+int main(int iArgc, char** ppcArgv)
+{
+   size_t uiOccurrences = iArgc > 1 ? (size_t)atol(ppcArgv[1]) : 100000;
+   size_t uiDepth = iArgc > 2 ? (size_t)atol(ppcArgv[2]) : 1000;
+   unsigned uiRepeats = iArgc > 3 ? (unsigned)atoi(ppcArgv[3]) : 3;
+   uiDepth = std::max<size_t>(1, uiDepth);
+
+   BenchmarkSession sSession;
+   if (!sSession.m_bReady)
+   {
+      return 1;
+   }
+
+   PTEnvironment environment = PV_ENTITY_NULL;
+   PFEnvironmentCreate(NULL, &environment);
+
+   printf("%-10s %12s %12s %8s %12s %14s\n", "shape", "occurrences", "entities", "depth", "seconds", "ns/occurrence");
+
+   // Each model owns its entities, so each gets its own poly brep
+   TraversalShape asShapes[] = { stCreateDeep(BenchmarkCreateTriangleRepItem(), uiOccurrences, uiDepth),
+                                 stCreateWide(BenchmarkCreateTriangleRepItem(), uiOccurrences),
+                                 stCreateBalanced(BenchmarkCreateTriangleRepItem(), uiOccurrences) };
+
+   for (TraversalShape& sShape : asShapes)
+   {
+      A3DPolygonicaOptions pgOpts;
+      pgOpts.m_Environment = environment;
+      PFWorldCreate(environment, NULL, &pgOpts.m_World);
+
+      size_t uiEntities = 0;
+      double dSeconds = BenchmarkBestSeconds(uiRepeats,
+         [&]()
+         {
+            A3DModelCreatePGWorld(sShape.m_pModelFile, pgOpts);
+            uiEntities = pgOpts.m_entities.size();
+         },
+         [&]()
+         {
+            A3DDestroyBridgeWorldEntities(pgOpts);
+            A3DDestroyBridgeSolids(pgOpts);
+            A3DDestroyBridgeData(pgOpts);
+            pgOpts.m_iTopoFaceCount = 0;
+         });
+
+      printf("%-10s %12zu %12zu %8zu %12.4f %14.1f\n", sShape.m_pcName, sShape.m_uiOccurrences, uiEntities,
+             sShape.m_uiDepth, dSeconds, 1e9 * dSeconds / (double)sShape.m_uiOccurrences);
+
+      PFWorldDestroy(pgOpts.m_World);
+      A3DAsmModelFileDelete(sShape.m_pModelFile);
+   }
+
+   PFEnvironmentDestroy(environment);
+   return 0;
+}
@@ -26,9 +26,54 @@
 #include "pg/pgrender.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <string>
+#include <vector>
+
+/* The affine transform kernel uses AVX2 or SSE2 when the compiler targets them */
+/* Define A3D_BRIDGE_NO_SIMD to use the scalar kernel */
+/* It gives the results of MultiplyMatrix only if neither is contracted into fused multiply-adds, which GCC does */
+/* for FMA targets such as -march=native unless built with -ffp-contract=off, as the CMake bridge target is */
+#if !defined(A3D_BRIDGE_NO_SIMD) && defined(__AVX2__)
+#define A3D_BRIDGE_AFFINE_AVX2
+#include <immintrin.h>
+#elif !defined(A3D_BRIDGE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define A3D_BRIDGE_AFFINE_SSE2
+#include <emmintrin.h>
+#endif
+
+/* The mesh cache maps its files into memory, see A3DPolygonicaOptions::m_sMeshCacheDirectory */
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Define A3D_BRIDGE_STATS to collect the A3DBridgeStats of each conversion in A3DPolygonicaOptions::m_stats */
+/* Without it the timers and counters compile to nothing */
+#if defined(A3D_BRIDGE_STATS) && !defined(_WIN32)
+#include <time.h>
+#endif
 
 /*********************************************************************/
 /***defines***********************************************************/
@@ -38,6 +83,18 @@
 #define A3D_PG_INVALID_RI        2
 #define A3D_PG_ERROR             3
 
+/* Vertices of congruent meshes may differ by this fraction of the mesh radius in their canonical frames */
+#define A3D_BRIDGE_CONGRUENCE_TOLERANCE 1e-6
+
+/* Colour and material indices below this are resolved once per conversion in a flat table */
+#define A3D_BRIDGE_COLOUR_TABLE_MAX 65536
+
+/* Threads that can record spans in one A3DBridgeTracer; the spans of further threads are dropped */
+#define A3D_BRIDGE_TRACE_MAX_THREADS 256
+
+/* The version of the mesh cache files; files of another version are ignored and written again */
+#define A3D_BRIDGE_MESH_CACHE_VERSION 2
+
 /* The use of 'static' is to provide support for older compilers that do not support 'inline' */
 /* If you are using a modern compiler inline should probably be used */
 #ifdef __cplusplus
@@ -58,13 +115,22 @@
       size_ = 0;                           \
    }
 
-#define COPY_(dest, src, size_)            \
-   if (size_)                              \
-   {                                       \
-      size_t uTempSize = dest.size();      \
-      dest.resize(uTempSize + size_);      \
-      std::copy(src, src+size_, dest.begin() + uTempSize); \
-   }
+#ifdef A3D_BRIDGE_STATS
+#define A3D_BRIDGE_STATS_CONCAT2(a, b) a##b
+#define A3D_BRIDGE_STATS_CONCAT(a, b) A3D_BRIDGE_STATS_CONCAT2(a, b)
+/* The A3DBridgeStats of the options, NULL without A3D_BRIDGE_STATS */
+#define A3D_BRIDGE_STATS_OF(opts) (&(opts).m_stats)
+/* Adds the time to the end of the enclosing scope to a phase; pStats may be NULL */
+#define A3D_BRIDGE_TIME_PHASE(pStats, ePhase) \
+   A3DBridgePhaseTimer A3D_BRIDGE_STATS_CONCAT(sPhaseTimer, __LINE__)(pStats, ePhase)
+/* Adds to a counter of A3DBridgeStats; pStats may be NULL */
+#define A3D_BRIDGE_COUNT(pStats, member, n) \
+   do { if (pStats) { (pStats)->member += (n); } } while (0)
+#else
+#define A3D_BRIDGE_STATS_OF(opts) ((A3DBridgeStats*)NULL)
+#define A3D_BRIDGE_TIME_PHASE(pStats, ePhase)
+#define A3D_BRIDGE_COUNT(pStats, member, n)
+#endif
 
 /*********************************************************************/
 /***structs***********************************************************/
@@ -80,6 +146,609 @@ enum A3D_log_level
 
 typedef void (*A3D_log_func)(std::string, A3D_log_level);
 
+/* Called as each world entity is added with the entity, its solid, world transform, render style, */
+/* path id in m_path_trie and the user data given with the callback */
+typedef void (*A3D_entity_func)(PTWorldEntity, PTSolid, const PTTransformMatrix, PTRenderStyle, A3DUns32, void*);
+
+/* Returns the priority of a product occurrence; siblings are visited from the highest priority */
+typedef double (*A3D_priority_func)(const A3DAsmProductOccurrence*, void*);
+
+/* The tessellation of a representation item decoded for PFSolidCreateFromMesh */
+struct A3DBridgeMesh
+{
+   /* Three vertex indices per triangle, three normal indices per triangle and the face of the tessellation each */
+   /* triangle belongs to, unless they are borrowed; read them with stMeshIndices, stMeshNormalIndices and */
+   /* stMeshTriangleFaces */
+   std::vector<unsigned> m_auiIndices;
+   std::vector<PTInt32> m_aiNormalIndices;
+   std::vector<unsigned> m_auiTriangleFaces;
+   /* Vertex coordinates and normals, three doubles each, unless they are borrowed; read them with stMeshCoords */
+   /* and stMeshNormals */
+   std::vector<double> m_adCoords;
+   std::vector<double> m_adNormals;
+   /* If not NULL, the triangles are still those of the mapped mesh cache file, m_uiBorrowedTriangles of them */
+   const unsigned* m_puiBorrowedIndices = nullptr;
+   const PTInt32* m_piBorrowedNormalIndices = nullptr;
+   const unsigned* m_puiBorrowedTriangleFaces = nullptr;
+   size_t m_uiBorrowedTriangles = 0;
+   /* If not NULL, the coordinates or normals are still those of the Exchange tessellation the mesh holds, or of */
+   /* the mapped mesh cache file, with m_uiBorrowedCoordSize and m_uiBorrowedNormalSize doubles */
+   const double* m_pdBorrowedCoords = nullptr;
+   const double* m_pdBorrowedNormals = nullptr;
+   size_t m_uiBorrowedCoordSize = 0;
+   size_t m_uiBorrowedNormalSize = 0;
+   /* The Exchange tessellation of the item, held until stReleaseMeshTessellation if m_bHoldsTessellation */
+   bool m_bHoldsTessellation = false;
+   A3DTess3DData m_sTessData = A3DTess3DData();
+   A3DTessBaseData m_sBaseTessData = A3DTessBaseData();
+   /* Number of faces in the tessellation, including faces without triangles */
+   unsigned m_uiFaceCount = 0;
+};
+/***A3DBridgeMesh*****************************************************/
+
+/* The frame of a mesh anchored on its centroid and two of its vertices */
+/* A copy of the mesh moved by a rigid motion has the same vertices in its own frame */
+struct A3DBridgeMeshPose
+{
+   /* The columns are the axes: coordinates = rotation * canonical coordinates + centroid */
+   double m_adRotation[9];
+   double m_adCentroid[3];
+   /* The largest distance of a vertex from the centroid */
+   double m_dRadius = 0.;
+};
+/***A3DBridgeMeshPose*************************************************/
+
+/* The keys of a decoded mesh in A3DBridgeMeshTable */
+struct A3DBridgeMeshKeys
+{
+   A3DUns64 m_uiHash = 0;
+   /* False if the mesh has no frame, e.g. when all its vertices are collinear */
+   bool m_bPose = false;
+   A3DBridgeMeshPose m_sPose;
+   A3DUns64 m_uiPoseHash = 0;
+};
+/***A3DBridgeMeshKeys*************************************************/
+
+/* The representation items that built a PTSolid, by the hash of their decoded mesh */
+/* An item whose mesh is identical, or congruent, to one of them shares its PTSolid */
+struct A3DBridgeMeshTable
+{
+   std::unordered_multimap<A3DUns64, const A3DRiRepresentationItem*> m_items;
+   /* By the hash of the connectivity and size of their mesh */
+   std::unordered_multimap<A3DUns64, const A3DRiRepresentationItem*> m_congruentItems;
+   /* Items that reused the PTSolid of an earlier item with an identical or a congruent mesh */
+   size_t m_uiSharedItems = 0;
+   size_t m_uiCongruentItems = 0;
+   /* The bytes of the meshes of both not passed to Polygonica */
+   size_t m_uiSharedBytes = 0;
+   /* Equal hashes of meshes that were not identical or congruent */
+   size_t m_uiCollisions = 0;
+   /* The meshes of the items added to the table as they were compared, so that later items are compared with them */
+   /* without decoding them again; released when A3DModelCreatePGWorld ends */
+   std::unordered_map<const A3DRiRepresentationItem*, A3DBridgeMesh> m_meshes;
+};
+/***A3DBridgeMeshTable************************************************/
+
+/* The header at the start of a mesh cache file */
+/* It is followed by the arrays of the meshes, each at an offset that is a multiple of 8, then by the entries */
+struct A3DBridgeMeshCacheHeader
+{
+   char m_acMagic[8];
+   A3DUns32 m_uiVersion;
+   /* sizeof(unsigned) and sizeof(PTInt32), so that a file is only read with the types it was written with */
+   A3DUns16 m_usIndexBytes;
+   A3DUns16 m_usNormalIndexBytes;
+   A3DUns64 m_uiFileBytes;
+   A3DUns64 m_uiItemCount;
+   /* The offset of the m_uiItemCount A3DBridgeMeshCacheEntry */
+   A3DUns64 m_uiEntries;
+};
+/***A3DBridgeMeshCacheHeader******************************************/
+
+/* The arrays of one decoded mesh in a mesh cache file, as offsets from the start of the file */
+struct A3DBridgeMeshCacheEntry
+{
+   A3DUns64 m_uiTriangles;
+   /* 3 * m_uiTriangles unsigned, then 3 * m_uiTriangles PTInt32, then m_uiTriangles unsigned */
+   A3DUns64 m_uiIndices;
+   A3DUns64 m_uiNormalIndices;
+   A3DUns64 m_uiTriangleFaces;
+   /* Doubles */
+   A3DUns64 m_uiCoordCount;
+   A3DUns64 m_uiCoords;
+   A3DUns64 m_uiNormalCount;
+   A3DUns64 m_uiNormals;
+   A3DUns64 m_uiFaceCount;
+   /* The stMeshCacheIdentity of the item the mesh was decoded from, checked before the mesh is read */
+   A3DUns64 m_uiIdentity;
+};
+/***A3DBridgeMeshCacheEntry*******************************************/
+
+/* The mesh cache file of one conversion, numbering the representation items in the order their PTSolids are built */
+/* A complete file is mapped and read; otherwise the meshes are appended to a temporary file that replaces it */
+/* once the conversion succeeds */
+struct A3DBridgeMeshCache
+{
+   std::string m_sPath;
+   /* Reading */
+   const unsigned char* m_pcData = nullptr;
+   size_t m_uiBytes = 0;
+   const A3DBridgeMeshCacheEntry* m_pEntries = nullptr;
+   size_t m_uiItemCount = 0;
+#ifdef _WIN32
+   HANDLE m_hFile = INVALID_HANDLE_VALUE;
+   HANDLE m_hMapping = NULL;
+#endif
+   /* Writing */
+   FILE* m_pFile = nullptr;
+   std::string m_sTempPath;
+   std::vector<A3DBridgeMeshCacheEntry> m_entries;
+   A3DUns64 m_uiOffset = 0;
+   bool m_bFailed = false;
+   /* The number of the next representation item */
+   size_t m_uiNextItem = 0;
+   /* Items read from the file */
+   std::atomic<size_t> m_uiHits{ 0 };
+   /* Set when an entry belongs to another item, e.g. as the items are built in another order; the file is then */
+   /* removed on closing so that the next conversion writes it again */
+   std::atomic<bool> m_bStale{ false };
+};
+/***A3DBridgeMeshCache************************************************/
+
+/* A world entity recorded during traversal, added once its PTSolid exists */
+struct A3DBridgeInstance
+{
+   const A3DRiRepresentationItem* m_pRepItem;
+   PTTransformMatrix m_transform;
+   float m_afRgb[3];
+   A3DUns32 m_uiPathId;
+};
+/***A3DBridgeInstance*************************************************/
+
+/* Work collected by the traversal when PTSolids are built in parallel */
+struct A3DBridgeDeferredWork
+{
+   /* The world entities in traversal order */
+   std::vector<A3DBridgeInstance> m_instances;
+   /* The representation items without a PTSolid in the order first met */
+   std::vector<const A3DRiRepresentationItem*> m_uniqueItems;
+   /* For each of m_uniqueItems, the count of m_instances when it was first met. The instances before it */
+   /* only use the items before it, so they can be added once those are built */
+   std::vector<size_t> m_firstInstances;
+};
+/***A3DBridgeDeferredWork*********************************************/
+
+/* Assembly paths stored as a trie: each path is its last node and the id of the path to its parent */
+/* Paths with a common prefix share the ids of that prefix. Path 0 is the empty path */
+struct A3DBridgePathTrie
+{
+   std::vector<void*> m_nodes = { NULL };
+   std::vector<A3DUns32> m_parents = { 0 };
+};
+/***A3DBridgePathTrie*************************************************/
+
+/* The world entities of a prototype subassembly, recorded once and replayed for its other instances */
+struct A3DBridgePrototypeRecord
+{
+   /* Transforms are relative to the occurrence using the prototype and path ids are in m_trie */
+   std::vector<A3DBridgeInstance> m_instances;
+   /* The assembly paths below the occurrence using the prototype */
+   A3DBridgePathTrie m_trie;
+};
+/***A3DBridgePrototypeRecord******************************************/
+
+/* A prototype whose subtree is being visited and recorded */
+struct A3DBridgePrototypeRecording
+{
+   /* The prototype and the colour it inherits */
+   std::pair<const A3DEntity*, A3DUns64> m_key;
+   /* The recording ends when the frame stack is back to this size */
+   size_t m_uiFrames;
+   /* The transform and path id of the occurrence using the prototype */
+   PTTransformMatrix m_parentTransform;
+   A3DUns32 m_uiParentPathId;
+   A3DBridgePrototypeRecord m_record;
+};
+/***A3DBridgePrototypeRecording***************************************/
+
+/* A colour or material index of the Exchange global tables */
+struct A3DBridgeColourEntry
+{
+   bool m_bResolved = false;
+   bool m_bIsTexture = false;
+   /* False if Exchange has no colour for the index */
+   bool m_bHasRgb = false;
+   float m_afRgb[3];
+};
+/***A3DBridgeColourEntry**********************************************/
+
+/* The colours and materials of the Exchange global tables, resolved once per conversion and indexed like them */
+struct A3DBridgeColourTable
+{
+   std::vector<A3DBridgeColourEntry> m_colours;
+   std::vector<A3DBridgeColourEntry> m_materials;
+   /* Exchange global calls made to fill the table, and avoided compared to stExtractColorFromGraphicData */
+   size_t m_uiCallsMade = 0;
+   size_t m_uiCallsAvoided = 0;
+};
+/***A3DBridgeColourTable**********************************************/
+
+/* The cascaded attributes of a node below parent attributes with a given style id */
+struct A3DBridgeCascadedEntry
+{
+   A3DMiscCascadedAttributes* m_pAttr;
+   A3DMiscCascadedAttributesData m_sData;
+   /* The style id of m_sData, for the children of the node */
+   A3DUns32 m_uiStyle;
+   /* The colour resolved from m_sData, once a representation item needed it */
+   bool m_bHasRgb = false;
+   float m_afRgb[3];
+};
+/***A3DBridgeCascadedEntry********************************************/
+
+/* A span of the conversion recorded by A3DBridgeTracer */
+struct A3DBridgeTraceEvent
+{
+   /* The node name, or the function when the node is not known */
+   std::string m_sName;
+   /* occurrence, part, item, solid or decode */
+   const char* m_pcCategory;
+   /* Nanoseconds from the creation of the tracer */
+   A3DUns64 m_uiStartNs;
+   A3DUns64 m_uiDurationNs;
+   /* The triangles of the PTSolids built during the span */
+   size_t m_uiTriangles;
+};
+/***A3DBridgeTraceEvent***********************************************/
+
+/* The events of one thread; only that thread appends to it while the conversion runs */
+struct A3DBridgeTraceBuffer
+{
+   std::thread::id m_threadId;
+   std::vector<A3DBridgeTraceEvent> m_events;
+   /* Triangles of the PTSolids built by the thread so far */
+   size_t m_uiTriangles = 0;
+};
+/***A3DBridgeTraceBuffer**********************************************/
+
+/* Records spans of conversions for a Chrome trace-event file, see A3DBridgeTracerWrite */
+/* Each thread registers its own buffer once without a lock, so the thread pool is not serialised */
+struct A3DBridgeTracer
+{
+   std::chrono::steady_clock::time_point m_tEpoch;
+   /* Distinguishes the tracer from earlier ones at the same address in the buffer cache of each thread */
+   A3DUns64 m_uiId;
+   std::atomic<A3DBridgeTraceBuffer*> m_apBuffers[A3D_BRIDGE_TRACE_MAX_THREADS] = {};
+   std::atomic<unsigned> m_uiBuffers{ 0 };
+
+   A3DBridgeTracer() : m_tEpoch(std::chrono::steady_clock::now())
+   {
+      static std::atomic<A3DUns64> s_uiNextId{ 1 };
+      m_uiId = s_uiNextId++;
+   }
+
+   ~A3DBridgeTracer()
+   {
+      for (unsigned ui = 0; ui < BufferCount(); ui++)
+      {
+         delete m_apBuffers[ui].load();
+      }
+   }
+
+   A3DBridgeTracer(const A3DBridgeTracer&) = delete;
+   A3DBridgeTracer& operator=(const A3DBridgeTracer&) = delete;
+
+   unsigned BufferCount() const
+   {
+      return std::min<unsigned>(m_uiBuffers.load(), A3D_BRIDGE_TRACE_MAX_THREADS);
+   }
+
+   A3DUns64 NowNs() const
+   {
+      return (A3DUns64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_tEpoch).count();
+   }
+
+   /* The buffer of the calling thread, registered on its first call; NULL once every slot is taken */
+   A3DBridgeTraceBuffer* ThreadBuffer()
+   {
+      static thread_local A3DUns64 s_uiTracer = 0;
+      static thread_local A3DBridgeTraceBuffer* s_pBuffer = NULL;
+      if (s_uiTracer == m_uiId)
+      {
+         return s_pBuffer;
+      }
+
+      // The thread may have registered before recording for another tracer
+      std::thread::id threadId = std::this_thread::get_id();
+      A3DBridgeTraceBuffer* pBuffer = NULL;
+      for (unsigned ui = 0; ui < BufferCount() && !pBuffer; ui++)
+      {
+         A3DBridgeTraceBuffer* pCandidate = m_apBuffers[ui].load(std::memory_order_acquire);
+         if (pCandidate && pCandidate->m_threadId == threadId)
+         {
+            pBuffer = pCandidate;
+         }
+      }
+      if (!pBuffer)
+      {
+         unsigned uiSlot = m_uiBuffers.fetch_add(1);
+         if (uiSlot < A3D_BRIDGE_TRACE_MAX_THREADS)
+         {
+            pBuffer = new A3DBridgeTraceBuffer;
+            pBuffer->m_threadId = threadId;
+            m_apBuffers[uiSlot].store(pBuffer, std::memory_order_release);
+         }
+      }
+      s_uiTracer = m_uiId;
+      s_pBuffer = pBuffer;
+      return pBuffer;
+   }
+};
+/***A3DBridgeTracer***************************************************/
+
+/* Records a span from its construction to its destruction; does nothing without a tracer */
+struct A3DBridgeTraceSpan
+{
+   A3DBridgeTraceBuffer* m_pBuffer = NULL;
+   const A3DBridgeTracer* m_pTracer;
+   A3DBridgeTraceEvent m_sEvent;
+   size_t m_uiTrianglesStart = 0;
+
+   A3DBridgeTraceSpan(A3DBridgeTracer* pTracer, const char* pcCategory, const char* pcName = "") : m_pTracer(pTracer)
+   {
+      if (pTracer)
+      {
+         m_pBuffer = pTracer->ThreadBuffer();
+         m_sEvent.m_sName = pcName;
+         m_sEvent.m_pcCategory = pcCategory;
+         m_sEvent.m_uiStartNs = pTracer->NowNs();
+         m_uiTrianglesStart = m_pBuffer ? m_pBuffer->m_uiTriangles : 0;
+      }
+   }
+
+   ~A3DBridgeTraceSpan()
+   {
+      if (m_pBuffer)
+      {
+         m_sEvent.m_uiDurationNs = m_pTracer->NowNs() - m_sEvent.m_uiStartNs;
+         m_sEvent.m_uiTriangles = m_pBuffer->m_uiTriangles - m_uiTrianglesStart;
+         m_pBuffer->m_events.push_back(std::move(m_sEvent));
+      }
+   }
+
+   bool IsRecording() const { return m_pBuffer != NULL; }
+
+   /* Counts triangles built by the thread, in this span and in the spans enclosing it */
+   void AddTriangles(size_t uiTriangles)
+   {
+      if (m_pBuffer)
+      {
+         m_pBuffer->m_uiTriangles += uiTriangles;
+      }
+   }
+};
+/***A3DBridgeTraceSpan************************************************/
+
+/* A node of the iterative traversal whose span lasts until its subtree has been visited */
+struct A3DBridgeTraceOpenSpan
+{
+   A3DBridgeTraceEvent m_sEvent;
+   /* The span ends once the stack of frames is back to this size */
+   size_t m_uiFrames;
+   size_t m_uiTrianglesStart;
+};
+/***A3DBridgeTraceOpenSpan********************************************/
+
+/* A node waiting to be visited by the iterative traversal */
+struct A3DBridgeTraversalFrame
+{
+   enum Kind
+   {
+      kProductOccurrence,
+      kPrototype,
+      kPartDefinition,
+      kRepItem
+   };
+
+   Kind m_eKind;
+   const A3DEntity* m_pNode;
+   /* The state of the parent when the frame was pushed: */
+   /* the number of path ids, the index of its transform and the number of cascaded attributes */
+   size_t m_uiPathSize;
+   size_t m_uiTransform;
+   size_t m_uiAttributes;
+};
+/***A3DBridgeTraversalFrame*******************************************/
+
+/* The stacks shared by every node of the iterative traversal */
+/* A frame unwinds them to the state of its parent before it is visited */
+struct A3DBridgeTraversal
+{
+   std::vector<A3DBridgeTraversalFrame> m_frames;
+   /* Path ids of the ancestors; the last is the path of the current node */
+   /* They are in the trie of the innermost recording, or in m_path_trie without recordings */
+   std::vector<A3DUns32> m_pathIds;
+   /* 16 doubles per transform */
+   std::vector<double> m_transforms;
+   /* The local matrix of each distinct transformation, decoded once: 16 doubles at the index of the map */
+   std::unordered_map<const A3DEntity*, size_t> m_localTransforms;
+   std::vector<double> m_localMatrices;
+   /* Compare every composed transform with MultiplyMatrix and count the differences */
+   bool m_bCheckTransforms = false;
+   size_t m_uiTransformMismatches = 0;
+   /* Cascaded attributes of the ancestors; the first belongs to the caller */
+   std::vector<A3DMiscCascadedAttributes*> m_attributes;
+   /* With the attribute cache, the cache owns the attributes and the style id of each one is kept here */
+   bool m_bCacheAttributes = false;
+   std::vector<A3DUns32> m_attributeStyles;
+   /* Style ids of the distinct attributes data and the attributes of each (node, parent style id) */
+   std::map<std::string, A3DUns32> m_styleIds;
+   std::map<std::pair<const A3DEntity*, A3DUns32>, A3DBridgeCascadedEntry> m_attributeCache;
+   size_t m_uiAttributeLookups = 0;
+   size_t m_uiAttributeHits = 0;
+   A3DBridgeColourTable m_colourTable;
+   /* The prototypes being recorded, innermost last, and the recorded ones */
+   std::vector<A3DBridgePrototypeRecording> m_recordings;
+   std::map<std::pair<const A3DEntity*, A3DUns64>, A3DBridgePrototypeRecord> m_prototypes;
+   /* With a tracer, the spans of the nodes whose subtree is being visited, innermost last */
+   std::vector<A3DBridgeTraceOpenSpan> m_traceSpans;
+};
+/***A3DBridgeTraversal************************************************/
+
+/* The render styles of the world entities in an open-addressed hash table keyed by packed RGBA */
+struct A3DBridgeStylePalette
+{
+   /* A power of two of slots, empty while their style is PV_ENTITY_NULL. Merged colours share a style */
+   std::vector<A3DUns32> m_keys;
+   std::vector<PTRenderStyle> m_slots;
+   size_t m_uiSlotsUsed = 0;
+   /* The styles created, each once, and their packed colours */
+   std::vector<PTRenderStyle> m_styles;
+   std::vector<A3DUns32> m_colours;
+   /* The colours given the nearest existing style because the palette was full */
+   size_t m_uiMergedColours = 0;
+
+   size_t size() const { return m_styles.size(); }
+};
+/***A3DBridgeStylePalette*********************************************/
+
+/* A CAD surface of a PTSolid built by the bridge */
+struct A3DBridgeTopoFace
+{
+   /* PV_ENTITY_NULL if Polygonica could not build the solid */
+   PTSolid m_solid = PV_ENTITY_NULL;
+   /* The index of the surface in the tessellation of the representation item */
+   long m_iTopoFace = -1;
+};
+/***A3DBridgeTopoFace*************************************************/
+
+/* The phases of a conversion timed by A3DBridgeStats */
+enum A3DBridgePhase
+{
+   /* All of A3DModelCreatePGWorld */
+   A3D_PHASE_CONVERSION,
+   /* The assembly traversal, including the phases it runs in place when m_uiThreadCount <= 1 */
+   A3D_PHASE_TRAVERSAL,
+   /* Exchange getters of the representation items and their tessellations */
+   A3D_PHASE_EXCHANGE,
+   /* IndicesPerFaceAsTriangles and the copies into the decoded meshes */
+   A3D_PHASE_TRIANGLES,
+   /* stWeldMesh */
+   A3D_PHASE_WELD,
+   /* stReorderMesh */
+   A3D_PHASE_REORDER,
+   /* PFSolidCreateFromMesh */
+   A3D_PHASE_SOLIDS,
+   /* Creation and filling of the surface groups, including those of A3DBridgeGetSurfaceGroup */
+   A3D_PHASE_GROUPS,
+   /* LookupRenderStyleByColor */
+   A3D_PHASE_STYLES,
+   /* PFWorldAddEntity and PFWorldEntitySetTransform */
+   A3D_PHASE_WORLD,
+   A3D_PHASE_COUNT
+};
+/***A3DBridgePhase****************************************************/
+
+/* Statistics of the last A3DModelCreatePGWorld, collected when A3D_BRIDGE_STATS is defined */
+/* Phases run on the thread pool add up the times of all its threads, so they may exceed the conversion */
+struct A3DBridgeStats
+{
+   /* Wall and thread CPU nanoseconds per A3DBridgePhase */
+   std::atomic<A3DUns64> m_auiWallNs[A3D_PHASE_COUNT] = {};
+   std::atomic<A3DUns64> m_auiCpuNs[A3D_PHASE_COUNT] = {};
+   /* Assembly tree nodes visited: product occurrences, prototypes, part definitions and representation items */
+   std::atomic<size_t> m_uiNodes{ 0 };
+   /* Distinct representation items, keys of m_parts */
+   std::atomic<size_t> m_uiRepItems{ 0 };
+   /* PTSolids built by Polygonica, fewer than the items when meshes are shared */
+   std::atomic<size_t> m_uiSolids{ 0 };
+   /* Triangles passed to PFSolidCreateFromMesh */
+   std::atomic<size_t> m_uiTriangles{ 0 };
+   std::atomic<size_t> m_uiEntities{ 0 };
+   std::atomic<size_t> m_uiStyles{ 0 };
+   /* PTEntityGroups created */
+   std::atomic<size_t> m_uiGroups{ 0 };
+   /* Bytes of the decoded meshes, freed once Polygonica has copied them */
+   std::atomic<size_t> m_uiMeshBytes{ 0 };
+   /* Bytes held by the output containers of A3DPolygonicaOptions at the end of the conversion */
+   std::atomic<size_t> m_uiContainerBytes{ 0 };
+
+   A3DBridgeStats() {}
+   A3DBridgeStats(const A3DBridgeStats& other) { *this = other; }
+   A3DBridgeStats& operator=(const A3DBridgeStats& other)
+   {
+      for (int i = 0; i < A3D_PHASE_COUNT; i++)
+      {
+         m_auiWallNs[i] = other.m_auiWallNs[i].load();
+         m_auiCpuNs[i] = other.m_auiCpuNs[i].load();
+      }
+      m_uiNodes = other.m_uiNodes.load();
+      m_uiRepItems = other.m_uiRepItems.load();
+      m_uiSolids = other.m_uiSolids.load();
+      m_uiTriangles = other.m_uiTriangles.load();
+      m_uiEntities = other.m_uiEntities.load();
+      m_uiStyles = other.m_uiStyles.load();
+      m_uiGroups = other.m_uiGroups.load();
+      m_uiMeshBytes = other.m_uiMeshBytes.load();
+      m_uiContainerBytes = other.m_uiContainerBytes.load();
+      return *this;
+   }
+};
+/***A3DBridgeStats****************************************************/
+
+#ifdef A3D_BRIDGE_STATS
+/* Adds the wall and thread CPU time of its lifetime to a phase of A3DBridgeStats */
+struct A3DBridgePhaseTimer
+{
+   A3DBridgeStats* m_pStats;
+   A3DBridgePhase m_ePhase;
+   std::chrono::steady_clock::time_point m_tWall;
+   A3DUns64 m_uiCpuNs;
+
+   A3DBridgePhaseTimer(A3DBridgeStats* pStats, A3DBridgePhase ePhase) : m_pStats(pStats), m_ePhase(ePhase)
+   {
+      if (m_pStats)
+      {
+         m_tWall = std::chrono::steady_clock::now();
+         m_uiCpuNs = ThreadCpuNs();
+      }
+   }
+
+   ~A3DBridgePhaseTimer()
+   {
+      Stop();
+   }
+
+   /* Adds the time so far; later calls and the destructor add nothing */
+   void Stop()
+   {
+      if (m_pStats)
+      {
+         m_pStats->m_auiCpuNs[m_ePhase] += ThreadCpuNs() - m_uiCpuNs;
+         m_pStats->m_auiWallNs[m_ePhase] +=
+            (A3DUns64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_tWall).count();
+         m_pStats = NULL;
+      }
+   }
+
+   static A3DUns64 ThreadCpuNs()
+   {
+#ifdef _WIN32
+      FILETIME sCreation, sExit, sKernel, sUser;
+      GetThreadTimes(GetCurrentThread(), &sCreation, &sExit, &sKernel, &sUser);
+      // 100 ns units
+      return 100 * ((((A3DUns64)sKernel.dwHighDateTime << 32) | sKernel.dwLowDateTime) +
+                    (((A3DUns64)sUser.dwHighDateTime << 32) | sUser.dwLowDateTime));
+#else
+      struct timespec sTime;
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &sTime);
+      return (A3DUns64)sTime.tv_sec * 1000000000ULL + (A3DUns64)sTime.tv_nsec;
+#endif
+   }
+};
+/***A3DBridgePhaseTimer***********************************************/
+#endif
+
 struct A3DPolygonicaOptions
 {
    PTEnvironment m_Environment;
@@ -87,16 +756,115 @@ struct A3DPolygonicaOptions
 
    /* A mapping of A3DRiRepresentationItems to PTSolids*/
    std::unordered_map<const A3DRiRepresentationItem*, PTSolid> m_parts;
+   /* With m_bShareIdenticalMeshes or m_bShareCongruentMeshes, the items of m_parts that own their PTSolid */
+   A3DBridgeMeshTable m_mesh_table;
+   /* For the items of m_parts sharing the PTSolid of a congruent item: the rigid motion from the */
+   /* coordinates of the solid to those of the item, applied before the transforms of its world entities */
+   std::unordered_map<const A3DRiRepresentationItem*, std::array<double, 16>> m_part_transforms;
    /* A vector of PTWorldEntities */
    std::vector<PTWorldEntity> m_entities;
-   /* A map providing one PTRenderStyle for each colour */
-   std::map<unsigned long, PTRenderStyle> m_style_palette;
+   /* A palette providing one PTRenderStyle for each colour */
+   A3DBridgeStylePalette m_style_palette;
+   /* The most PTRenderStyles m_style_palette creates; further colours use the nearest style. 0 is unbounded */
+   unsigned m_uiMaxStyles = 0;
    /* A map providing a vector of groups of faces on each CAD surface for each PTSolid*/
+   /* A group is PV_ENTITY_NULL until A3DBridgeGetSurfaceGroup creates it if m_bLazySurfaceGroups is set */
    std::unordered_map<PTSolid, std::vector <PTEntityGroup>*> m_surface_groups;
-   /* A map providing a vector part path for each PTWorldEntity */
-   std::unordered_map<PTWorldEntity, std::vector<void*>*> m_paths;
+   /* The faces of each PTSolid by CAD surface, bucketed on the first A3DBridgeGetSurfaceGroup for the solid */
+   /* A bucket is emptied once its group is filled */
+   std::unordered_map<PTSolid, std::vector<std::vector<PTEntity>>> m_surface_faces;
+   /* The app surface id of the first CAD surface of each PTSolid */
+   std::unordered_map<PTSolid, long> m_topo_face_base;
+   /* The CAD surface of each app surface id, indexed by the id. Use A3DBridgeFindTopoFace for a PTFace */
+   std::vector<A3DBridgeTopoFace> m_topo_faces;
+   /* The assembly path id of each PTWorldEntity in m_entities, at the same index */
+   /* Use A3DBridgeGetPath to get the product occurrences and part definition of a path */
+   std::vector<A3DUns32> m_paths;
+   /* The assembly paths of the world entities */
+   A3DBridgePathTrie m_path_trie;
 
    long m_iTopoFaceCount = 0;
+
+   /* Number of threads building PTSolids. 0 or 1 builds each PTSolid as the traversal meets it */
+   /* More first collects the representation items, then decodes and builds them on a thread pool */
+   /* The results are identical; the logging function may then be called from any of the threads */
+   unsigned m_uiThreadCount = 0;
+   /* Number of representation items decoded before their PTSolids are built when m_uiThreadCount > 1 */
+   unsigned m_uiParallelBatchSize = 256;
+   /* When a batch has fewer items than threads, its items of at least this many triangles are decoded one at a time */
+   /* with their faces split across the threads, such as a single scanned part of millions of triangles */
+   size_t m_uiParallelDecodeMinTriangles = 65536;
+   /* Internal: set while A3DModelCreatePGWorld collects work for the thread pool */
+   A3DBridgeDeferredWork* m_pDeferredWork = nullptr;
+   /* Visit the subtree of each prototype once per inherited colour and replay it for its other instances */
+   /* World transforms may then differ from a full traversal in the last bits */
+   bool m_bCachePrototypes = false;
+   /* Leave the groups of m_surface_groups to be created on request by A3DBridgeGetSurfaceGroup */
+   bool m_bLazySurfaceGroups = false;
+   /* Compute the cascaded attributes and colour of a node once per distinct parent attributes */
+   bool m_bCacheAttributes = false;
+   /* Give representation items with identical tessellations one PTSolid; several keys of m_parts then hold it */
+   bool m_bShareIdenticalMeshes = false;
+   /* Also share the PTSolid of an item whose mesh is the same up to a rotation and translation, see m_part_transforms */
+   /* Vertex order must match; the world entities then have the rigid motion in their transforms */
+   bool m_bShareCongruentMeshes = false;
+   /* Weld the vertices of each decoded mesh closer than m_dWeldTolerance before PFSolidCreateFromMesh, see stWeldMesh */
+   /* Triangles left with a repeated vertex are dropped; the others keep their normals and CAD surfaces */
+   bool m_bWeldVertices = false;
+   double m_dWeldTolerance = 0.;
+   /* Output: vertices of the meshes before and after welding, and triangles dropped, in the last A3DModelCreatePGWorld */
+   size_t m_uiVerticesBeforeWelding = 0;
+   size_t m_uiVerticesAfterWelding = 0;
+   size_t m_uiWeldDegenerateTriangles = 0;
+   /* Sort the triangles of each mesh of at least m_uiReorderMinTriangles triangles along a Morton curve of their */
+   /* centroids before PFSolidCreateFromMesh, and number its vertices in the order of first use, see stReorderMesh */
+   /* Meshes whose triangles already fetch fewer than m_dReorderMinFetches vertices each through a FIFO cache of 32 */
+   /* vertices, such as most tessellations of CAD faces, keep their order */
+   bool m_bReorderTriangles = false;
+   size_t m_uiReorderMinTriangles = 16384;
+   double m_dReorderMinFetches = 1.5;
+   /* Output: triangles of the meshes reordered in the last A3DModelCreatePGWorld */
+   size_t m_uiReorderedTriangles = 0;
+   /* Output: attribute cache lookups and hits of the last A3DModelCreatePGWorld */
+   size_t m_uiAttributeCacheLookups = 0;
+   size_t m_uiAttributeCacheHits = 0;
+   /* Output: Exchange global colour and material calls the colour table avoided in the last A3DModelCreatePGWorld */
+   size_t m_uiColourCallsAvoided = 0;
+   /* Test mode: also compose every transform with the general MultiplyMatrix and compare the results */
+   bool m_bCheckTransforms = false;
+   /* Output: composed transforms that differed from MultiplyMatrix in the last A3DModelCreatePGWorld */
+   size_t m_uiTransformMismatches = 0;
+   /* Streaming: called as each world entity is added, so it can be shown before the conversion ends */
+   /* With m_uiThreadCount > 1 the entities are added after each batch of m_uiParallelBatchSize PTSolids is built */
+   A3D_entity_func m_pEntityCallback = nullptr;
+   void* m_pEntityCallbackData = nullptr;
+   /* Visit sibling product occurrences from the highest priority, e.g. A3DBridgeBoundingBoxPriority for the largest first */
+   A3D_priority_func m_pPriority = nullptr;
+   void* m_pPriorityData = nullptr;
+   /* Records a span per product occurrence, part, representation item and PTSolid built, see A3DBridgeTracerWrite */
+   /* The tracer may be shared by several conversions and must outlive them */
+   A3DBridgeTracer* m_pTracer = nullptr;
+   /* Output: seconds from the start of the last A3DModelCreatePGWorld to its first world entity, -1 if none, and to its end */
+   double m_dFirstEntitySeconds = -1.;
+   double m_dTotalSeconds = 0.;
+   /* Internal: when the last A3DModelCreatePGWorld started */
+   std::chrono::steady_clock::time_point m_tStart;
+   /* A directory keeping the decoded meshes of each model between conversions, none if empty */
+   /* The first conversion of a key writes a file of the meshes; later ones map it and read the meshes from it */
+   /* instead of Exchange. The traversal is unchanged, so the model must still be loaded. An entry is only read if the */
+   /* coordinates of its item match; else the item is decoded and the file written again by the next conversion */
+   std::string m_sMeshCacheDirectory;
+   /* The key of the model in m_sMeshCacheDirectory, e.g. from A3DBridgeMeshCacheKey. It must change with the */
+   /* content of the file and with the load parameters; without a key the cache is not used */
+   std::string m_sMeshCacheKey;
+   /* Internal: the file of the conversion in progress */
+   A3DBridgeMeshCache* m_pMeshCache = nullptr;
+   /* Output: representation items of the last A3DModelCreatePGWorld read from the mesh cache */
+   size_t m_uiMeshCacheHits = 0;
+#ifdef A3D_BRIDGE_STATS
+   /* Output: timings and counts of the last A3DModelCreatePGWorld */
+   A3DBridgeStats m_stats;
+#endif
 };
 /***A3DPolygonicaOptions**********************************************/
 
@@ -117,6 +885,155 @@ struct MiscCascadedAttributesGuard
 };
 /***MiscCascadedAttributesGuard***************************************/
 
+/*
+   Work-stealing thread pool
+   ParallelFor splits the tasks into one contiguous block per thread. Each thread takes tasks from
+   the back of its own block and, once that is empty, steals from the front of the others.
+   The calling thread works as thread 0.
+*/
+class A3DBridgeThreadPool
+{
+public:
+   explicit A3DBridgeThreadPool(unsigned uiThreadCount)
+   {
+      uiThreadCount = std::max(1u, uiThreadCount);
+      for (unsigned ui = 0; ui < uiThreadCount; ui++)
+      {
+         m_queues.emplace_back(new Queue);
+      }
+      for (unsigned ui = 1; ui < uiThreadCount; ui++)
+      {
+         m_threads.emplace_back(&A3DBridgeThreadPool::WorkerLoop, this, ui);
+      }
+   }
+
+   ~A3DBridgeThreadPool()
+   {
+      {
+         std::lock_guard<std::mutex> sLock(m_mutex);
+         m_bStop = true;
+      }
+      m_cvStart.notify_all();
+      for (std::thread& thread : m_threads)
+      {
+         thread.join();
+      }
+   }
+
+   unsigned GetThreadCount() const
+   {
+      return (unsigned)m_queues.size();
+   }
+
+   /* Calls fnTask(0) ... fnTask(uiCount - 1) on the pool and returns once all calls have returned */
+   void ParallelFor(size_t uiCount, const std::function<void(size_t)>& fnTask)
+   {
+      if (uiCount == 0)
+      {
+         return;
+      }
+
+      {
+         std::lock_guard<std::mutex> sLock(m_mutex);
+         m_fnTask = &fnTask;
+         m_uiPending = uiCount;
+         const size_t uiQueues = m_queues.size();
+         for (size_t uiQueue = 0; uiQueue < uiQueues; uiQueue++)
+         {
+            std::lock_guard<std::mutex> sQueueLock(m_queues[uiQueue]->m_mutex);
+            for (size_t uiTask = uiQueue * uiCount / uiQueues; uiTask < (uiQueue + 1) * uiCount / uiQueues; uiTask++)
+            {
+               m_queues[uiQueue]->m_tasks.push_back(uiTask);
+            }
+         }
+         m_uiGeneration++;
+      }
+      m_cvStart.notify_all();
+
+      RunTasks(0);
+
+      std::unique_lock<std::mutex> sLock(m_mutex);
+      m_cvDone.wait(sLock, [this] { return m_uiPending == 0; });
+      m_fnTask = nullptr;
+   }
+
+private:
+   struct Queue
+   {
+      std::mutex m_mutex;
+      std::deque<size_t> m_tasks;
+   };
+
+   bool PopTask(unsigned uiThread, size_t& uiTask)
+   {
+      {
+         Queue& sOwn = *m_queues[uiThread];
+         std::lock_guard<std::mutex> sLock(sOwn.m_mutex);
+         if (!sOwn.m_tasks.empty())
+         {
+            uiTask = sOwn.m_tasks.back();
+            sOwn.m_tasks.pop_back();
+            return true;
+         }
+      }
+      for (size_t ui = 1; ui < m_queues.size(); ui++)
+      {
+         Queue& sVictim = *m_queues[(uiThread + ui) % m_queues.size()];
+         std::lock_guard<std::mutex> sLock(sVictim.m_mutex);
+         if (!sVictim.m_tasks.empty())
+         {
+            uiTask = sVictim.m_tasks.front();
+            sVictim.m_tasks.pop_front();
+            return true;
+         }
+      }
+      return false;
+   }
+
+   void RunTasks(unsigned uiThread)
+   {
+      size_t uiTask;
+      while (PopTask(uiThread, uiTask))
+      {
+         (*m_fnTask)(uiTask);
+         if (--m_uiPending == 0)
+         {
+            std::lock_guard<std::mutex> sLock(m_mutex);
+            m_cvDone.notify_all();
+         }
+      }
+   }
+
+   void WorkerLoop(unsigned uiThread)
+   {
+      size_t uiSeenGeneration = 0;
+      for (;;)
+      {
+         {
+            std::unique_lock<std::mutex> sLock(m_mutex);
+            m_cvStart.wait(sLock, [&] { return m_bStop || m_uiGeneration != uiSeenGeneration; });
+            if (m_bStop)
+            {
+               return;
+            }
+            uiSeenGeneration = m_uiGeneration;
+         }
+         RunTasks(uiThread);
+      }
+   }
+
+   std::vector<std::unique_ptr<Queue>> m_queues;
+   std::vector<std::thread> m_threads;
+   std::mutex m_mutex;
+   std::condition_variable m_cvStart;
+   std::condition_variable m_cvDone;
+   const std::function<void(size_t)>* m_fnTask = nullptr;
+   std::atomic<size_t> m_uiPending{ 0 };
+   size_t m_uiGeneration = 0;
+   bool m_bStop = false;
+};
+/***A3DBridgeThreadPool***********************************************/
+
 /*********************************************************************/
 /***functions*********************************************************/
 /*********************************************************************/
@@ -180,7 +1097,8 @@ INTERNAL A3DStatus stGetName(const A3DRootBaseWithGraphics* pPartOrProduct,
 INTERNAL A3DStatus stExtractColorFromGraphicData(const A3DRootBaseWithGraphics* pRootBaseWithGraphics,
                                                  const A3DGraphStyleData& sGraphStyleData,
                                                  float& r, float& g, float& b,
-                                                 A3D_log_func logging_function)
+                                                 A3D_log_func logging_function,
+                                                 bool* pbHasRgb = nullptr)
 {
    // Gets the color inherited color information
    A3DUns32 uiRgbColorIndex;
@@ -217,6 +1135,10 @@ INTERNAL A3DStatus stExtractColorFromGraphicData(const A3DRootBaseWithGraphics*
       r = (float)sColorData.m_dRed;
       g = (float)sColorData.m_dGreen;
       b = (float)sColorData.m_dBlue;
+      if (pbHasRgb)
+      {
+         *pbHasRgb = true;
+      }
    }
 
    A3DGlobalGetGraphRgbColorData(A3D_DEFAULT_COLOR_INDEX, &sColorData);
@@ -225,242 +1147,424 @@ INTERNAL A3DStatus stExtractColorFromGraphicData(const A3DRootBaseWithGraphics*
 }
 /***stExtractColorFromGraphicData*************************************/
 
-INTERNAL A3DStatus stCreateAndPushCascadedAttributes(const A3DRootBaseWithGraphics* pBase,
-                                                     const A3DMiscCascadedAttributes* pFatherAttr,
-                                                     A3DMiscCascadedAttributes** ppAttr,
-                                                     A3DMiscCascadedAttributesData* psAttrData,
-                                                     A3D_log_func logging_function)
+/*!
+\brief Reads the colour of an RGB colour index from Exchange into an entry, as stExtractColorFromGraphicData does
+*/
+INTERNAL void stColourTableResolveRgb(A3DBridgeColourTable& sTable,
+                                      A3DUns32 uiRgbColorIndex,
+                                      A3DBridgeColourEntry& sEntry)
 {
-   // Creates an A3DMiscCascadedAttributes structure and computes the attributes
-   // based on the input A3DRootBaseWithGraphics structure pBase.
-   CHECK_A3DSTATUS(A3DMiscCascadedAttributesCreate(ppAttr), logging_function, 
-                   "stCreateAndPushCascadedAttributes - A3DMiscCascadedAttributesCreate");
-   CHECK_A3DSTATUS(A3DMiscCascadedAttributesPush(*ppAttr, pBase, pFatherAttr), logging_function, 
-                   "stCreateAndPushCascadedAttributes - A3DMiscCascadedAttributesPush");
-
-   A3D_INITIALIZE_DATA(A3DMiscCascadedAttributesData, (*psAttrData));
-   CHECK_A3DSTATUS(A3DMiscCascadedAttributesGet(*ppAttr, psAttrData), logging_function, 
-                   "stCreateAndPushCascadedAttributes - A3DMiscCascadedAttributesGet");
-   return A3D_SUCCESS;
+   A3DGraphRgbColorData sColorData;
+   A3D_INITIALIZE_DATA(A3DGraphRgbColorData, sColorData);
+   if (A3DGlobalGetGraphRgbColorData(uiRgbColorIndex, &sColorData) == A3D_SUCCESS)
+   {
+      sEntry.m_bHasRgb = true;
+      sEntry.m_afRgb[0] = (float)sColorData.m_dRed;
+      sEntry.m_afRgb[1] = (float)sColorData.m_dGreen;
+      sEntry.m_afRgb[2] = (float)sColorData.m_dBlue;
+   }
+   A3DGlobalGetGraphRgbColorData(A3D_DEFAULT_COLOR_INDEX, &sColorData);
+   sTable.m_uiCallsMade += 2;
 }
-/***stCreateAndPushCascadedAttributes*********************************/
+/***stColourTableResolveRgb*******************************************/
 
-INTERNAL A3DStatus IndicesPerFaceAsTriangles(A3DTess3DData sTessData,
-                                             const unsigned& uFaceIndice,
-                                             std::vector<unsigned>& auIndices,
-                                             std::vector<PTInt32>& normal_indices,
-                                             A3D_log_func logging_function)
+/*!
+\brief Returns the entry of an RGB colour index, resolving it on first use
+*/
+INTERNAL const A3DBridgeColourEntry& stColourTableRgb(A3DBridgeColourTable& sTable,
+                                                      A3DUns32 uiRgbColorIndex)
 {
-   A3DTessFaceData* pFaceTessData = &(sTessData.m_psFaceTessData[uFaceIndice]);
-
-   if (!pFaceTessData->m_uiSizesTriangulatedSize)
+   if (uiRgbColorIndex >= sTable.m_colours.size())
    {
-      return A3D_SUCCESS;
+      sTable.m_colours.resize(uiRgbColorIndex + 1);
    }
 
-   A3DUns32* puiTriangulatedIndexes = sTessData.m_puiTriangulatedIndexes
-                                      + pFaceTessData->m_uiStartTriangulated;
+   A3DBridgeColourEntry& sEntry = sTable.m_colours[uiRgbColorIndex];
+   if (!sEntry.m_bResolved)
+   {
+      stColourTableResolveRgb(sTable, uiRgbColorIndex, sEntry);
+      sEntry.m_bResolved = true;
+   }
+   return sEntry;
+}
+/***stColourTableRgb**************************************************/
 
-   unsigned uiCurrentSize = 0;
-   A3DUns16  unprocessed_flags = pFaceTessData->m_usUsedEntitiesFlags;
+/*!
+\brief Returns the entry of a material index with its diffuse colour, resolving it on first use
+*/
+INTERNAL const A3DBridgeColourEntry& stColourTableMaterial(A3DBridgeColourTable& sTable,
+                                                           A3DUns32 uiMaterialIndex,
+                                                           A3D_log_func logging_function)
+{
+   if (uiMaterialIndex >= sTable.m_materials.size())
+   {
+      sTable.m_materials.resize(uiMaterialIndex + 1);
+   }
 
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangle)
+   if (!sTable.m_materials[uiMaterialIndex].m_bResolved)
    {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangle;
-      A3DUns32 uNbTriangles = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
+      A3DBridgeColourEntry sEntry;
+      A3DBool isTexture = false;
+      CHECK_A3DSTATUS(A3DGlobalIsMaterialTexture(uiMaterialIndex, &isTexture),
+                      logging_function, "stColourTableMaterial");
+      sTable.m_uiCallsMade++;
+      sEntry.m_bIsTexture = isTexture ? true : false;
 
-      for (A3DUns32 uI = 0; uI < uNbTriangles; uI++)
+      if (!sEntry.m_bIsTexture)
       {
-         for (int i = 0; i < 3; i++)
+         A3DGraphMaterialData gmd;
+         A3D_INITIALIZE_DATA(A3DGraphMaterialData, gmd);
+         A3DGlobalGetGraphMaterialData(uiMaterialIndex, &gmd);
+         sTable.m_uiCallsMade++;
+
+         // Resizes m_colours but not m_materials
+         if (gmd.m_uiDiffuse < A3D_BRIDGE_COLOUR_TABLE_MAX)
          {
-            COPY_(normal_indices, puiTriangulatedIndexes, 1);
-            puiTriangulatedIndexes += 1; // Move past the normal
-            COPY_(auIndices, puiTriangulatedIndexes, 1);
-            puiTriangulatedIndexes += 1;
+            const A3DBridgeColourEntry& sDiffuse = stColourTableRgb(sTable, gmd.m_uiDiffuse);
+            sEntry.m_bHasRgb = sDiffuse.m_bHasRgb;
+            memcpy(sEntry.m_afRgb, sDiffuse.m_afRgb, sizeof(sEntry.m_afRgb));
+         }
+         else
+         {
+            // Beyond the table the diffuse colour is read for the material alone
+            stColourTableResolveRgb(sTable, gmd.m_uiDiffuse, sEntry);
          }
       }
+      sEntry.m_bResolved = true;
+      sTable.m_materials[uiMaterialIndex] = sEntry;
    }
+   return sTable.m_materials[uiMaterialIndex];
+}
+/***stColourTableMaterial*********************************************/
 
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleFan)
+/*!
+\brief Gets the colour of a style as stExtractColorFromGraphicData does, with array reads once the indices are resolved
+r, g and b are left unchanged if Exchange has no colour for the style.
+\param pbHasRgb [out] If not NULL, set to true if r, g and b were set
+*/
+INTERNAL A3DStatus stColourTableLookup(A3DBridgeColourTable& sTable,
+                                       const A3DRootBaseWithGraphics* pRootBaseWithGraphics,
+                                       const A3DGraphStyleData& sGraphStyleData,
+                                       float& r, float& g, float& b,
+                                       A3D_log_func logging_function,
+                                       bool* pbHasRgb = nullptr)
+{
+   const A3DUns32 uiIndex = sGraphStyleData.m_uiRgbColorIndex;
+   if (uiIndex >= A3D_BRIDGE_COLOUR_TABLE_MAX)
    {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangleFan;
-      A3DUns32 uiNbFan = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
-
-      for (A3DUns32 uiFan = 0; uiFan < uiNbFan; uiFan++)
-      {
-         A3DUns32 uiNbPoint = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
+      return stExtractColorFromGraphicData(pRootBaseWithGraphics, sGraphStyleData, r, g, b, logging_function, pbHasRgb);
+   }
 
-         A3DUns32* pFanPointNormalIndice = puiTriangulatedIndexes;
-         puiTriangulatedIndexes += 1;
+   const size_t uiCallsMade = sTable.m_uiCallsMade;
 
-         A3DUns32* pFanPointIndice = puiTriangulatedIndexes;
-         puiTriangulatedIndexes += 2;
-         A3DUns32 uIPoint;
-         for (uIPoint = 1; uIPoint < uiNbPoint - 1; uIPoint++)
-         {
-            COPY_(normal_indices, pFanPointNormalIndice, 1);
-            COPY_(auIndices, pFanPointIndice, 1);
-            COPY_(normal_indices, puiTriangulatedIndexes - 1, 1);
-            COPY_(auIndices, puiTriangulatedIndexes, 1);
-            COPY_(normal_indices, puiTriangulatedIndexes + 1, 1);
-            COPY_(auIndices, puiTriangulatedIndexes + 2, 1);
-            puiTriangulatedIndexes += 2;
-         }
-         puiTriangulatedIndexes += 1;
+   const A3DBridgeColourEntry* pEntry;
+   if (sGraphStyleData.m_bMaterial == TRUE)
+   {
+      pEntry = &stColourTableMaterial(sTable, uiIndex, logging_function);
+      if (pEntry->m_bIsTexture)
+      {
+         log(logging_function, "stExtractColorFromGraphicData can't handle textured materials", A3D_LOG_ERROR);
       }
    }
-
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleStripe)
+   else
    {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangleStripe;
-      A3DUns32 uiNbStripe = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
+      pEntry = &stColourTableRgb(sTable, uiIndex);
+   }
 
-      A3DUns32 uiStripe;
-      for (uiStripe = 0; uiStripe < uiNbStripe; uiStripe++)
+   if (pEntry->m_bHasRgb)
+   {
+      r = pEntry->m_afRgb[0];
+      g = pEntry->m_afRgb[1];
+      b = pEntry->m_afRgb[2];
+      if (pbHasRgb)
       {
-         A3DUns32 uiNbPoint = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
-         puiTriangulatedIndexes += 3;
-         A3DUns32 uIPoint;
-         for (uIPoint = 0; uIPoint < uiNbPoint - 2; uIPoint++)
-         {
-            COPY_(normal_indices, puiTriangulatedIndexes - 1, 1);
-            COPY_(auIndices, puiTriangulatedIndexes, 1);
-            if (uIPoint % 2)
-            {
-               COPY_(normal_indices, puiTriangulatedIndexes - 3, 1);
-               COPY_(auIndices, puiTriangulatedIndexes - 2, 1);
-               COPY_(normal_indices, puiTriangulatedIndexes + 1, 1);
-               COPY_(auIndices, puiTriangulatedIndexes + 2, 1);
-            }
-            else
-            {
-               COPY_(normal_indices, puiTriangulatedIndexes + 1, 1);
-               COPY_(auIndices, puiTriangulatedIndexes + 2, 1);
-               COPY_(normal_indices, puiTriangulatedIndexes - 3, 1);
-               COPY_(auIndices, puiTriangulatedIndexes - 2, 1);
-            }
-            puiTriangulatedIndexes += 2;
-         }
-         puiTriangulatedIndexes += 1;
+         *pbHasRgb = true;
       }
    }
 
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleOneNormal)
+   // The calls stExtractColorFromGraphicData makes: the texture check and material, then the colour and its release
+   const size_t uiCallsUncached = (sGraphStyleData.m_bMaterial != TRUE) ? 2 : (pEntry->m_bIsTexture ? 3 : 4);
+   const size_t uiCalls = sTable.m_uiCallsMade - uiCallsMade;
+   sTable.m_uiCallsAvoided += (uiCallsUncached > uiCalls) ? uiCallsUncached - uiCalls : 0;
+   return A3D_SUCCESS;
+}
+/***stColourTableLookup***********************************************/
+
+INTERNAL A3DStatus stCreateAndPushCascadedAttributes(const A3DRootBaseWithGraphics* pBase,
+                                                     const A3DMiscCascadedAttributes* pFatherAttr,
+                                                     A3DMiscCascadedAttributes** ppAttr,
+                                                     A3DMiscCascadedAttributesData* psAttrData,
+                                                     A3D_log_func logging_function)
+{
+   // Creates an A3DMiscCascadedAttributes structure and computes the attributes
+   // based on the input A3DRootBaseWithGraphics structure pBase.
+   CHECK_A3DSTATUS(A3DMiscCascadedAttributesCreate(ppAttr), logging_function, 
+                   "stCreateAndPushCascadedAttributes - A3DMiscCascadedAttributesCreate");
+   CHECK_A3DSTATUS(A3DMiscCascadedAttributesPush(*ppAttr, pBase, pFatherAttr), logging_function, 
+                   "stCreateAndPushCascadedAttributes - A3DMiscCascadedAttributesPush");
+
+   A3D_INITIALIZE_DATA(A3DMiscCascadedAttributesData, (*psAttrData));
+   CHECK_A3DSTATUS(A3DMiscCascadedAttributesGet(*ppAttr, psAttrData), logging_function, 
+                   "stCreateAndPushCascadedAttributes - A3DMiscCascadedAttributesGet");
+   return A3D_SUCCESS;
+}
+/***stCreateAndPushCascadedAttributes*********************************/
+
+/*!
+\brief Returns the number of triangles IndicesPerFaceAsTriangles writes for a face
+\param pFaceTessData The face tessellation data
+\return The triangle count, read from m_puiSizesTriangulated only
+*/
+INTERNAL A3DUns32 TrianglesPerFace(const A3DTessFaceData* pFaceTessData)
+{
+   if (!pFaceTessData->m_uiSizesTriangulatedSize)
    {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangleOneNormal;
-      A3DUns32 uNbTriangles = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
+      return 0;
+   }
 
-      for (A3DUns32 uI = 0; uI < uNbTriangles; uI++)
+   const A3DUns32* puiSizes = pFaceTessData->m_puiSizesTriangulated;
+   const A3DUns16 usFlags = pFaceTessData->m_usUsedEntitiesFlags;
+   A3DUns32 uiCurrentSize = 0, uiNbTriangles = 0;
+
+   // Fans and stripes of n points hold n - 2 triangles
+   auto countStrips = [&](A3DUns32 uiMask)
+   {
+      A3DUns32 uiNbStrips = puiSizes[uiCurrentSize++];
+      for (A3DUns32 uiStrip = 0; uiStrip < uiNbStrips; uiStrip++)
       {
-         COPY_(normal_indices, puiTriangulatedIndexes, 1);
-         COPY_(normal_indices, puiTriangulatedIndexes, 1);
-         COPY_(normal_indices, puiTriangulatedIndexes, 1);
-         puiTriangulatedIndexes += 1; // move past the normal
-         COPY_(auIndices, puiTriangulatedIndexes, 3);
-         puiTriangulatedIndexes += 3;
+         A3DUns32 uiNbPoint = puiSizes[uiCurrentSize++] & uiMask;
+         uiNbTriangles += (uiNbPoint > 2) ? uiNbPoint - 2 : 0;
       }
-   }
+   };
 
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleFanOneNormal)
+   if (usFlags & kA3DTessFaceDataTriangle)
+   {
+      uiNbTriangles += puiSizes[uiCurrentSize++];
+   }
+   if (usFlags & kA3DTessFaceDataTriangleFan)
+   {
+      countStrips(0xFFFFFFFF);
+   }
+   if (usFlags & kA3DTessFaceDataTriangleStripe)
+   {
+      countStrips(0xFFFFFFFF);
+   }
+   if (usFlags & kA3DTessFaceDataTriangleOneNormal)
+   {
+      uiNbTriangles += puiSizes[uiCurrentSize++];
+   }
+   if (usFlags & kA3DTessFaceDataTriangleFanOneNormal)
+   {
+      countStrips(kA3DTessFaceDataNormalMask);
+   }
+   if (usFlags & kA3DTessFaceDataTriangleStripeOneNormal)
+   {
+      countStrips(kA3DTessFaceDataNormalMask);
+   }
+   if (usFlags & kA3DTessFaceDataTriangleTextured)
+   {
+      uiNbTriangles += puiSizes[uiCurrentSize++];
+   }
+   if (usFlags & kA3DTessFaceDataTriangleFanTextured)
+   {
+      countStrips(0xFFFFFFFF);
+   }
+   if (usFlags & kA3DTessFaceDataTriangleStripeTextured)
    {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangleFanOneNormal;
-      A3DUns32 uiNbFan = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
+      countStrips(0xFFFFFFFF);
+   }
 
-      for (A3DUns32 uiFan = 0; uiFan < uiNbFan; uiFan++)
-      {
-         A3DUns32 uiNbPoint = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++] & kA3DTessFaceDataNormalMask;
+   return uiNbTriangles;
+}
+/***TrianglesPerFace**************************************************/
 
-         puiTriangulatedIndexes += 1;
-         A3DUns32* pFanPointIndice = puiTriangulatedIndexes;
-         puiTriangulatedIndexes += 1;
-         for (A3DUns32 uIPoint = 1; uIPoint < uiNbPoint - 1; uIPoint++)
+/* The kinds of triangle entities of a face tessellation */
+enum A3DBridgeEntityKind
+{
+   A3D_ENTITY_TRIANGLES,
+   A3D_ENTITY_FANS,
+   A3D_ENTITY_STRIPS
+};
+/***A3DBridgeEntityKind***********************************************/
+
+/*!
+\brief Decodes the entities of one kind of a face, specialised on their layout
+A point is a normal, the texture coordinates and a vertex, or only a vertex after the one normal of its entity.
+\tparam eKind The kind of the entities
+\tparam bOneNormal True if each entity has one normal, stored before its points
+\tparam iTextureCoords The texture coordinates of a point, or -1 to read them from uiTextureCoords
+\param puiSizes [in,out] The sizes of the entities, advanced past them
+\param puiTriangulatedIndexes [in,out] The indexes of the entities, advanced past them
+\param puiIndices [in,out] Receives 3 vertex indices per triangle, advanced past them
+\param piNormalIndices [in,out] Receives 3 normal indices per triangle, advanced past them
+*/
+template <A3DBridgeEntityKind eKind, bool bOneNormal, int iTextureCoords>
+INTERNAL void stDecodeFaceEntities(const A3DUns32*& puiSizes,
+                                   const A3DUns32*& puiTriangulatedIndexes,
+                                   A3DUns32 uiTextureCoords,
+                                   unsigned*& puiIndices,
+                                   PTInt32*& piNormalIndices)
+{
+   const A3DUns32 uiStride = bOneNormal ? 1 : 2 + (iTextureCoords >= 0 ? (A3DUns32)iTextureCoords : uiTextureCoords);
+   const A3DUns32 uiVertex = uiStride - 1;
+   const A3DUns32* puiIndexes = puiTriangulatedIndexes;
+   unsigned* puiOut = puiIndices;
+   PTInt32* piOut = piNormalIndices;
+
+   // Writes the corners of a triangle from its points, all read before any is written as the arrays may alias
+   A3DUns32 uiNormal = 0;
+   auto triangle = [&](const A3DUns32* puiA, const A3DUns32* puiB, const A3DUns32* puiC)
+   {
+      const A3DUns32 uiNormalA = bOneNormal ? uiNormal : puiA[0];
+      const A3DUns32 uiNormalB = bOneNormal ? uiNormal : puiB[0];
+      const A3DUns32 uiNormalC = bOneNormal ? uiNormal : puiC[0];
+      const A3DUns32 uiVertexA = puiA[uiVertex], uiVertexB = puiB[uiVertex], uiVertexC = puiC[uiVertex];
+      piOut[0] = (PTInt32)(uiNormalA / 3);
+      piOut[1] = (PTInt32)(uiNormalB / 3);
+      piOut[2] = (PTInt32)(uiNormalC / 3);
+      puiOut[0] = uiVertexA / 3;
+      puiOut[1] = uiVertexB / 3;
+      puiOut[2] = uiVertexC / 3;
+      piOut += 3;
+      puiOut += 3;
+   };
+
+   const A3DUns32 uiEntities = *puiSizes++;
+   if (eKind == A3D_ENTITY_TRIANGLES)
+   {
+      for (A3DUns32 uI = 0; uI < uiEntities; uI++)
+      {
+         if (bOneNormal)
          {
-            COPY_(normal_indices, pFanPointIndice - 1, 1);
-            COPY_(auIndices, pFanPointIndice, 1);
-            COPY_(normal_indices, pFanPointIndice - 1, 1);
-            COPY_(auIndices, puiTriangulatedIndexes, 1);
-            COPY_(normal_indices, pFanPointIndice - 1, 1);
-            COPY_(auIndices, puiTriangulatedIndexes + 1, 1);
-            puiTriangulatedIndexes += 1;
+            uiNormal = *puiIndexes++;
          }
-         puiTriangulatedIndexes += 1;
+         triangle(puiIndexes, puiIndexes + uiStride, puiIndexes + 2 * uiStride);
+         puiIndexes += 3 * uiStride;
       }
    }
-
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleStripeOneNormal)
+   else
    {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangleStripeOneNormal;
-      A3DUns32 uiNbStripe = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
-
-      A3DUns32 uiStripe;
-      for (uiStripe = 0; uiStripe < uiNbStripe; uiStripe++)
+      for (A3DUns32 uiEntity = 0; uiEntity < uiEntities; uiEntity++)
       {
-         bool has_vertex_normals = 0 == (pFaceTessData->m_puiSizesTriangulated[uiCurrentSize] & kA3DTessFaceDataNormalSingle);
-
-         A3DUns32 uiNbPoint = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++] & kA3DTessFaceDataNormalMask;
-         puiTriangulatedIndexes += 2;
-         A3DUns32 uIPoint, * uiNormal;
-         uiNormal = puiTriangulatedIndexes - 2;
-         for (uIPoint = 0; uIPoint < uiNbPoint - 2; uIPoint++)
+         A3DUns32 uiNbPoint = *puiSizes++ & (bOneNormal ? (A3DUns32)kA3DTessFaceDataNormalMask : 0xFFFFFFFF);
+         if (bOneNormal)
+         {
+            uiNormal = *puiIndexes++;
+         }
+         if (eKind == A3D_ENTITY_FANS)
+         {
+            // Every triangle of a fan shares its first point
+            for (A3DUns32 uIPoint = 2; uIPoint < uiNbPoint; uIPoint++)
+            {
+               triangle(puiIndexes, puiIndexes + (uIPoint - 1) * uiStride, puiIndexes + uIPoint * uiStride);
+            }
+         }
+         else
          {
-            COPY_(normal_indices, uiNormal, 1);
-            COPY_(auIndices, puiTriangulatedIndexes, 1);
-            if (uIPoint % 2)
+            // Triangle k uses points k, k+1 and k+2; odd triangles are flipped to keep the winding, so triangles
+            // are decoded in pairs
+            A3DUns32 uIPoint = 2;
+            for (; uIPoint + 1 < uiNbPoint; uIPoint += 2)
             {
-               COPY_(normal_indices, uiNormal, 1);
-               COPY_(auIndices, puiTriangulatedIndexes - 1, 1);
-               COPY_(normal_indices, uiNormal, 1);
-               COPY_(auIndices, puiTriangulatedIndexes + 1, 1);
+               const A3DUns32* puiPoint = puiIndexes + (uIPoint - 2) * uiStride;
+               triangle(puiPoint + uiStride, puiPoint + 2 * uiStride, puiPoint);
+               triangle(puiPoint + 2 * uiStride, puiPoint + uiStride, puiPoint + 3 * uiStride);
             }
-            else
+            if (uIPoint < uiNbPoint)
             {
-               COPY_(normal_indices, uiNormal, 1);
-               COPY_(auIndices, puiTriangulatedIndexes + 1, 1);
-               COPY_(normal_indices, uiNormal, 1);
-               COPY_(auIndices, puiTriangulatedIndexes - 1, 1);
+               const A3DUns32* puiPoint = puiIndexes + (uIPoint - 2) * uiStride;
+               triangle(puiPoint + uiStride, puiPoint + 2 * uiStride, puiPoint);
             }
-            puiTriangulatedIndexes += 1;
          }
-         puiTriangulatedIndexes += 1;
+         // An entity of fewer than 3 points still takes 2
+         puiIndexes += (uiNbPoint > 2 ? uiNbPoint : 2) * uiStride;
       }
    }
 
+   puiTriangulatedIndexes = puiIndexes;
+   puiIndices = puiOut;
+   piNormalIndices = piOut;
+}
+/***stDecodeFaceEntities**********************************************/
 
-   // Textured
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleTextured)
-   {
-      unprocessed_flags &= ~kA3DTessFaceDataTriangleTextured;
-
-      A3DUns32 uNbTriangles = pFaceTessData->m_puiSizesTriangulated[uiCurrentSize++];
+typedef void (*A3DBridgeFaceDecoder)(const A3DUns32*&, const A3DUns32*&, A3DUns32, unsigned*&, PTInt32*&);
 
-      for (A3DUns32 uI = 0; uI < uNbTriangles; uI++)
-      {
-         for (int i = 0; i < 3; i++)
-         {
-            COPY_(normal_indices, puiTriangulatedIndexes, 1);
-            puiTriangulatedIndexes += 1; // Move past the normal
+/* A kind of entity IndicesPerFaceAsTriangles decodes and its decoders */
+struct A3DBridgeFaceDecoderEntry
+{
+   A3DUns16 m_usFlag;
+   /* By the texture coordinates of a point: 0, 1, 2, and any other number read at run time */
+   A3DBridgeFaceDecoder m_apfnDecoders[4];
+};
+/***A3DBridgeFaceDecoderEntry*****************************************/
 
-            puiTriangulatedIndexes += pFaceTessData->m_uiTextureCoordIndexesSize;
+/* The decoders of every layout, each without texture coordinates */
+#define A3D_BRIDGE_FACE_DECODERS(eKind, bOneNormal) \
+   { stDecodeFaceEntities<eKind, bOneNormal, 0>, stDecodeFaceEntities<eKind, bOneNormal, 0>, \
+     stDecodeFaceEntities<eKind, bOneNormal, 0>, stDecodeFaceEntities<eKind, bOneNormal, 0> }
+#define A3D_BRIDGE_TEXTURED_FACE_DECODERS(eKind) \
+   { stDecodeFaceEntities<eKind, false, 0>, stDecodeFaceEntities<eKind, false, 1>, \
+     stDecodeFaceEntities<eKind, false, 2>, stDecodeFaceEntities<eKind, false, -1> }
 
-            COPY_(auIndices, puiTriangulatedIndexes, 1);
-            puiTriangulatedIndexes += 1;
-         }
-      }
-   }
+/*!
+\brief Decodes the triangles of one face into pre-sized index arrays
+The vertex and normal indices written are point indices, i.e. the Exchange offsets into the
+coordinate and normal arrays already divided by 3.
+\param sTessData The tessellation data
+\param uFaceIndice The face to decode
+\param puiIndices [out] Receives 3 vertex indices per triangle. Must hold TrianglesPerFace entries * 3
+\param piNormalIndices [out] Receives 3 normal indices per triangle. Must hold TrianglesPerFace entries * 3
+\param uiNbTriangles [out] The number of triangles written
+\return A3D_SUCCESS - Operation succeeded
+  A3D_ERROR - The face holds data this function cannot parse. The triangles decoded before it are still written
+*/
+INTERNAL A3DStatus IndicesPerFaceAsTriangles(const A3DTess3DData& sTessData,
+                                             const unsigned& uFaceIndice,
+                                             unsigned* puiIndices,
+                                             PTInt32* piNormalIndices,
+                                             A3DUns32& uiNbTriangles,
+                                             A3D_log_func logging_function)
+{
+   const A3DTessFaceData* pFaceTessData = &(sTessData.m_psFaceTessData[uFaceIndice]);
+   unsigned* const puiIndicesStart = puiIndices;
+   uiNbTriangles = 0;
 
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleFanTextured)
+   if (!pFaceTessData->m_uiSizesTriangulatedSize)
    {
-      log(logging_function, 
-          "IndicesPerFaceAsTriangles cannot parse textured triangle data kA3DTessFaceDataTriangleFanTextured", A3D_LOG_ERROR);
-      return A3D_ERROR;
+      return A3D_SUCCESS;
    }
 
-   if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleStripeTextured)
+   const A3DUns32* puiTriangulatedIndexes = sTessData.m_puiTriangulatedIndexes
+                                            + pFaceTessData->m_uiStartTriangulated;
+   const A3DUns32* puiSizes = pFaceTessData->m_puiSizesTriangulated;
+   const A3DUns32 uiTextureCoords = pFaceTessData->m_uiTextureCoordIndexesSize;
+   A3DUns16  unprocessed_flags = pFaceTessData->m_usUsedEntitiesFlags;
+
+   // The entities of a face are stored in this order, each kind once
+   static const A3DBridgeFaceDecoderEntry s_asFaceDecoders[] =
    {
-      log(logging_function, "IndicesPerFaceAsTriangles cannot parse textured triangle data kA3DTessFaceDataTriangleStripeTextured", A3D_LOG_ERROR);
-      return A3D_ERROR;
+      { kA3DTessFaceDataTriangle, A3D_BRIDGE_FACE_DECODERS(A3D_ENTITY_TRIANGLES, false) },
+      { kA3DTessFaceDataTriangleFan, A3D_BRIDGE_FACE_DECODERS(A3D_ENTITY_FANS, false) },
+      { kA3DTessFaceDataTriangleStripe, A3D_BRIDGE_FACE_DECODERS(A3D_ENTITY_STRIPS, false) },
+      { kA3DTessFaceDataTriangleOneNormal, A3D_BRIDGE_FACE_DECODERS(A3D_ENTITY_TRIANGLES, true) },
+      { kA3DTessFaceDataTriangleFanOneNormal, A3D_BRIDGE_FACE_DECODERS(A3D_ENTITY_FANS, true) },
+      { kA3DTessFaceDataTriangleStripeOneNormal, A3D_BRIDGE_FACE_DECODERS(A3D_ENTITY_STRIPS, true) },
+      { kA3DTessFaceDataTriangleTextured, A3D_BRIDGE_TEXTURED_FACE_DECODERS(A3D_ENTITY_TRIANGLES) },
+      { kA3DTessFaceDataTriangleFanTextured, A3D_BRIDGE_TEXTURED_FACE_DECODERS(A3D_ENTITY_FANS) },
+      { kA3DTessFaceDataTriangleStripeTextured, A3D_BRIDGE_TEXTURED_FACE_DECODERS(A3D_ENTITY_STRIPS) },
+   };
+   for (const A3DBridgeFaceDecoderEntry& sEntry : s_asFaceDecoders)
+   {
+      if (pFaceTessData->m_usUsedEntitiesFlags & sEntry.m_usFlag)
+      {
+         unprocessed_flags &= ~sEntry.m_usFlag;
+         sEntry.m_apfnDecoders[std::min<A3DUns32>(uiTextureCoords, 3)](puiSizes, puiTriangulatedIndexes, uiTextureCoords,
+                                                                      puiIndices, piNormalIndices);
+      }
    }
 
+   uiNbTriangles = (A3DUns32)((puiIndices - puiIndicesStart) / 3);
+
    if (pFaceTessData->m_usUsedEntitiesFlags & kA3DTessFaceDataTriangleOneNormalTextured)
    {
       log(logging_function, 
@@ -504,6 +1608,46 @@ INTERNAL A3DStatus IndicesPerFaceAsTriangles(A3DTess3DData sTessData,
 }
 /***IndicesPerFaceAsTriangles*****************************************/
 
+/*!
+\brief Decodes the triangles of a range of faces, each into its own slice of pre-sized arrays
+The slice of a face starts at its offset in puiFaceStarts, the sum of the TrianglesPerFace of the faces before it,
+so ranges of faces can be decoded in parallel. A face that fails to decode leaves the end of its slice unwritten.
+\param sTessData The tessellation data
+\param uFirstFace The first face to decode
+\param uEndFace The face after the last one to decode
+\param puiFaceStarts The first triangle of the slice of each face
+\param puiIndices [out] Receives 3 vertex indices per triangle of the slices
+\param piNormalIndices [out] Receives 3 normal indices per triangle of the slices
+\param puiTriangleFaces [out] Receives the face of each triangle of the slices
+\param puiFaceTriangles [out] Receives the number of triangles written for each face
+\return A3D_SUCCESS - Operation succeeded
+  A3D_ERROR - A face holds data IndicesPerFaceAsTriangles cannot parse
+*/
+INTERNAL A3DStatus IndicesPerFaceRangeAsTriangles(const A3DTess3DData& sTessData,
+                                                  unsigned uFirstFace,
+                                                  unsigned uEndFace,
+                                                  const size_t* puiFaceStarts,
+                                                  unsigned* puiIndices,
+                                                  PTInt32* piNormalIndices,
+                                                  unsigned* puiTriangleFaces,
+                                                  A3DUns32* puiFaceTriangles,
+                                                  A3D_log_func logging_function)
+{
+   A3DStatus iRet = A3D_SUCCESS;
+   for (unsigned uTopoFace = uFirstFace; uTopoFace < uEndFace; uTopoFace++)
+   {
+      const size_t uiStart = puiFaceStarts[uTopoFace];
+      if (IndicesPerFaceAsTriangles(sTessData, uTopoFace, puiIndices + 3 * uiStart, piNormalIndices + 3 * uiStart,
+                                    puiFaceTriangles[uTopoFace], logging_function) != A3D_SUCCESS)
+      {
+         iRet = A3D_ERROR;
+      }
+      std::fill_n(puiTriangleFaces + uiStart, puiFaceTriangles[uTopoFace], uTopoFace);
+   }
+   return iRet;
+}
+/***IndicesPerFaceRangeAsTriangles************************************/
+
 INTERNAL PTBoolean face_in_category_cb(PTCategory cat, PTFace face)
 {
    // Category selection callback to include 
@@ -516,314 +1660,2821 @@ INTERNAL PTBoolean face_in_category_cb(PTCategory cat, PTFace face)
 /***face_in_category_cb***********************************************/
 
 /*!
-\brief Creates a PTSolid and optional mapper from the provided representation item.
-\param ri The representation item to create a PTSolid from. Must be an A3DRiPolyBrep or A3DRiBrepModel
-\param solid [out] solid The resultant polgonica solid
-\param opts [in] Options
-\return A3D_SUCCESS - Operation succeeded
-  A3D_PG_NOT_INITIALIZED - Polygonica was not unlocked or initialized correctly
-  A3D_PG_INVALID_RI - Representation item is unsupported type
-  A3D_PG_ERROR - Internal polygonica error
+\brief Returns the vertex coordinates of a decoded mesh, three doubles per vertex, borrowed or its own
 */
-INTERNAL int A3DRiRepresentationItemCreatePTSolid(const A3DRiRepresentationItem* ri,
-                                                  PTSolid* solid, 
-                                                  A3DPolygonicaOptions* opts, 
-                                                  A3D_log_func logging_function = nullptr)
+INTERNAL const double* stMeshCoords(const A3DBridgeMesh& sMesh)
 {
-   A3DEEntityType eType;
-   CHECK_A3DSTATUS(A3DEntityGetType(ri, &eType), logging_function, "A3DRiRepresentationItemCreatePTSolid - failed to get type of representation item");
-   if (eType != A3DEEntityType::kA3DTypeRiBrepModel && eType != A3DEEntityType::kA3DTypeRiPolyBrepModel) return A3D_PG_INVALID_RI;
+   return sMesh.m_pdBorrowedCoords ? sMesh.m_pdBorrowedCoords : sMesh.m_adCoords.data();
+}
+/***stMeshCoords******************************************************/
 
-   A3DStatus iRet = A3D_SUCCESS;
-   PTStatus status = PV_ENTITY_NULL;
+/*!
+\brief Returns the number of doubles of the vertex coordinates of a decoded mesh
+*/
+INTERNAL size_t stMeshCoordSize(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_pdBorrowedCoords ? sMesh.m_uiBorrowedCoordSize : sMesh.m_adCoords.size();
+}
+/***stMeshCoordSize***************************************************/
 
-   A3DRiRepresentationItemData	sRiData;
-   A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sRiData);
-   CHECK_A3DSTATUS(A3DRiRepresentationItemGet(ri, &sRiData), logging_function, "A3DRiRepresentationItemCreatePTSolid - A3DRiRepresentationItemGet");
+/*!
+\brief Returns the normals of a decoded mesh, three doubles per normal, borrowed or its own
+*/
+INTERNAL const double* stMeshNormals(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_pdBorrowedNormals ? sMesh.m_pdBorrowedNormals : sMesh.m_adNormals.data();
+}
+/***stMeshNormals*****************************************************/
 
-   A3DTess3DData sTessData;
-   A3D_INITIALIZE_DATA(A3DTess3DData, sTessData);
-   A3DTess3DGet(sRiData.m_pTessBase, &sTessData);
+/*!
+\brief Returns the number of doubles of the normals of a decoded mesh
+*/
+INTERNAL size_t stMeshNormalSize(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_pdBorrowedNormals ? sMesh.m_uiBorrowedNormalSize : sMesh.m_adNormals.size();
+}
+/***stMeshNormalSize**************************************************/
 
-   A3DTessBaseData sBaseTessData;
-   A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseTessData);
-   A3DTessBaseGet(sRiData.m_pTessBase, &sBaseTessData);
+/*!
+\brief Returns the number of triangles of a decoded mesh
+*/
+INTERNAL size_t stMeshTriangleCount(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_puiBorrowedIndices ? sMesh.m_uiBorrowedTriangles : sMesh.m_auiTriangleFaces.size();
+}
+/***stMeshTriangleCount***********************************************/
+
+/*!
+\brief Returns the vertex indices of a decoded mesh, three per triangle, borrowed or its own
+*/
+INTERNAL const unsigned* stMeshIndices(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_puiBorrowedIndices ? sMesh.m_puiBorrowedIndices : sMesh.m_auiIndices.data();
+}
+/***stMeshIndices*****************************************************/
 
-   // Get Indices and Normals
-   std::vector<unsigned int> auIndices;
-   std::vector<PTPointer> faceAppSurface;
-   std::vector<double> normals;
-   std::vector<PTInt32> normal_indices;
+/*!
+\brief Returns the normal indices of a decoded mesh, three per triangle, borrowed or its own
+*/
+INTERNAL const PTInt32* stMeshNormalIndices(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_puiBorrowedIndices ? sMesh.m_piBorrowedNormalIndices : sMesh.m_aiNormalIndices.data();
+}
+/***stMeshNormalIndices***********************************************/
+
+/*!
+\brief Returns the face of each triangle of a decoded mesh, borrowed or its own
+*/
+INTERNAL const unsigned* stMeshTriangleFaces(const A3DBridgeMesh& sMesh)
+{
+   return sMesh.m_puiBorrowedIndices ? sMesh.m_puiBorrowedTriangleFaces : sMesh.m_auiTriangleFaces.data();
+}
+/***stMeshTriangleFaces***********************************************/
 
-   unsigned uTopoFace, uFaceSize = sTessData.m_uiFaceTessSize, uFaceAppData = 0;
-   for (uTopoFace = 0; uTopoFace < uFaceSize; uTopoFace++)
+/*!
+\brief Copies the borrowed triangles of a decoded mesh into its own arrays, before they are modified
+*/
+INTERNAL void stMeshOwnTriangles(A3DBridgeMesh& sMesh)
+{
+   if (!sMesh.m_puiBorrowedIndices)
    {
-      IndicesPerFaceAsTriangles(sTessData, uTopoFace, auIndices, normal_indices, logging_function);
-      faceAppSurface.insert(faceAppSurface.end(), 
-                            auIndices.size() / 3 - faceAppSurface.size(), 
-                            (PTPointer)(PTNat64)(opts->m_iTopoFaceCount + uTopoFace));
+      return;
    }
+   const size_t uiTriangles = sMesh.m_uiBorrowedTriangles;
+   sMesh.m_auiIndices.assign(sMesh.m_puiBorrowedIndices, sMesh.m_puiBorrowedIndices + 3 * uiTriangles);
+   sMesh.m_aiNormalIndices.assign(sMesh.m_piBorrowedNormalIndices, sMesh.m_piBorrowedNormalIndices + 3 * uiTriangles);
+   sMesh.m_auiTriangleFaces.assign(sMesh.m_puiBorrowedTriangleFaces, sMesh.m_puiBorrowedTriangleFaces + uiTriangles);
+   sMesh.m_puiBorrowedIndices = nullptr;
+   sMesh.m_piBorrowedNormalIndices = nullptr;
+   sMesh.m_puiBorrowedTriangleFaces = nullptr;
+   sMesh.m_uiBorrowedTriangles = 0;
+}
+/***stMeshOwnTriangles************************************************/
 
-   for (int i = 0; i < auIndices.size(); i++)
+/*!
+\brief Frees the Exchange tessellation a mesh decoded with borrowed arrays holds; its coordinates and normals are then empty
+unless they were replaced by its own
+\param pStats [in,out] If not NULL, receives the time of the Exchange calls
+*/
+INTERNAL void stReleaseMeshTessellation(A3DBridgeMesh& sMesh,
+                                        A3DBridgeStats* pStats)
+{
+   (void)pStats;
+   sMesh.m_pdBorrowedCoords = nullptr;
+   sMesh.m_pdBorrowedNormals = nullptr;
+   if (sMesh.m_bHoldsTessellation)
    {
-      auIndices[i] = auIndices[i] / 3;
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_EXCHANGE);
+      A3DTess3DGet(NULL, &sMesh.m_sTessData);
+      A3DTessBaseGet(NULL, &sMesh.m_sBaseTessData);
+      sMesh.m_bHoldsTessellation = false;
    }
+}
+/***stReleaseMeshTessellation*****************************************/
 
-   PTMeshSolidOpts meshOpts;
-   PMInitMeshSolidOpts(&meshOpts);
+/*!
+\brief Returns the bytes of the arrays of a decoded mesh
+*/
+INTERNAL size_t stMeshBytes(const A3DBridgeMesh& sMesh)
+{
+   return stMeshTriangleCount(sMesh) * (4 * sizeof(unsigned) + 3 * sizeof(PTInt32)) +
+          (stMeshCoordSize(sMesh) + stMeshNormalSize(sMesh)) * sizeof(double);
+}
+/***stMeshBytes*******************************************************/
 
-   for (int i = 0; i < normal_indices.size(); i++)
+/*!
+\brief Decodes the tessellation of a representation item into a mesh ready for PFSolidCreateFromMesh
+\param ri The representation item. Must be an A3DRiPolyBrep or A3DRiBrepModel
+\param sMesh [out] The decoded mesh
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\param pStats [in,out] If not NULL, receives the time of the Exchange calls and of the decoding, but not the bytes
+of the mesh, as the mesh table decodes items again only to compare them
+\param pPool [in] If not NULL, an idle thread pool across which the faces of an item of at least
+uiParallelMinTriangles triangles are split. The mesh is identical to a decode on one thread
+\param bBorrowArrays If true, the mesh keeps the Exchange tessellation and borrows its coordinates and normals rather
+than copying them; stReleaseMeshTessellation must then free it, holding pExchangeMutex if any
+\return A3D_SUCCESS - Operation succeeded
+*/
+INTERNAL A3DStatus stDecodeRepresentationItem(const A3DRiRepresentationItem* ri,
+                                              A3DBridgeMesh& sMesh,
+                                              std::mutex* pExchangeMutex,
+                                              A3DBridgeStats* pStats,
+                                              A3D_log_func logging_function,
+                                              A3DBridgeThreadPool* pPool = nullptr,
+                                              size_t uiParallelMinTriangles = 0,
+                                              bool bBorrowArrays = false)
+{
+   (void)pStats;
+   std::unique_lock<std::mutex> sLock;
+   if (pExchangeMutex)
    {
-      normal_indices[i] = normal_indices[i] / 3;
+      sLock = std::unique_lock<std::mutex>(*pExchangeMutex);
    }
 
-   meshOpts.normals = (PTVector*)sTessData.m_pdNormals;
-   meshOpts.normal_indices = normal_indices.data();
-
-   meshOpts.app_surfaces = (PTPointer*)faceAppSurface.data();
-
-   status = PFSolidCreateFromMesh(opts->m_Environment,
-                                  (PTNat32)(auIndices.size() / 3),   // Total number of triangles
-                                  NULL,                              // No internal loops
-                                  NULL,                              // All faces are triangles
-                                  auIndices.data(),                  // Indices into vertex array
-                                  sBaseTessData.m_pdCoords,          // Pointer to vertex array
-                                  &meshOpts,
-                                  solid);                            // Resultant PG solid
+   A3DRiRepresentationItemData	sRiData;
+   A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sRiData);
+   A3DTess3DData sTessData;
+   A3D_INITIALIZE_DATA(A3DTess3DData, sTessData);
+   A3DTessBaseData sBaseTessData;
+   A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseTessData);
+   {
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_EXCHANGE);
+      CHECK_A3DSTATUS(A3DRiRepresentationItemGet(ri, &sRiData), logging_function, "A3DRiRepresentationItemCreatePTSolid - A3DRiRepresentationItemGet");
+      A3DTess3DGet(sRiData.m_pTessBase, &sTessData);
+      A3DTessBaseGet(sRiData.m_pTessBase, &sBaseTessData);
+   }
 
-   // TODO: Should a failure here set iRet to a failure status?
-   CHECK_PTSTATUS(status, logging_function, "A3DRiRepresentationItemCreatePTSolid - PFSolidCreateFromMesh");
+   // The Get data belong to the caller, so decoding needs no lock
+   if (sLock.owns_lock())
+   {
+      sLock.unlock();
+   }
 
-   if (status == PV_STATUS_OK)
    {
-      // Create a vector of PTEntityGroups containing faces on each topoFace
-      std::vector <PTEntityGroup>* groups = new std::vector<PTEntityGroup>;
-      for (int topoFace = 0; topoFace < (int)uFaceSize; topoFace++)
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_TRIANGLES);
+
+      // Count the triangles of every face so the index arrays are allocated once, each face owning a slice
+      unsigned uTopoFace, uFaceSize = sTessData.m_uiFaceTessSize;
+      std::vector<size_t> auiFaceStarts(uFaceSize + 1, 0);
+      for (uTopoFace = 0; uTopoFace < uFaceSize; uTopoFace++)
       {
-         PTEntityGroup group;
-         status = PFEntityGroupCreate(opts->m_Environment, &group);
-         groups->push_back(group);
+         auiFaceStarts[uTopoFace + 1] = auiFaceStarts[uTopoFace] + TrianglesPerFace(&sTessData.m_psFaceTessData[uTopoFace]);
       }
+      const size_t uiNbTriangles = auiFaceStarts[uFaceSize];
+
+      // Get Indices and Normals
+      sMesh.m_auiIndices.resize(3 * uiNbTriangles);
+      sMesh.m_aiNormalIndices.resize(3 * uiNbTriangles);
+      sMesh.m_auiTriangleFaces.resize(uiNbTriangles);
+      std::vector<A3DUns32> auiFaceTriangles(uFaceSize, 0);
+      auto fnDecodeFaces = [&](unsigned uFirstFace, unsigned uEndFace)
+      {
+         IndicesPerFaceRangeAsTriangles(sTessData, uFirstFace, uEndFace, auiFaceStarts.data(), sMesh.m_auiIndices.data(),
+                                        sMesh.m_aiNormalIndices.data(), sMesh.m_auiTriangleFaces.data(),
+                                        auiFaceTriangles.data(), logging_function);
+      };
 
-      // Add each face to a surface (topoFace) group
-      PTEntityList faces = PV_ENTITY_NULL;
-      PFEntityCreateEntityList(*solid, PV_ENTITY_TYPE_FACE, NULL, &faces);
-      long max_groups = (long)groups->size();
-      for (PTEntity face = PFEntityListGetFirst(faces); face != PV_ENTITY_NULL; face = PFEntityListGetNext(faces, face))
+      if (pPool && pPool->GetThreadCount() > 1 && uFaceSize > 1 && uiNbTriangles >= std::max<size_t>(1, uiParallelMinTriangles))
       {
-         // unsigned long long used to remove compiler warning. 
-         auto app_surface_index = (long long)PFEntityGetPointerProperty(face, PV_FACE_PROP_APP_SURFACE);
-         long uFaceTopoFace = (long)(app_surface_index - opts->m_iTopoFaceCount);
-         if ((uFaceTopoFace < 0) || (uFaceTopoFace >= max_groups))
+         // Ranges of faces of about equal triangles, several per thread as faces differ in size
+         const size_t uiRanges = std::min<size_t>(uFaceSize, 4 * (size_t)pPool->GetThreadCount());
+         std::vector<unsigned> auiRangeStarts(uiRanges + 1, uFaceSize);
+         for (size_t uiRange = 0; uiRange < uiRanges; uiRange++)
          {
-            // Invalid app surface value
-            logging_function("Invalid AppSurface retrieved from PTFace", A3D_log_level::A3D_LOG_ERROR);
-            // Delete all groups rather than pass on invalid data
-            // NULL group will be added to opts for this solid
-            for (int topoFace = 0; topoFace < (int)uFaceSize; topoFace++)
-            {
-               PFEntityGroupDestroy((*groups)[topoFace]);
-            }
-            delete groups;
-            groups = NULL;
-            // Set a failure return code
-            iRet = A3D_LOAD_INVALID_FILE_FORMAT;
-            break;
+            auiRangeStarts[uiRange] = (unsigned)(std::lower_bound(auiFaceStarts.begin(), auiFaceStarts.end() - 1,
+                                                                  uiRange * uiNbTriangles / uiRanges) - auiFaceStarts.begin());
+         }
+         auiRangeStarts[0] = 0;
+         pPool->ParallelFor(uiRanges, [&](size_t uiRange)
+         {
+            fnDecodeFaces(auiRangeStarts[uiRange], auiRangeStarts[uiRange + 1]);
+         });
+      }
+      else
+      {
+         fnDecodeFaces(0, uFaceSize);
+      }
+
+      // Faces that failed to decode leave the arrays shorter than counted, the triangles after them moving down
+      size_t uiTriangle = 0;
+      for (uTopoFace = 0; uTopoFace < uFaceSize; uTopoFace++)
+      {
+         const size_t uiStart = auiFaceStarts[uTopoFace], uiFaceTriangles = auiFaceTriangles[uTopoFace];
+         if (uiTriangle != uiStart)
+         {
+            std::copy_n(sMesh.m_auiIndices.begin() + 3 * uiStart, 3 * uiFaceTriangles, sMesh.m_auiIndices.begin() + 3 * uiTriangle);
+            std::copy_n(sMesh.m_aiNormalIndices.begin() + 3 * uiStart, 3 * uiFaceTriangles,
+                        sMesh.m_aiNormalIndices.begin() + 3 * uiTriangle);
+            std::copy_n(sMesh.m_auiTriangleFaces.begin() + uiStart, uiFaceTriangles, sMesh.m_auiTriangleFaces.begin() + uiTriangle);
+         }
+         uiTriangle += uiFaceTriangles;
+      }
+      sMesh.m_auiIndices.resize(3 * uiTriangle);
+      sMesh.m_aiNormalIndices.resize(3 * uiTriangle);
+      sMesh.m_auiTriangleFaces.resize(uiTriangle);
+
+      if (!bBorrowArrays)
+      {
+         sMesh.m_adCoords.assign(sBaseTessData.m_pdCoords, sBaseTessData.m_pdCoords + sBaseTessData.m_uiCoordSize);
+         sMesh.m_adNormals.assign(sTessData.m_pdNormals, sTessData.m_pdNormals + sTessData.m_uiNormalSize);
+      }
+      sMesh.m_uiFaceCount = uFaceSize;
+   }
+   if (bBorrowArrays)
+   {
+      sMesh.m_sTessData = sTessData;
+      sMesh.m_sBaseTessData = sBaseTessData;
+      sMesh.m_bHoldsTessellation = true;
+      sMesh.m_pdBorrowedCoords = sBaseTessData.m_pdCoords;
+      sMesh.m_pdBorrowedNormals = sTessData.m_pdNormals;
+      sMesh.m_uiBorrowedCoordSize = sBaseTessData.m_uiCoordSize;
+      sMesh.m_uiBorrowedNormalSize = sTessData.m_uiNormalSize;
+   }
+
+   if (pExchangeMutex)
+   {
+      sLock.lock();
+   }
+   {
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_EXCHANGE);
+      A3DRiRepresentationItemGet(NULL, &sRiData);
+      if (!bBorrowArrays)
+      {
+         A3DTess3DGet(NULL, &sTessData);
+         A3DTessBaseGet(NULL, &sBaseTessData);
+      }
+   }
+
+   return A3D_SUCCESS;
+}
+/***stDecodeRepresentationItem****************************************/
+
+/*!
+\brief Mixes bytes into a hash: FNV-1a on 8 byte words, folding the high bits back after each multiply
+*/
+INTERNAL void stHashBytes(A3DUns64& uiHash, const void* pData, size_t uiBytes)
+{
+   const unsigned char* pcData = (const unsigned char*)pData;
+   size_t ui = 0;
+   for (; ui + 8 <= uiBytes; ui += 8)
+   {
+      A3DUns64 uiWord;
+      memcpy(&uiWord, pcData + ui, 8);
+      uiHash = (uiHash ^ uiWord) * 1099511628211ULL;
+      uiHash ^= uiHash >> 32;
+   }
+   for (; ui < uiBytes; ui++)
+   {
+      uiHash = (uiHash ^ pcData[ui]) * 1099511628211ULL;
+   }
+}
+/***stHashBytes*******************************************************/
+
+/*!
+\brief Checks that the header and entries of a mapped mesh cache file describe arrays inside the file
+*/
+INTERNAL bool stMeshCacheValid(const unsigned char* pcData, size_t uiBytes)
+{
+   if (uiBytes < sizeof(A3DBridgeMeshCacheHeader))
+   {
+      return false;
+   }
+   const A3DBridgeMeshCacheHeader* pHeader = (const A3DBridgeMeshCacheHeader*)pcData;
+   if (memcmp(pHeader->m_acMagic, "A3DBMESH", 8) != 0 || pHeader->m_uiVersion != A3D_BRIDGE_MESH_CACHE_VERSION ||
+       pHeader->m_usIndexBytes != sizeof(unsigned) || pHeader->m_usNormalIndexBytes != sizeof(PTInt32) ||
+       pHeader->m_uiFileBytes != uiBytes || pHeader->m_uiEntries % 8 != 0 || pHeader->m_uiEntries > uiBytes ||
+       pHeader->m_uiItemCount > (uiBytes - pHeader->m_uiEntries) / sizeof(A3DBridgeMeshCacheEntry))
+   {
+      return false;
+   }
+
+   // Each array must be aligned for its type and end inside the file
+   auto fnInside = [uiBytes](A3DUns64 uiOffset, A3DUns64 uiCount, size_t uiSize)
+   {
+      return uiOffset % 8 == 0 && uiOffset <= uiBytes && uiCount <= (uiBytes - uiOffset) / uiSize;
+   };
+   const A3DBridgeMeshCacheEntry* pEntries = (const A3DBridgeMeshCacheEntry*)(pcData + pHeader->m_uiEntries);
+   for (A3DUns64 ui = 0; ui < pHeader->m_uiItemCount; ui++)
+   {
+      const A3DBridgeMeshCacheEntry& sEntry = pEntries[ui];
+      if (sEntry.m_uiTriangles > uiBytes || sEntry.m_uiFaceCount > 0xFFFFFFFFULL ||
+          !fnInside(sEntry.m_uiIndices, 3 * sEntry.m_uiTriangles, sizeof(unsigned)) ||
+          !fnInside(sEntry.m_uiNormalIndices, 3 * sEntry.m_uiTriangles, sizeof(PTInt32)) ||
+          !fnInside(sEntry.m_uiTriangleFaces, sEntry.m_uiTriangles, sizeof(unsigned)) ||
+          !fnInside(sEntry.m_uiCoords, sEntry.m_uiCoordCount, sizeof(double)) ||
+          !fnInside(sEntry.m_uiNormals, sEntry.m_uiNormalCount, sizeof(double)))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+/***stMeshCacheValid**************************************************/
+
+/*!
+\brief Unmaps the file of a mesh cache opened for reading
+*/
+INTERNAL void stMeshCacheUnmap(A3DBridgeMeshCache& sCache)
+{
+   if (sCache.m_pcData)
+   {
+#ifdef _WIN32
+      UnmapViewOfFile(sCache.m_pcData);
+#else
+      munmap((void*)sCache.m_pcData, sCache.m_uiBytes);
+#endif
+   }
+#ifdef _WIN32
+   if (sCache.m_hMapping != NULL)
+   {
+      CloseHandle(sCache.m_hMapping);
+   }
+   if (sCache.m_hFile != INVALID_HANDLE_VALUE)
+   {
+      CloseHandle(sCache.m_hFile);
+   }
+   sCache.m_hMapping = NULL;
+   sCache.m_hFile = INVALID_HANDLE_VALUE;
+#endif
+   sCache.m_pcData = nullptr;
+   sCache.m_uiBytes = 0;
+   sCache.m_pEntries = nullptr;
+   sCache.m_uiItemCount = 0;
+}
+/***stMeshCacheUnmap**************************************************/
+
+/*!
+\brief Maps the file of a mesh cache for reading
+\return true if the file exists and is a valid mesh cache file of this version
+*/
+INTERNAL bool stMeshCacheMap(A3DBridgeMeshCache& sCache,
+                             A3D_log_func logging_function)
+{
+#ifdef _WIN32
+   sCache.m_hFile = CreateFileA(sCache.m_sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (sCache.m_hFile == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+   LARGE_INTEGER sSize;
+   if (!GetFileSizeEx(sCache.m_hFile, &sSize) || sSize.QuadPart == 0)
+   {
+      stMeshCacheUnmap(sCache);
+      return false;
+   }
+   sCache.m_hMapping = CreateFileMappingA(sCache.m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+   const void* pData = sCache.m_hMapping != NULL ? MapViewOfFile(sCache.m_hMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+   if (!pData)
+   {
+      stMeshCacheUnmap(sCache);
+      return false;
+   }
+   sCache.m_uiBytes = (size_t)sSize.QuadPart;
+#else
+   int iFile = open(sCache.m_sPath.c_str(), O_RDONLY);
+   if (iFile < 0)
+   {
+      return false;
+   }
+   struct stat sStat;
+   void* pData = MAP_FAILED;
+   if (fstat(iFile, &sStat) == 0 && sStat.st_size > 0)
+   {
+      pData = mmap(NULL, (size_t)sStat.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+   }
+   close(iFile);
+   if (pData == MAP_FAILED)
+   {
+      return false;
+   }
+   sCache.m_uiBytes = (size_t)sStat.st_size;
+#endif
+   sCache.m_pcData = (const unsigned char*)pData;
+
+   if (!stMeshCacheValid(sCache.m_pcData, sCache.m_uiBytes))
+   {
+      log(logging_function, "stMeshCacheMap - ignoring an invalid or older mesh cache file: " + sCache.m_sPath, A3D_LOG_WARN);
+      stMeshCacheUnmap(sCache);
+      return false;
+   }
+   const A3DBridgeMeshCacheHeader* pHeader = (const A3DBridgeMeshCacheHeader*)sCache.m_pcData;
+   sCache.m_pEntries = (const A3DBridgeMeshCacheEntry*)(sCache.m_pcData + pHeader->m_uiEntries);
+   sCache.m_uiItemCount = (size_t)pHeader->m_uiItemCount;
+   return true;
+}
+/***stMeshCacheMap****************************************************/
+
+/*!
+\brief Opens the mesh cache file of a key: maps it if it is complete, else starts writing it
+\param sCache [out] The cache
+\param sDirectory The directory of the cache files
+\param sKey The key of the model
+*/
+INTERNAL void stMeshCacheOpen(A3DBridgeMeshCache& sCache,
+                              const std::string& sDirectory,
+                              const std::string& sKey,
+                              A3D_log_func logging_function)
+{
+   sCache.m_sPath = sDirectory + "/" + sKey + ".a3dmesh";
+   if (stMeshCacheMap(sCache, logging_function))
+   {
+      return;
+   }
+
+   // Concurrent conversions of the same key each write their own file and the last to finish replaces the others
+   sCache.m_sTempPath = sCache.m_sPath + "." +
+      std::to_string((unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+   sCache.m_pFile = fopen(sCache.m_sTempPath.c_str(), "wb");
+   if (!sCache.m_pFile)
+   {
+      log(logging_function, "stMeshCacheOpen - cannot write the mesh cache file " + sCache.m_sTempPath, A3D_LOG_WARN);
+      return;
+   }
+   // The header is written last, when the entries are known
+   A3DBridgeMeshCacheHeader sHeader;
+   memset(&sHeader, 0, sizeof(sHeader));
+   sCache.m_bFailed = fwrite(&sHeader, sizeof(sHeader), 1, sCache.m_pFile) != 1;
+   sCache.m_uiOffset = sizeof(sHeader);
+}
+/***stMeshCacheOpen***************************************************/
+
+/*!
+\brief Returns the identity of a representation item in a mesh cache file, a hash of the coordinates of its tessellation
+*/
+INTERNAL A3DUns64 stMeshCacheIdentity(const double* pdCoords,
+                                      size_t uiCoordCount)
+{
+   A3DUns64 uiHash = 14695981039346656037ULL;
+   const A3DUns64 uiCount = uiCoordCount;
+   stHashBytes(uiHash, &uiCount, sizeof(uiCount));
+   stHashBytes(uiHash, pdCoords, uiCoordCount * sizeof(double));
+   return uiHash;
+}
+/***stMeshCacheIdentity***********************************************/
+
+/*!
+\brief Reads the coordinates of a representation item from Exchange and returns their stMeshCacheIdentity
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\param pStats [in,out] If not NULL, receives the time of the Exchange calls
+*/
+INTERNAL A3DUns64 stRepresentationItemIdentity(const A3DRiRepresentationItem* ri,
+                                               std::mutex* pExchangeMutex,
+                                               A3DBridgeStats* pStats,
+                                               A3D_log_func logging_function)
+{
+   (void)pStats;
+   std::unique_lock<std::mutex> sLock;
+   if (pExchangeMutex)
+   {
+      sLock = std::unique_lock<std::mutex>(*pExchangeMutex);
+   }
+   A3DRiRepresentationItemData sRiData;
+   A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sRiData);
+   A3DTessBaseData sBaseTessData;
+   A3D_INITIALIZE_DATA(A3DTessBaseData, sBaseTessData);
+   {
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_EXCHANGE);
+      CHECK_A3DSTATUS(A3DRiRepresentationItemGet(ri, &sRiData), logging_function, "stRepresentationItemIdentity - A3DRiRepresentationItemGet");
+      A3DTessBaseGet(sRiData.m_pTessBase, &sBaseTessData);
+   }
+   if (sLock.owns_lock())
+   {
+      sLock.unlock();
+   }
+
+   const A3DUns64 uiIdentity = stMeshCacheIdentity(sBaseTessData.m_pdCoords, sBaseTessData.m_uiCoordSize);
+
+   if (pExchangeMutex)
+   {
+      sLock.lock();
+   }
+   {
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_EXCHANGE);
+      A3DTessBaseGet(NULL, &sBaseTessData);
+      A3DRiRepresentationItemGet(NULL, &sRiData);
+   }
+   return uiIdentity;
+}
+/***stRepresentationItemIdentity**************************************/
+
+/*!
+\brief Reads the mesh of a representation item from a mapped mesh cache file
+The mesh borrows the arrays of the file, so it must not be used once the file is closed.
+\param pCache The cache, may be NULL
+\param uiItem The number of the item
+\param sMesh [out] The mesh
+\param pStats [in,out] If not NULL, receives the time of the read as decoding
+\return true if the file holds the item
+*/
+INTERNAL bool stMeshCacheCopy(const A3DBridgeMeshCache* pCache,
+                              size_t uiItem,
+                              A3DBridgeMesh& sMesh,
+                              A3DBridgeStats* pStats)
+{
+   (void)pStats;
+   if (!pCache || uiItem >= pCache->m_uiItemCount)
+   {
+      return false;
+   }
+   A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_TRIANGLES);
+   const A3DBridgeMeshCacheEntry& sEntry = pCache->m_pEntries[uiItem];
+   const unsigned char* pcData = pCache->m_pcData;
+   sMesh = A3DBridgeMesh();
+   sMesh.m_puiBorrowedIndices = (const unsigned*)(pcData + sEntry.m_uiIndices);
+   sMesh.m_piBorrowedNormalIndices = (const PTInt32*)(pcData + sEntry.m_uiNormalIndices);
+   sMesh.m_puiBorrowedTriangleFaces = (const unsigned*)(pcData + sEntry.m_uiTriangleFaces);
+   sMesh.m_uiBorrowedTriangles = (size_t)sEntry.m_uiTriangles;
+   sMesh.m_pdBorrowedCoords = (const double*)(pcData + sEntry.m_uiCoords);
+   sMesh.m_pdBorrowedNormals = (const double*)(pcData + sEntry.m_uiNormals);
+   sMesh.m_uiBorrowedCoordSize = (size_t)sEntry.m_uiCoordCount;
+   sMesh.m_uiBorrowedNormalSize = (size_t)sEntry.m_uiNormalCount;
+   sMesh.m_uiFaceCount = (unsigned)sEntry.m_uiFaceCount;
+   return true;
+}
+/***stMeshCacheCopy***************************************************/
+
+/*!
+\brief Reads the mesh of a representation item from a mapped mesh cache file, counting it as a hit
+The entry of the item must have been written for the same item: otherwise the file is marked stale and the mesh is
+not read.
+\param pCache The cache, may be NULL
+\param uiItem The number of the item
+\param ri The item
+\param sMesh [out] The mesh
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\param pStats [in,out] If not NULL, receives the time of the Exchange calls and of the copy
+\return true if the file holds the item
+*/
+INTERNAL bool stMeshCacheRead(A3DBridgeMeshCache* pCache,
+                              size_t uiItem,
+                              const A3DRiRepresentationItem* ri,
+                              A3DBridgeMesh& sMesh,
+                              std::mutex* pExchangeMutex,
+                              A3DBridgeStats* pStats,
+                              A3D_log_func logging_function)
+{
+   if (!pCache || uiItem >= pCache->m_uiItemCount)
+   {
+      return false;
+   }
+   if (pCache->m_pEntries[uiItem].m_uiIdentity != stRepresentationItemIdentity(ri, pExchangeMutex, pStats, logging_function))
+   {
+      pCache->m_bStale = true;
+      return false;
+   }
+   if (!stMeshCacheCopy(pCache, uiItem, sMesh, pStats))
+   {
+      return false;
+   }
+   pCache->m_uiHits++;
+   return true;
+}
+/***stMeshCacheRead***************************************************/
+
+/*!
+\brief Appends an array to the mesh cache file being written, padded to a multiple of 8 bytes
+\return The offset of the array in the file
+*/
+INTERNAL A3DUns64 stMeshCacheAppend(A3DBridgeMeshCache& sCache,
+                                    const void* pData,
+                                    size_t uiBytes)
+{
+   static const char acPadding[8] = {};
+   A3DUns64 uiOffset = sCache.m_uiOffset;
+   size_t uiPadding = (8 - uiBytes % 8) % 8;
+   if ((uiBytes && fwrite(pData, 1, uiBytes, sCache.m_pFile) != uiBytes) ||
+       (uiPadding && fwrite(acPadding, 1, uiPadding, sCache.m_pFile) != uiPadding))
+   {
+      sCache.m_bFailed = true;
+   }
+   sCache.m_uiOffset += uiBytes + uiPadding;
+   return uiOffset;
+}
+/***stMeshCacheAppend*************************************************/
+
+/*!
+\brief Writes the mesh of a representation item to the mesh cache file being written
+\param pCache The cache, may be NULL or open for reading
+\param uiItem The number of the item; items are written in order
+\param sMesh The decoded mesh, before welding so that its coordinates are those of Exchange
+*/
+INTERNAL void stMeshCacheWrite(A3DBridgeMeshCache* pCache,
+                               size_t uiItem,
+                               const A3DBridgeMesh& sMesh)
+{
+   if (!pCache || !pCache->m_pFile || pCache->m_bFailed)
+   {
+      return;
+   }
+   if (uiItem != pCache->m_entries.size())
+   {
+      pCache->m_bFailed = true;
+      return;
+   }
+   A3DBridgeMeshCacheEntry sEntry;
+   const size_t uiTriangles = stMeshTriangleCount(sMesh);
+   sEntry.m_uiTriangles = uiTriangles;
+   sEntry.m_uiIndices = stMeshCacheAppend(*pCache, stMeshIndices(sMesh), 3 * uiTriangles * sizeof(unsigned));
+   sEntry.m_uiNormalIndices = stMeshCacheAppend(*pCache, stMeshNormalIndices(sMesh), 3 * uiTriangles * sizeof(PTInt32));
+   sEntry.m_uiTriangleFaces = stMeshCacheAppend(*pCache, stMeshTriangleFaces(sMesh), uiTriangles * sizeof(unsigned));
+   sEntry.m_uiCoordCount = stMeshCoordSize(sMesh);
+   sEntry.m_uiCoords = stMeshCacheAppend(*pCache, stMeshCoords(sMesh), stMeshCoordSize(sMesh) * sizeof(double));
+   sEntry.m_uiNormalCount = stMeshNormalSize(sMesh);
+   sEntry.m_uiNormals = stMeshCacheAppend(*pCache, stMeshNormals(sMesh), stMeshNormalSize(sMesh) * sizeof(double));
+   sEntry.m_uiFaceCount = sMesh.m_uiFaceCount;
+   sEntry.m_uiIdentity = stMeshCacheIdentity(stMeshCoords(sMesh), stMeshCoordSize(sMesh));
+   pCache->m_entries.push_back(sEntry);
+}
+/***stMeshCacheWrite**************************************************/
+
+/*!
+\brief Closes a mesh cache: unmaps the file read, or completes the file written and moves it to its path
+\param sCache The cache
+\param bComplete False if the conversion failed, in which case a file being written is discarded
+*/
+INTERNAL void stMeshCacheClose(A3DBridgeMeshCache& sCache,
+                               bool bComplete,
+                               A3D_log_func logging_function)
+{
+   if (sCache.m_pcData)
+   {
+      bool bStale = sCache.m_bStale;
+      if (sCache.m_uiNextItem != sCache.m_uiItemCount)
+      {
+         log(logging_function, "stMeshCacheClose - the mesh cache file holds " + std::to_string(sCache.m_uiItemCount) +
+             " representation items but the model has " + std::to_string(sCache.m_uiNextItem) +
+             "; the key may not match the model: " + sCache.m_sPath, A3D_LOG_WARN);
+         bStale = true;
+      }
+      else if (bStale)
+      {
+         log(logging_function, "stMeshCacheClose - representation items were built in another order than in the mesh cache file "
+             "and decoded from Exchange: " + sCache.m_sPath, A3D_LOG_WARN);
+      }
+      stMeshCacheUnmap(sCache);
+      // The next conversion of the key writes the file again
+      if (bStale)
+      {
+         remove(sCache.m_sPath.c_str());
+      }
+      return;
+   }
+   if (!sCache.m_pFile)
+   {
+      return;
+   }
+
+   bool bWritten = bComplete && !sCache.m_bFailed && sCache.m_entries.size() == sCache.m_uiNextItem;
+   if (bWritten)
+   {
+      A3DBridgeMeshCacheHeader sHeader;
+      memset(&sHeader, 0, sizeof(sHeader));
+      memcpy(sHeader.m_acMagic, "A3DBMESH", 8);
+      sHeader.m_uiVersion = A3D_BRIDGE_MESH_CACHE_VERSION;
+      sHeader.m_usIndexBytes = sizeof(unsigned);
+      sHeader.m_usNormalIndexBytes = sizeof(PTInt32);
+      sHeader.m_uiItemCount = sCache.m_entries.size();
+      sHeader.m_uiEntries = stMeshCacheAppend(sCache, sCache.m_entries.data(), sCache.m_entries.size() * sizeof(A3DBridgeMeshCacheEntry));
+      sHeader.m_uiFileBytes = sCache.m_uiOffset;
+      bWritten = !sCache.m_bFailed && fseek(sCache.m_pFile, 0, SEEK_SET) == 0 &&
+                 fwrite(&sHeader, sizeof(sHeader), 1, sCache.m_pFile) == 1;
+   }
+   bWritten = fclose(sCache.m_pFile) == 0 && bWritten;
+   sCache.m_pFile = nullptr;
+
+   if (bWritten)
+   {
+#ifdef _WIN32
+      bWritten = MoveFileExA(sCache.m_sTempPath.c_str(), sCache.m_sPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+      bWritten = rename(sCache.m_sTempPath.c_str(), sCache.m_sPath.c_str()) == 0;
+#endif
+   }
+   if (bWritten)
+   {
+      log(logging_function, "stMeshCacheClose - wrote the meshes of " + std::to_string(sCache.m_entries.size()) +
+          " representation items to " + sCache.m_sPath, A3D_LOG_INFO);
+   }
+   else
+   {
+      remove(sCache.m_sTempPath.c_str());
+      if (bComplete)
+      {
+         log(logging_function, "stMeshCacheClose - failed to write the mesh cache file " + sCache.m_sPath, A3D_LOG_WARN);
+      }
+   }
+   sCache.m_entries.clear();
+}
+/***stMeshCacheClose**************************************************/
+
+/*!
+\brief Hashes the face count, the sizes of the arrays and the triangles of a decoded mesh, but not its coordinates and normals
+*/
+INTERNAL A3DUns64 stMeshConnectivityHash(const A3DBridgeMesh& sMesh)
+{
+   A3DUns64 uiHash = 14695981039346656037ULL;
+   const size_t uiTriangles = stMeshTriangleCount(sMesh);
+   A3DUns64 auiSizes[] = { sMesh.m_uiFaceCount, 3 * uiTriangles, 3 * uiTriangles, uiTriangles, stMeshCoordSize(sMesh),
+                           stMeshNormalSize(sMesh) };
+   stHashBytes(uiHash, auiSizes, sizeof(auiSizes));
+   stHashBytes(uiHash, stMeshIndices(sMesh), 3 * uiTriangles * sizeof(unsigned));
+   stHashBytes(uiHash, stMeshNormalIndices(sMesh), 3 * uiTriangles * sizeof(PTInt32));
+   stHashBytes(uiHash, stMeshTriangleFaces(sMesh), uiTriangles * sizeof(unsigned));
+   return uiHash;
+}
+/***stMeshConnectivityHash********************************************/
+
+/*!
+\brief Hashes the face count, triangles, coordinates and normals of a decoded mesh
+*/
+INTERNAL A3DUns64 stMeshHash(const A3DBridgeMesh& sMesh)
+{
+   A3DUns64 uiHash = stMeshConnectivityHash(sMesh);
+   stHashBytes(uiHash, stMeshCoords(sMesh), stMeshCoordSize(sMesh) * sizeof(double));
+   stHashBytes(uiHash, stMeshNormals(sMesh), stMeshNormalSize(sMesh) * sizeof(double));
+   return uiHash;
+}
+/***stMeshHash********************************************************/
+
+/*!
+\brief Returns true if two decoded meshes are byte for byte identical
+*/
+INTERNAL bool stMeshEqual(const A3DBridgeMesh& sMesh1, const A3DBridgeMesh& sMesh2)
+{
+   auto fnSame = [](const void* pData1, const void* pData2, size_t uiBytes)
+   {
+      return uiBytes == 0 || memcmp(pData1, pData2, uiBytes) == 0;
+   };
+
+   const size_t uiTriangles = stMeshTriangleCount(sMesh1);
+   return sMesh1.m_uiFaceCount == sMesh2.m_uiFaceCount &&
+          uiTriangles == stMeshTriangleCount(sMesh2) &&
+          stMeshCoordSize(sMesh1) == stMeshCoordSize(sMesh2) &&
+          stMeshNormalSize(sMesh1) == stMeshNormalSize(sMesh2) &&
+          fnSame(stMeshIndices(sMesh1), stMeshIndices(sMesh2), 3 * uiTriangles * sizeof(unsigned)) &&
+          fnSame(stMeshNormalIndices(sMesh1), stMeshNormalIndices(sMesh2), 3 * uiTriangles * sizeof(PTInt32)) &&
+          fnSame(stMeshTriangleFaces(sMesh1), stMeshTriangleFaces(sMesh2), uiTriangles * sizeof(unsigned)) &&
+          fnSame(stMeshCoords(sMesh1), stMeshCoords(sMesh2), stMeshCoordSize(sMesh1) * sizeof(double)) &&
+          fnSame(stMeshNormals(sMesh1), stMeshNormals(sMesh2), stMeshNormalSize(sMesh1) * sizeof(double));
+}
+/***stMeshEqual*******************************************************/
+
+/*!
+\brief Welds the vertices of a mesh closer than a tolerance, such as the copies Exchange makes along the boundaries
+of the CAD faces, and drops the triangles this leaves with a repeated vertex
+The kept vertices are hashed by the cell of a grid of twice the tolerance, so each vertex is compared with those of
+its cell and of the up to 7 neighbouring cells on its nearer sides only. Normal indices and triangle faces are kept with their triangles.
+\param sMesh [in,out] The mesh
+\param dTolerance The largest distance of two welded vertices; 0 welds identical coordinates only
+\param uiDegenerate [out] The triangles dropped
+\param pStats [in,out] If not NULL, receives the time of welding
+\return false if the mesh has indices out of range, in which case it is unchanged
+*/
+INTERNAL bool stWeldMesh(A3DBridgeMesh& sMesh,
+                         double dTolerance,
+                         size_t& uiDegenerate,
+                         A3DBridgeStats* pStats)
+{
+   (void)pStats;
+   A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_WELD);
+   uiDegenerate = 0;
+   // Welding moves the triangles in place
+   stMeshOwnTriangles(sMesh);
+   const size_t uiVertices = stMeshCoordSize(sMesh) / 3;
+   for (unsigned uiIndex : sMesh.m_auiIndices)
+   {
+      if (uiIndex >= uiVertices)
+      {
+         return false;
+      }
+   }
+
+   // The coordinates of a vertex identify its cell, with -0 as 0, when the tolerance is 0. Otherwise the cells are
+   // twice the tolerance, so a vertex is within the tolerance of at most one neighbour of its cell along each axis
+   const bool bExact = !(dTolerance > 0.);
+   const double dCellSize = 2. * dTolerance;
+   auto fnCell = [&](const double* pdPoint, A3DUns64 auiCell[3], int aiNear[3])
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         if (bExact)
+         {
+            double dCoord = pdPoint[i] + 0.;
+            memcpy(&auiCell[i], &dCoord, sizeof(double));
+            aiNear[i] = 0;
+            continue;
+         }
+         double dScaled = pdPoint[i] / dCellSize;
+         double dCell = std::floor(dScaled);
+         aiNear[i] = dScaled - dCell < 0.5 ? -1 : 1;
+         dCell = !(dCell > -4e18) ? -4e18 : !(dCell < 4e18) ? 4e18 : dCell;
+         auiCell[i] = (A3DUns64)(long long)dCell;
+      }
+   };
+   auto fnHash = [](const A3DUns64 auiCell[3]) -> A3DUns64
+   {
+      A3DUns64 uiHash = 14695981039346656037ULL;
+      stHashBytes(uiHash, auiCell, 3 * sizeof(A3DUns64));
+      return uiHash;
+   };
+
+   // The kept vertices of each cell, newest first, chained through auiNext; cells with equal hashes share a chain
+   const unsigned uiNone = 0xFFFFFFFFu;
+   std::unordered_map<A3DUns64, unsigned> cells;
+   cells.reserve(uiVertices);
+   std::vector<unsigned> auiNext;
+   auiNext.reserve(uiVertices);
+   std::vector<unsigned> auiRemap(uiVertices);
+   std::vector<double> adWelded;
+   adWelded.reserve(stMeshCoordSize(sMesh));
+   const double dTolerance2 = bExact ? 0. : dTolerance * dTolerance;
+   const unsigned uiProbes = bExact ? 1 : 8;
+
+   for (size_t uiVertex = 0; uiVertex < uiVertices; uiVertex++)
+   {
+      const double* pdPoint = stMeshCoords(sMesh) + 3 * uiVertex;
+      A3DUns64 auiCell[3];
+      int aiNear[3];
+      fnCell(pdPoint, auiCell, aiNear);
+      A3DUns64 uiHash = fnHash(auiCell);
+
+      // The own cell first, then the neighbours towards the nearer side along each axis
+      unsigned uiFound = uiNone;
+      for (unsigned uiProbe = 0; uiProbe < uiProbes && uiFound == uiNone; uiProbe++)
+      {
+         A3DUns64 auiProbe[3];
+         for (int i = 0; i < 3; i++)
+         {
+            auiProbe[i] = auiCell[i] + ((uiProbe >> i) & 1 ? (A3DUns64)(long long)aiNear[i] : 0);
+         }
+         auto cell = cells.find(uiProbe ? fnHash(auiProbe) : uiHash);
+         for (unsigned uiKept = cell == cells.end() ? uiNone : cell->second; uiKept != uiNone; uiKept = auiNext[uiKept])
+         {
+            const double* pdKept = &adWelded[3 * uiKept];
+            double dX = pdKept[0] - pdPoint[0], dY = pdKept[1] - pdPoint[1], dZ = pdKept[2] - pdPoint[2];
+            if (bExact ? (dX == 0. && dY == 0. && dZ == 0.) : dX * dX + dY * dY + dZ * dZ <= dTolerance2)
+            {
+               uiFound = uiKept;
+               break;
+            }
+         }
+      }
+      if (uiFound == uiNone)
+      {
+         uiFound = (unsigned)auiNext.size();
+         adWelded.insert(adWelded.end(), pdPoint, pdPoint + 3);
+         auto cell = cells.insert(std::make_pair(uiHash, uiNone)).first;
+         auiNext.push_back(cell->second);
+         cell->second = uiFound;
+      }
+      auiRemap[uiVertex] = uiFound;
+   }
+
+   // Remap the corners and keep the triangles with three distinct vertices
+   size_t uiKeptTriangles = 0;
+   const size_t uiTriangles = sMesh.m_auiTriangleFaces.size();
+   for (size_t uiTriangle = 0; uiTriangle < uiTriangles; uiTriangle++)
+   {
+      unsigned uiA = auiRemap[sMesh.m_auiIndices[3 * uiTriangle]];
+      unsigned uiB = auiRemap[sMesh.m_auiIndices[3 * uiTriangle + 1]];
+      unsigned uiC = auiRemap[sMesh.m_auiIndices[3 * uiTriangle + 2]];
+      if (uiA == uiB || uiB == uiC || uiC == uiA)
+      {
+         continue;
+      }
+      sMesh.m_auiIndices[3 * uiKeptTriangles] = uiA;
+      sMesh.m_auiIndices[3 * uiKeptTriangles + 1] = uiB;
+      sMesh.m_auiIndices[3 * uiKeptTriangles + 2] = uiC;
+      std::copy_n(sMesh.m_aiNormalIndices.begin() + 3 * uiTriangle, 3, sMesh.m_aiNormalIndices.begin() + 3 * uiKeptTriangles);
+      sMesh.m_auiTriangleFaces[uiKeptTriangles] = sMesh.m_auiTriangleFaces[uiTriangle];
+      uiKeptTriangles++;
+   }
+   uiDegenerate = uiTriangles - uiKeptTriangles;
+   sMesh.m_auiIndices.resize(3 * uiKeptTriangles);
+   sMesh.m_aiNormalIndices.resize(3 * uiKeptTriangles);
+   sMesh.m_auiTriangleFaces.resize(uiKeptTriangles);
+   sMesh.m_adCoords.swap(adWelded);
+   sMesh.m_pdBorrowedCoords = nullptr;
+   return true;
+}
+/***stWeldMesh********************************************************/
+
+/*!
+\brief Welds a decoded mesh if A3DPolygonicaOptions::m_bWeldVertices is set
+\param auiCounts [in,out] Receive the vertices before and after welding, and the triangles dropped
+*/
+INTERNAL void stWeldDecodedMesh(A3DPolygonicaOptions* opts,
+                                A3DBridgeMesh& sMesh,
+                                size_t auiCounts[3])
+{
+   if (!opts->m_bWeldVertices)
+   {
+      return;
+   }
+   size_t uiBefore = stMeshCoordSize(sMesh) / 3, uiDegenerate = 0;
+   if (stWeldMesh(sMesh, opts->m_dWeldTolerance, uiDegenerate, A3D_BRIDGE_STATS_OF(*opts)))
+   {
+      auiCounts[0] += uiBefore;
+      auiCounts[1] += stMeshCoordSize(sMesh) / 3;
+      auiCounts[2] += uiDegenerate;
+   }
+}
+/***stWeldDecodedMesh*************************************************/
+
+/*!
+\brief Welds an earlier item decoded again by the mesh table as it was welded when it was added
+\param dTolerance The weld tolerance, negative if the meshes are not welded
+*/
+INTERNAL void stWeldCandidateMesh(A3DBridgeMesh& sMesh,
+                                  double dTolerance,
+                                  A3DBridgeStats* pStats)
+{
+   size_t uiDegenerate = 0;
+   if (dTolerance >= 0.)
+   {
+      stWeldMesh(sMesh, dTolerance, uiDegenerate, pStats);
+   }
+}
+/***stWeldCandidateMesh***********************************************/
+
+/*!
+\brief Keeps the mesh of an item added to the mesh table for the comparisons with later items
+The arrays borrowed from Exchange are copied, as the tessellation is released once the solid is built; those
+borrowed from the mesh cache file stay borrowed, as the file is closed after the meshes are released.
+*/
+INTERNAL void stMeshTableKeep(A3DBridgeMeshTable& table,
+                              const A3DRiRepresentationItem* ri,
+                              const A3DBridgeMesh& sMesh)
+{
+   A3DBridgeMesh& sKept = table.m_meshes[ri];
+   sKept = sMesh;
+   if (sMesh.m_bHoldsTessellation)
+   {
+      sKept.m_adCoords.assign(stMeshCoords(sMesh), stMeshCoords(sMesh) + stMeshCoordSize(sMesh));
+      sKept.m_adNormals.assign(stMeshNormals(sMesh), stMeshNormals(sMesh) + stMeshNormalSize(sMesh));
+      sKept.m_pdBorrowedCoords = nullptr;
+      sKept.m_pdBorrowedNormals = nullptr;
+      sKept.m_bHoldsTessellation = false;
+      sKept.m_sTessData = A3DTess3DData();
+      sKept.m_sBaseTessData = A3DTessBaseData();
+   }
+}
+/***stMeshTableKeep***************************************************/
+
+/*!
+\brief Returns the mesh of an earlier item of the mesh table to compare, as it was when it was added
+The mesh kept by stMeshTableKeep is used; an item added by an earlier conversion is decoded again and welded. The
+decode does not count as a decoded mesh in the stats.
+\param table The mesh table
+\param ri The item
+\param sDecoded [out] Receives the mesh if it is decoded again
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\param dWeldTolerance The weld tolerance, negative if the meshes are not welded
+\param pStats [in,out] If not NULL, receives the time of decoding
+\return The kept mesh or sDecoded
+*/
+INTERNAL const A3DBridgeMesh& stMeshTableCandidate(const A3DBridgeMeshTable& table,
+                                                   const A3DRiRepresentationItem* ri,
+                                                   A3DBridgeMesh& sDecoded,
+                                                   std::mutex* pExchangeMutex,
+                                                   double dWeldTolerance,
+                                                   A3DBridgeStats* pStats,
+                                                   A3D_log_func logging_function)
+{
+   auto kept = table.m_meshes.find(ri);
+   if (kept != table.m_meshes.end())
+   {
+      return kept->second;
+   }
+   stDecodeRepresentationItem(ri, sDecoded, pExchangeMutex, pStats, logging_function);
+   stWeldCandidateMesh(sDecoded, dWeldTolerance, pStats);
+   return sDecoded;
+}
+/***stMeshTableCandidate**********************************************/
+
+/*!
+\brief Spreads the low 21 bits of a value to every third bit, for a Morton code
+*/
+INTERNAL A3DUns64 stMortonSpread(A3DUns64 uiValue)
+{
+   uiValue &= 0x1FFFFFULL;
+   uiValue = (uiValue | (uiValue << 32)) & 0x1F00000000FFFFULL;
+   uiValue = (uiValue | (uiValue << 16)) & 0x1F0000FF0000FFULL;
+   uiValue = (uiValue | (uiValue << 8)) & 0x100F00F00F00F00FULL;
+   uiValue = (uiValue | (uiValue << 4)) & 0x10C30C30C30C30C3ULL;
+   uiValue = (uiValue | (uiValue << 2)) & 0x1249249249249249ULL;
+   return uiValue;
+}
+/***stMortonSpread****************************************************/
+
+/*!
+\brief Measures the locality of the triangles of a mesh
+\param sMesh The mesh
+\param uiCacheSize The vertices of the FIFO cache
+\return The vertices the triangles fetch each through a FIFO cache of uiCacheSize vertices, from 1 for a long strip
+to 3 for triangles sharing no recent vertex
+*/
+INTERNAL double stVertexFetchesPerTriangle(const A3DBridgeMesh& sMesh,
+                                           size_t uiCacheSize)
+{
+   // A vertex is cached if it is one of the last uiCacheSize vertices fetched
+   std::vector<size_t> auiFetchedAt(stMeshCoordSize(sMesh) / 3, 0);
+   size_t uiFetches = 0;
+   const size_t uiTriangles = stMeshTriangleCount(sMesh);
+   const unsigned* puiIndices = stMeshIndices(sMesh);
+   for (size_t ui = 0; ui < 3 * uiTriangles; ui++)
+   {
+      const unsigned uiVertex = puiIndices[ui];
+      if (uiVertex < auiFetchedAt.size() && (!auiFetchedAt[uiVertex] || uiFetches + 1 - auiFetchedAt[uiVertex] > uiCacheSize))
+      {
+         auiFetchedAt[uiVertex] = ++uiFetches;
+      }
+   }
+   return uiTriangles == 0 ? 0. : (double)uiFetches / (double)uiTriangles;
+}
+/***stVertexFetchesPerTriangle****************************************/
+
+/*!
+\brief Reorders the triangles of a mesh so that neighbouring triangles, and the vertices they use, are close in memory
+The triangles are sorted along a Morton curve of their centroids in the bounding box of the vertices, ties keeping
+their order, and the vertices are numbered in the order the sorted triangles first use them, unused vertices last. Normal
+indices and triangle faces move with their triangles; the normals and the faces are unchanged.
+\param sMesh [in,out] The mesh
+\param pStats [in,out] If not NULL, receives the time of reordering
+\return false if the mesh has indices out of range, in which case it is unchanged
+*/
+INTERNAL bool stReorderMesh(A3DBridgeMesh& sMesh,
+                            A3DBridgeStats* pStats)
+{
+   (void)pStats;
+   A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_REORDER);
+   const size_t uiVertices = stMeshCoordSize(sMesh) / 3;
+   const size_t uiTriangles = stMeshTriangleCount(sMesh);
+   const double* pdCoords = stMeshCoords(sMesh);
+   const unsigned* puiIndices = stMeshIndices(sMesh);
+   const PTInt32* piNormalIndices = stMeshNormalIndices(sMesh);
+   const unsigned* puiFaces = stMeshTriangleFaces(sMesh);
+   double adMin[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL }, adMax[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+   for (size_t ui = 0; ui < 3 * uiTriangles; ui++)
+   {
+      if (puiIndices[ui] >= uiVertices)
+      {
+         return false;
+      }
+   }
+   for (size_t ui = 0; ui < 3 * uiVertices; ui += 3)
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         adMin[i] = std::min(adMin[i], pdCoords[ui + i]);
+         adMax[i] = std::max(adMax[i], pdCoords[ui + i]);
+      }
+   }
+
+   // The centroids are quantized to 21 bits per axis of the bounding box, or to 0 along a flat or non-finite axis
+   double adScale[3];
+   for (int i = 0; i < 3; i++)
+   {
+      double dExtent = adMax[i] - adMin[i];
+      adScale[i] = dExtent > 0. && dExtent < HUGE_VAL ? 2097151. / (3. * dExtent) : 0.;
+   }
+   std::vector<std::pair<A3DUns64, unsigned>> aOrder(uiTriangles);
+   for (size_t uiTriangle = 0; uiTriangle < uiTriangles; uiTriangle++)
+   {
+      const unsigned* puiCorners = puiIndices + 3 * uiTriangle;
+      A3DUns64 uiCode = 0;
+      for (int i = 0; i < 3; i++)
+      {
+         double dSum = pdCoords[3 * puiCorners[0] + i] + pdCoords[3 * puiCorners[1] + i] + pdCoords[3 * puiCorners[2] + i];
+         double dCell = (dSum - 3. * adMin[i]) * adScale[i];
+         uiCode |= stMortonSpread(dCell > 0. ? (A3DUns64)std::min(dCell, 2097151.) : 0) << i;
+      }
+      aOrder[uiTriangle] = std::make_pair(uiCode, (unsigned)uiTriangle);
+   }
+   // Least significant digit first, 16 bits at a time; a stable sort keeps ties in order
+   std::vector<std::pair<A3DUns64, unsigned>> aSorted(uiTriangles);
+   std::vector<size_t> auiStarts(65537);
+   for (int iShift = 0; iShift < 64; iShift += 16)
+   {
+      std::fill(auiStarts.begin(), auiStarts.end(), 0);
+      for (const std::pair<A3DUns64, unsigned>& order : aOrder)
+      {
+         auiStarts[((order.first >> iShift) & 0xFFFF) + 1]++;
+      }
+      if (auiStarts[((aOrder.empty() ? 0 : aOrder[0].first >> iShift) & 0xFFFF) + 1] == uiTriangles)
+      {
+         continue;
+      }
+      for (size_t ui = 1; ui < auiStarts.size(); ui++)
+      {
+         auiStarts[ui] += auiStarts[ui - 1];
+      }
+      for (const std::pair<A3DUns64, unsigned>& order : aOrder)
+      {
+         aSorted[auiStarts[(order.first >> iShift) & 0xFFFF]++] = order;
+      }
+      aOrder.swap(aSorted);
+   }
+
+   // Move the triangles, renumbering their vertices by first use
+   const unsigned uiNone = 0xFFFFFFFFu;
+   std::vector<unsigned> auiRemap(uiVertices, uiNone);
+   std::vector<unsigned> auiIndices(3 * uiTriangles);
+   std::vector<PTInt32> aiNormalIndices(3 * uiTriangles);
+   std::vector<unsigned> auiTriangleFaces(uiTriangles);
+   std::vector<double> adCoords(stMeshCoordSize(sMesh));
+   unsigned uiNext = 0;
+   for (size_t uiTriangle = 0; uiTriangle < uiTriangles; uiTriangle++)
+   {
+      const unsigned uiFrom = aOrder[uiTriangle].second;
+      for (int iCorner = 0; iCorner < 3; iCorner++)
+      {
+         unsigned uiVertex = puiIndices[3 * uiFrom + iCorner];
+         if (auiRemap[uiVertex] == uiNone)
+         {
+            std::copy_n(pdCoords + 3 * uiVertex, 3, &adCoords[3 * uiNext]);
+            auiRemap[uiVertex] = uiNext++;
+         }
+         auiIndices[3 * uiTriangle + iCorner] = auiRemap[uiVertex];
+      }
+      std::copy_n(piNormalIndices + 3 * uiFrom, 3, aiNormalIndices.begin() + 3 * uiTriangle);
+      auiTriangleFaces[uiTriangle] = puiFaces[uiFrom];
+   }
+   for (size_t uiVertex = 0; uiVertex < uiVertices; uiVertex++)
+   {
+      if (auiRemap[uiVertex] == uiNone)
+      {
+         std::copy_n(pdCoords + 3 * uiVertex, 3, &adCoords[3 * uiNext++]);
+      }
+   }
+
+   sMesh.m_auiIndices.swap(auiIndices);
+   sMesh.m_aiNormalIndices.swap(aiNormalIndices);
+   sMesh.m_auiTriangleFaces.swap(auiTriangleFaces);
+   sMesh.m_adCoords.swap(adCoords);
+   sMesh.m_puiBorrowedIndices = nullptr;
+   sMesh.m_piBorrowedNormalIndices = nullptr;
+   sMesh.m_puiBorrowedTriangleFaces = nullptr;
+   sMesh.m_pdBorrowedCoords = nullptr;
+   return true;
+}
+/***stReorderMesh*****************************************************/
+
+/*!
+\brief Reorders a mesh about to be built if A3DPolygonicaOptions::m_bReorderTriangles is set, it is large enough
+and its triangles are scattered
+\return The triangles reordered
+*/
+INTERNAL size_t stReorderDecodedMesh(A3DPolygonicaOptions* opts,
+                                     A3DBridgeMesh& sMesh)
+{
+   const size_t uiTriangles = stMeshTriangleCount(sMesh);
+   if (!opts->m_bReorderTriangles || uiTriangles < std::max<size_t>(1, opts->m_uiReorderMinTriangles))
+   {
+      return 0;
+   }
+   {
+      A3D_BRIDGE_TIME_PHASE(A3D_BRIDGE_STATS_OF(*opts), A3D_PHASE_REORDER);
+      if (stVertexFetchesPerTriangle(sMesh, 32) < opts->m_dReorderMinFetches)
+      {
+         return 0;
+      }
+   }
+   return stReorderMesh(sMesh, A3D_BRIDGE_STATS_OF(*opts)) ? uiTriangles : 0;
+}
+/***stReorderDecodedMesh**********************************************/
+
+/*!
+\brief Finds an item of the mesh table whose mesh is identical to the given one
+Each item with the same hash is compared in full, from its stMeshTableCandidate, so a hash collision never shares a solid.
+\param table The mesh table
+\param uiHash The stMeshHash of the mesh
+\param sMesh The mesh
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\param dWeldTolerance The tolerance the meshes are welded with, negative if they are not welded
+\param pStats [in,out] If not NULL, receives the time of decoding the candidates
+\return The item, or NULL if no item has an identical mesh
+*/
+INTERNAL const A3DRiRepresentationItem* stMeshTableFind(A3DBridgeMeshTable& table,
+                                                        A3DUns64 uiHash,
+                                                        const A3DBridgeMesh& sMesh,
+                                                        std::mutex* pExchangeMutex,
+                                                        double dWeldTolerance,
+                                                        A3DBridgeStats* pStats,
+                                                        A3D_log_func logging_function)
+{
+   auto range = table.m_items.equal_range(uiHash);
+   for (auto i = range.first; i != range.second; i++)
+   {
+      A3DBridgeMesh sDecoded;
+      const A3DBridgeMesh& sCandidate = stMeshTableCandidate(table, i->second, sDecoded, pExchangeMutex, dWeldTolerance, pStats,
+                                                             logging_function);
+      if (stMeshEqual(sCandidate, sMesh))
+      {
+         return i->second;
+      }
+      table.m_uiCollisions++;
+   }
+   return NULL;
+}
+/***stMeshTableFind***************************************************/
+
+/*!
+\brief Finds the frame of a decoded mesh
+The origin is the centroid of the vertices. The first axis points to the first vertex at least half as far from
+the centroid as the farthest one, and the second to the first vertex at least half as far from the first axis as
+the farthest one. Principal axes would be ambiguous for the many parts with a rotational symmetry, whereas
+vertices keep their order in a moved copy of a mesh.
+\param sMesh The mesh
+\param sPose [out] The frame
+\return false if the mesh has fewer than three vertices or all its vertices are collinear
+*/
+INTERNAL bool stMeshPose(const A3DBridgeMesh& sMesh,
+                         A3DBridgeMeshPose& sPose)
+{
+   const size_t uiVertices = stMeshCoordSize(sMesh) / 3;
+   const double* pdCoords = stMeshCoords(sMesh);
+   if (uiVertices < 3)
+   {
+      return false;
+   }
+
+   double* pdCentroid = sPose.m_adCentroid;
+   pdCentroid[0] = pdCentroid[1] = pdCentroid[2] = 0.;
+   for (size_t ui = 0; ui < uiVertices; ui++)
+   {
+      for (int k = 0; k < 3; k++)
+      {
+         pdCentroid[k] += pdCoords[3 * ui + k];
+      }
+   }
+   for (int k = 0; k < 3; k++)
+   {
+      pdCentroid[k] /= (double)uiVertices;
+   }
+
+   auto fnOffset = [&](size_t ui, double* pdOffset)
+   {
+      for (int k = 0; k < 3; k++)
+      {
+         pdOffset[k] = pdCoords[3 * ui + k] - pdCentroid[k];
+      }
+      return pdOffset[0] * pdOffset[0] + pdOffset[1] * pdOffset[1] + pdOffset[2] * pdOffset[2];
+   };
+
+   double* pdX = sPose.m_adRotation;
+   double* pdY = sPose.m_adRotation + 3;
+   double* pdZ = sPose.m_adRotation + 6;
+   double adOffset[3];
+
+   double dMax = 0.;
+   for (size_t ui = 0; ui < uiVertices; ui++)
+   {
+      dMax = std::max(dMax, fnOffset(ui, adOffset));
+   }
+   if (dMax == 0.)
+   {
+      return false;
+   }
+   for (size_t ui = 0; ui < uiVertices; ui++)
+   {
+      double dSquare = fnOffset(ui, adOffset);
+      if (dSquare >= 0.25 * dMax)
+      {
+         for (int k = 0; k < 3; k++)
+         {
+            pdX[k] = adOffset[k] / std::sqrt(dSquare);
+         }
+         break;
+      }
+   }
+
+   // The offsets from the first axis
+   auto fnAcross = [&](size_t ui, double* pdAcross)
+   {
+      fnOffset(ui, pdAcross);
+      double dAlong = pdAcross[0] * pdX[0] + pdAcross[1] * pdX[1] + pdAcross[2] * pdX[2];
+      for (int k = 0; k < 3; k++)
+      {
+         pdAcross[k] -= dAlong * pdX[k];
+      }
+      return pdAcross[0] * pdAcross[0] + pdAcross[1] * pdAcross[1] + pdAcross[2] * pdAcross[2];
+   };
+
+   double dMaxAcross = 0.;
+   for (size_t ui = 0; ui < uiVertices; ui++)
+   {
+      dMaxAcross = std::max(dMaxAcross, fnAcross(ui, adOffset));
+   }
+   if (dMaxAcross <= 1e-18 * dMax)
+   {
+      return false;
+   }
+   for (size_t ui = 0; ui < uiVertices; ui++)
+   {
+      double dSquare = fnAcross(ui, adOffset);
+      if (dSquare >= 0.25 * dMaxAcross)
+      {
+         for (int k = 0; k < 3; k++)
+         {
+            pdY[k] = adOffset[k] / std::sqrt(dSquare);
+         }
+         break;
+      }
+   }
+
+   pdZ[0] = pdX[1] * pdY[2] - pdX[2] * pdY[1];
+   pdZ[1] = pdX[2] * pdY[0] - pdX[0] * pdY[2];
+   pdZ[2] = pdX[0] * pdY[1] - pdX[1] * pdY[0];
+
+   sPose.m_dRadius = std::sqrt(dMax);
+   return true;
+}
+/***stMeshPose********************************************************/
+
+/*!
+\brief Hashes what a rigid motion keeps of a decoded mesh: its connectivity and its radius to about 1e-4
+*/
+INTERNAL A3DUns64 stMeshPoseHash(const A3DBridgeMesh& sMesh,
+                                 const A3DBridgeMeshPose& sPose)
+{
+   A3DUns64 uiHash = stMeshConnectivityHash(sMesh);
+   long long iRadius = std::llround(1e4 * std::log(sPose.m_dRadius));
+   stHashBytes(uiHash, &iRadius, sizeof(iRadius));
+   return uiHash;
+}
+/***stMeshPoseHash****************************************************/
+
+/*!
+\brief Returns true if two decoded meshes have the same connectivity and the same vertices and normals in their frames
+Vertices may differ by A3D_BRIDGE_CONGRUENCE_TOLERANCE times the radius, and normals by A3D_BRIDGE_CONGRUENCE_TOLERANCE.
+*/
+INTERNAL bool stMeshPoseEqual(const A3DBridgeMesh& sMesh1,
+                              const A3DBridgeMeshPose& sPose1,
+                              const A3DBridgeMesh& sMesh2,
+                              const A3DBridgeMeshPose& sPose2)
+{
+   const size_t uiTriangles = stMeshTriangleCount(sMesh1);
+   if (sMesh1.m_uiFaceCount != sMesh2.m_uiFaceCount ||
+       uiTriangles != stMeshTriangleCount(sMesh2) ||
+       !std::equal(stMeshIndices(sMesh1), stMeshIndices(sMesh1) + 3 * uiTriangles, stMeshIndices(sMesh2)) ||
+       !std::equal(stMeshNormalIndices(sMesh1), stMeshNormalIndices(sMesh1) + 3 * uiTriangles, stMeshNormalIndices(sMesh2)) ||
+       !std::equal(stMeshTriangleFaces(sMesh1), stMeshTriangleFaces(sMesh1) + uiTriangles, stMeshTriangleFaces(sMesh2)) ||
+       stMeshCoordSize(sMesh1) != stMeshCoordSize(sMesh2) ||
+       stMeshNormalSize(sMesh1) != stMeshNormalSize(sMesh2))
+   {
+      return false;
+   }
+
+   // Compares a vector of each mesh in its frame; bCentre for points rather than directions
+   auto fnSame = [&](const double* pd1, const double* pd2, bool bCentre, double dTolerance)
+   {
+      double ad1[3], ad2[3];
+      for (int k = 0; k < 3; k++)
+      {
+         ad1[k] = bCentre ? pd1[k] - sPose1.m_adCentroid[k] : pd1[k];
+         ad2[k] = bCentre ? pd2[k] - sPose2.m_adCentroid[k] : pd2[k];
+      }
+      for (int iAxis = 0; iAxis < 3; iAxis++)
+      {
+         const double* pdAxis1 = sPose1.m_adRotation + 3 * iAxis;
+         const double* pdAxis2 = sPose2.m_adRotation + 3 * iAxis;
+         double dCanonical1 = ad1[0] * pdAxis1[0] + ad1[1] * pdAxis1[1] + ad1[2] * pdAxis1[2];
+         double dCanonical2 = ad2[0] * pdAxis2[0] + ad2[1] * pdAxis2[1] + ad2[2] * pdAxis2[2];
+         if (!(std::fabs(dCanonical1 - dCanonical2) <= dTolerance))
+         {
+            return false;
+         }
+      }
+      return true;
+   };
+
+   const double dTolerance = A3D_BRIDGE_CONGRUENCE_TOLERANCE * std::max(sPose1.m_dRadius, sPose2.m_dRadius);
+   for (size_t ui = 0; ui < stMeshCoordSize(sMesh1); ui += 3)
+   {
+      if (!fnSame(stMeshCoords(sMesh1) + ui, stMeshCoords(sMesh2) + ui, true, dTolerance))
+      {
+         return false;
+      }
+   }
+   for (size_t ui = 0; ui < stMeshNormalSize(sMesh1); ui += 3)
+   {
+      if (!fnSame(stMeshNormals(sMesh1) + ui, stMeshNormals(sMesh2) + ui, false, A3D_BRIDGE_CONGRUENCE_TOLERANCE))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+/***stMeshPoseEqual***************************************************/
+
+/*!
+\brief Finds an item of the mesh table whose mesh is congruent to the given one
+Each item with the same hash is compared with stMeshPoseEqual, from its stMeshTableCandidate.
+\param table The mesh table
+\param uiHash The stMeshPoseHash of the mesh
+\param sMesh The mesh
+\param sPose The frame of the mesh
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\param dWeldTolerance The tolerance the meshes are welded with, negative if they are not welded
+\param pStats [in,out] If not NULL, receives the time of decoding the candidates
+\param transform [out] The rigid motion from the coordinates of the item found to those of the mesh
+\param bIdentical [out] True if the meshes are identical, the motion being the identity
+\return The item, or NULL if no item has a congruent mesh
+*/
+INTERNAL const A3DRiRepresentationItem* stMeshTableFindCongruent(A3DBridgeMeshTable& table,
+                                                                 A3DUns64 uiHash,
+                                                                 const A3DBridgeMesh& sMesh,
+                                                                 const A3DBridgeMeshPose& sPose,
+                                                                 std::mutex* pExchangeMutex,
+                                                                 double dWeldTolerance,
+                                                                 A3DBridgeStats* pStats,
+                                                                 PTTransformMatrix& transform,
+                                                                 bool& bIdentical,
+                                                                 A3D_log_func logging_function)
+{
+   auto range = table.m_congruentItems.equal_range(uiHash);
+   for (auto i = range.first; i != range.second; i++)
+   {
+      A3DBridgeMesh sDecoded;
+      A3DBridgeMeshPose sCandidatePose;
+      const A3DBridgeMesh& sCandidate = stMeshTableCandidate(table, i->second, sDecoded, pExchangeMutex, dWeldTolerance, pStats,
+                                                             logging_function);
+      if (!stMeshPose(sCandidate, sCandidatePose) || !stMeshPoseEqual(sCandidate, sCandidatePose, sMesh, sPose))
+      {
+         table.m_uiCollisions++;
+         continue;
+      }
+
+      bIdentical = stMeshEqual(sCandidate, sMesh);
+
+      // Into the frame of the candidate, then out of the frame of the mesh: R * transpose(Rc) and c - R * transpose(Rc) * cc
+      const double* pdRotation = sPose.m_adRotation;
+      const double* pdCandidateRotation = sCandidatePose.m_adRotation;
+      for (int iCol = 0; iCol < 3; iCol++)
+      {
+         for (int iRow = 0; iRow < 3; iRow++)
+         {
+            transform[iCol][iRow] = pdRotation[iRow] * pdCandidateRotation[iCol] +
+                                    pdRotation[3 + iRow] * pdCandidateRotation[3 + iCol] +
+                                    pdRotation[6 + iRow] * pdCandidateRotation[6 + iCol];
+         }
+         transform[iCol][3] = 0.;
+      }
+      for (int iRow = 0; iRow < 3; iRow++)
+      {
+         transform[3][iRow] = sPose.m_adCentroid[iRow] - (transform[0][iRow] * sCandidatePose.m_adCentroid[0] +
+                                                          transform[1][iRow] * sCandidatePose.m_adCentroid[1] +
+                                                          transform[2][iRow] * sCandidatePose.m_adCentroid[2]);
+      }
+      transform[3][3] = 1.;
+      return i->second;
+   }
+   return NULL;
+}
+/***stMeshTableFindCongruent******************************************/
+
+/*!
+\brief Computes the keys of a decoded mesh that the options need in the mesh table
+*/
+INTERNAL void stMeshKeys(const A3DPolygonicaOptions* opts,
+                         const A3DBridgeMesh& sMesh,
+                         A3DBridgeMeshKeys& sKeys)
+{
+   if (opts->m_bShareIdenticalMeshes)
+   {
+      sKeys.m_uiHash = stMeshHash(sMesh);
+   }
+   if (opts->m_bShareCongruentMeshes)
+   {
+      sKeys.m_bPose = stMeshPose(sMesh, sKeys.m_sPose);
+      if (sKeys.m_bPose)
+      {
+         sKeys.m_uiPoseHash = stMeshPoseHash(sMesh, sKeys.m_sPose);
+      }
+   }
+}
+/***stMeshKeys********************************************************/
+
+/*!
+\brief Finds an earlier item whose PTSolid a representation item can share, or else adds the item to the mesh table
+A congruent item gets its rigid motion in m_part_transforms.
+\param opts [in,out] Options
+\param ri The representation item
+\param sMesh Its decoded mesh
+\param sKeys The stMeshKeys of the mesh
+\param pExchangeMutex [in] If not NULL, held around every Exchange call
+\return The earlier item, or NULL if the item needs its own PTSolid
+*/
+INTERNAL const A3DRiRepresentationItem* stMeshTableShare(A3DPolygonicaOptions* opts,
+                                                         const A3DRiRepresentationItem* ri,
+                                                         const A3DBridgeMesh& sMesh,
+                                                         const A3DBridgeMeshKeys& sKeys,
+                                                         std::mutex* pExchangeMutex,
+                                                         A3D_log_func logging_function)
+{
+   A3DBridgeMeshTable& table = opts->m_mesh_table;
+   // The earlier items of an earlier conversion are decoded again, so they are welded again like the mesh
+   const double dWeldTolerance = opts->m_bWeldVertices ? opts->m_dWeldTolerance : -1.;
+
+   if (opts->m_bShareIdenticalMeshes)
+   {
+      const A3DRiRepresentationItem* pSame = stMeshTableFind(table, sKeys.m_uiHash, sMesh, pExchangeMutex,
+                                                             dWeldTolerance, A3D_BRIDGE_STATS_OF(*opts), logging_function);
+      if (pSame)
+      {
+         table.m_uiSharedItems++;
+         table.m_uiSharedBytes += stMeshBytes(sMesh);
+         return pSame;
+      }
+   }
+
+   if (sKeys.m_bPose)
+   {
+      PTTransformMatrix transform;
+      bool bIdentical = false;
+      const A3DRiRepresentationItem* pSame = stMeshTableFindCongruent(table, sKeys.m_uiPoseHash, sMesh, sKeys.m_sPose,
+                                                                      pExchangeMutex, dWeldTolerance,
+                                                                      A3D_BRIDGE_STATS_OF(*opts), transform, bIdentical,
+                                                                      logging_function);
+      if (pSame)
+      {
+         if (bIdentical)
+         {
+            table.m_uiSharedItems++;
          }
          else
          {
-            PFEntityGroupAddEntity((*groups)[uFaceTopoFace], face);
+            table.m_uiCongruentItems++;
+            memcpy(opts->m_part_transforms[ri].data(), transform, 16 * sizeof(double));
+         }
+         table.m_uiSharedBytes += stMeshBytes(sMesh);
+         return pSame;
+      }
+   }
+
+   if (opts->m_bShareIdenticalMeshes)
+   {
+      table.m_items.insert(std::make_pair(sKeys.m_uiHash, ri));
+   }
+   if (sKeys.m_bPose)
+   {
+      table.m_congruentItems.insert(std::make_pair(sKeys.m_uiPoseHash, ri));
+   }
+   stMeshTableKeep(table, ri, sMesh);
+   return NULL;
+}
+/***stMeshTableShare**************************************************/
+
+/*!
+\brief Creates a PTSolid and its surface groups from a decoded mesh
+\param sMesh The decoded mesh
+\param environment The Polygonica environment
+\param iTopoFaceBase The app surface id of the first face of the mesh
+\param solid [out] The resultant polygonica solid, PV_ENTITY_NULL on failure
+\param bLazyGroups If true the groups are left PV_ENTITY_NULL for A3DBridgeGetSurfaceGroup to create
+\param ppGroups [out] One PTEntityGroup per face of the mesh, NULL if the solid or groups could not be built
+\param pStats [in,out] If not NULL, receives the time of building the solid and the groups, and their counts
+\return A3D_SUCCESS - Operation succeeded
+  A3D_LOAD_INVALID_FILE_FORMAT - A face of the solid did not map back to a face of the mesh
+*/
+INTERNAL int stCreatePTSolidFromMesh(const A3DBridgeMesh& sMesh,
+                                     PTEnvironment environment,
+                                     long iTopoFaceBase,
+                                     bool bLazyGroups,
+                                     PTSolid* solid,
+                                     std::vector<PTEntityGroup>** ppGroups,
+                                     A3DBridgeStats* pStats,
+                                     A3D_log_func logging_function)
+{
+   (void)pStats;
+   A3DStatus iRet = A3D_SUCCESS;
+   PTStatus status = PV_STATUS_OK;
+   unsigned uFaceSize = sMesh.m_uiFaceCount;
+
+   *solid = PV_ENTITY_NULL;
+   *ppGroups = NULL;
+
+   const unsigned* puiTriangleFaces = stMeshTriangleFaces(sMesh);
+   std::vector<PTPointer> faceAppSurface(stMeshTriangleCount(sMesh));
+   for (size_t ui = 0; ui < faceAppSurface.size(); ui++)
+   {
+      faceAppSurface[ui] = (PTPointer)(PTNat64)(iTopoFaceBase + puiTriangleFaces[ui]);
+   }
+
+   PTMeshSolidOpts meshOpts;
+   PMInitMeshSolidOpts(&meshOpts);
+
+   meshOpts.normals = (PTVector*)stMeshNormals(sMesh);
+   meshOpts.normal_indices = (PTInt32*)stMeshNormalIndices(sMesh);
+
+   meshOpts.app_surfaces = (PTPointer*)faceAppSurface.data();
+
+   {
+      A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_SOLIDS);
+      status = PFSolidCreateFromMesh(environment,
+                                     (PTNat32)faceAppSurface.size(),    // Total number of triangles
+                                     NULL,                              // No internal loops
+                                     NULL,                              // All faces are triangles
+                                     (PTNat32*)stMeshIndices(sMesh),     // Indices into vertex array
+                                     (PTDouble*)stMeshCoords(sMesh),  // Pointer to vertex array
+                                     &meshOpts,
+                                     solid);                            // Resultant PG solid
+   }
+
+   // TODO: Should a failure here set iRet to a failure status?
+   CHECK_PTSTATUS(status, logging_function, "A3DRiRepresentationItemCreatePTSolid - PFSolidCreateFromMesh");
+
+   if (status != PV_STATUS_OK)
+   {
+      *solid = PV_ENTITY_NULL;
+      return iRet;
+   }
+   A3D_BRIDGE_COUNT(pStats, m_uiSolids, 1);
+   A3D_BRIDGE_COUNT(pStats, m_uiTriangles, faceAppSurface.size());
+
+   if (bLazyGroups)
+   {
+      *ppGroups = new std::vector<PTEntityGroup>(uFaceSize, (PTEntityGroup)PV_ENTITY_NULL);
+      return iRet;
+   }
+
+   A3D_BRIDGE_TIME_PHASE(pStats, A3D_PHASE_GROUPS);
+   A3D_BRIDGE_COUNT(pStats, m_uiGroups, uFaceSize);
+
+   // Create a vector of PTEntityGroups containing faces on each topoFace
+   std::vector <PTEntityGroup>* groups = new std::vector<PTEntityGroup>;
+   for (int topoFace = 0; topoFace < (int)uFaceSize; topoFace++)
+   {
+      PTEntityGroup group;
+      status = PFEntityGroupCreate(environment, &group);
+      groups->push_back(group);
+   }
+
+   // Add each face to a surface (topoFace) group
+   PTEntityList faces = PV_ENTITY_NULL;
+   PFEntityCreateEntityList(*solid, PV_ENTITY_TYPE_FACE, NULL, &faces);
+   long max_groups = (long)groups->size();
+   for (PTEntity face = PFEntityListGetFirst(faces); face != PV_ENTITY_NULL; face = PFEntityListGetNext(faces, face))
+   {
+      // unsigned long long used to remove compiler warning. 
+      auto app_surface_index = (long long)PFEntityGetPointerProperty(face, PV_FACE_PROP_APP_SURFACE);
+      long uFaceTopoFace = (long)(app_surface_index - iTopoFaceBase);
+      if ((uFaceTopoFace < 0) || (uFaceTopoFace >= max_groups))
+      {
+         // Invalid app surface value
+         log(logging_function, "Invalid AppSurface retrieved from PTFace", A3D_log_level::A3D_LOG_ERROR);
+         // Delete all groups rather than pass on invalid data
+         // NULL group will be added to opts for this solid
+         for (int topoFace = 0; topoFace < (int)uFaceSize; topoFace++)
+         {
+            PFEntityGroupDestroy((*groups)[topoFace]);
+         }
+         delete groups;
+         groups = NULL;
+         // Set a failure return code
+         iRet = A3D_LOAD_INVALID_FILE_FORMAT;
+         break;
+      }
+      else
+      {
+         PFEntityGroupAddEntity((*groups)[uFaceTopoFace], face);
+      }
+   }
+   PFEntityListDestroy(faces, 0);
+
+   *ppGroups = groups;
+   return iRet;
+}
+/***stCreatePTSolidFromMesh*******************************************/
+
+/*!
+\brief Records the CAD surfaces of a solid in m_topo_faces
+\param solid The solid, PV_ENTITY_NULL if it could not be built
+\param iTopoFaceBase The app surface id of its first CAD surface
+\param uFaceCount The number of CAD surfaces
+*/
+INTERNAL void stRecordTopoFaces(A3DPolygonicaOptions* opts,
+                                PTSolid solid,
+                                long iTopoFaceBase,
+                                unsigned uFaceCount)
+{
+   if (opts->m_topo_faces.size() < (size_t)(iTopoFaceBase + uFaceCount))
+   {
+      opts->m_topo_faces.resize(iTopoFaceBase + uFaceCount);
+   }
+   for (unsigned uTopoFace = 0; uTopoFace < uFaceCount; uTopoFace++)
+   {
+      A3DBridgeTopoFace& sTopoFace = opts->m_topo_faces[iTopoFaceBase + uTopoFace];
+      sTopoFace.m_solid = solid;
+      sTopoFace.m_iTopoFace = uTopoFace;
+   }
+}
+/***stRecordTopoFaces*************************************************/
+
+/*!
+\brief Creates a PTSolid and optional mapper from the provided representation item.
+The faces of the solid take the app surface ids opts->m_iTopoFaceCount onwards, and the count
+advances by the number of faces of the item even if Polygonica fails to build the solid.
+\param ri The representation item to create a PTSolid from. Must be an A3DRiPolyBrep or A3DRiBrepModel
+\param solid [out] solid The resultant polgonica solid
+\param opts [in] Options
+With m_bShareIdenticalMeshes or m_bShareCongruentMeshes, an item whose decoded tessellation is identical or
+congruent to that of an item of m_parts gets the PTSolid of that item and takes no app surface ids.
+\return A3D_SUCCESS - Operation succeeded
+  A3D_PG_NOT_INITIALIZED - Polygonica was not unlocked or initialized correctly
+  A3D_PG_INVALID_RI - Representation item is unsupported type
+  A3D_PG_ERROR - Internal polygonica error
+*/
+INTERNAL int A3DRiRepresentationItemCreatePTSolid(const A3DRiRepresentationItem* ri,
+                                                  PTSolid* solid, 
+                                                  A3DPolygonicaOptions* opts, 
+                                                  A3D_log_func logging_function = nullptr)
+{
+   A3DEEntityType eType;
+   CHECK_A3DSTATUS(A3DEntityGetType(ri, &eType), logging_function, "A3DRiRepresentationItemCreatePTSolid - failed to get type of representation item");
+   if (eType != A3DEEntityType::kA3DTypeRiBrepModel && eType != A3DEEntityType::kA3DTypeRiPolyBrepModel) return A3D_PG_INVALID_RI;
+
+   A3DBridgeTraceSpan sSpan(opts->m_pTracer, "solid", "A3DRiRepresentationItemCreatePTSolid");
+   if (sSpan.IsRecording())
+   {
+      std::string sName;
+      stGetName(ri, sName, logging_function);
+      if (!sName.empty())
+      {
+         sSpan.m_sEvent.m_sName += " " + sName;
+      }
+   }
+
+   A3DBridgeMesh sMesh;
+   size_t uiCacheItem = opts->m_pMeshCache ? opts->m_pMeshCache->m_uiNextItem++ : 0;
+   if (!stMeshCacheRead(opts->m_pMeshCache, uiCacheItem, ri, sMesh, NULL, A3D_BRIDGE_STATS_OF(*opts), logging_function))
+   {
+      // The mesh only lives until its solid is built, so it borrows the coordinates and normals of Exchange
+      stDecodeRepresentationItem(ri, sMesh, NULL, A3D_BRIDGE_STATS_OF(*opts), logging_function, NULL, 0, true);
+      stMeshCacheWrite(opts->m_pMeshCache, uiCacheItem, sMesh);
+   }
+   A3D_BRIDGE_COUNT(A3D_BRIDGE_STATS_OF(*opts), m_uiMeshBytes, stMeshBytes(sMesh));
+   size_t auiWeldCounts[3] = { 0, 0, 0 };
+   stWeldDecodedMesh(opts, sMesh, auiWeldCounts);
+   opts->m_uiVerticesBeforeWelding += auiWeldCounts[0];
+   opts->m_uiVerticesAfterWelding += auiWeldCounts[1];
+   opts->m_uiWeldDegenerateTriangles += auiWeldCounts[2];
+
+   if (opts->m_bShareIdenticalMeshes || opts->m_bShareCongruentMeshes)
+   {
+      A3DBridgeMeshKeys sKeys;
+      stMeshKeys(opts, sMesh, sKeys);
+      const A3DRiRepresentationItem* pSame = stMeshTableShare(opts, ri, sMesh, sKeys, NULL, logging_function);
+      if (pSame)
+      {
+         stReleaseMeshTessellation(sMesh, A3D_BRIDGE_STATS_OF(*opts));
+         *solid = opts->m_parts[pSame];
+         return A3D_SUCCESS;
+      }
+   }
+
+   // Only once the mesh table is done with the mesh, as congruent meshes are matched in the order of their vertices
+   opts->m_uiReorderedTriangles += stReorderDecodedMesh(opts, sMesh);
+
+   std::vector<PTEntityGroup>* groups = NULL;
+   int iRet = stCreatePTSolidFromMesh(sMesh, opts->m_Environment, opts->m_iTopoFaceCount, opts->m_bLazySurfaceGroups,
+                                      solid, &groups, A3D_BRIDGE_STATS_OF(*opts), logging_function);
+   stReleaseMeshTessellation(sMesh, A3D_BRIDGE_STATS_OF(*opts));
+
+   if (*solid != PV_ENTITY_NULL)
+   {
+      sSpan.AddTriangles(stMeshTriangleCount(sMesh));
+      // Add a solid / group vector pair to the output map m_surface_groups
+      opts->m_surface_groups.insert(std::make_pair(*solid, groups));
+      opts->m_topo_face_base.insert(std::make_pair(*solid, opts->m_iTopoFaceCount));
+   }
+   stRecordTopoFaces(opts, *solid, opts->m_iTopoFaceCount, sMesh.m_uiFaceCount);
+   opts->m_iTopoFaceCount += sMesh.m_uiFaceCount;
+
+   return iRet;
+}
+/***A3DRiRepresentationItemCreatePTSolid******************************/
+
+/*!
+\brief Creates the PTSolids of many representation items on a thread pool.
+Items are decoded and built in batches; in a batch of fewer items than threads, the faces of each large item are
+decoded across the pool. The app surface ids are handed out in the order of
+the items, so m_parts, m_surface_groups, m_topo_face_base, m_topo_faces, m_iTopoFaceCount and m_mesh_table
+match calling A3DRiRepresentationItemCreatePTSolid on each item in turn.
+\param apItems The representation items. Must be A3DRiPolyBrep or A3DRiBrepModel
+\param sPool The thread pool
+\param opts [in,out] Options. m_parts, m_surface_groups, m_topo_face_base and m_topo_faces receive the solids
+\param fnBatchDone If set, called on the calling thread with the count of items built after each batch
+\return A3D_SUCCESS - Operation succeeded
+*/
+INTERNAL int stCreatePTSolidsParallel(const std::vector<const A3DRiRepresentationItem*>& apItems,
+                                      A3DBridgeThreadPool& sPool,
+                                      A3DPolygonicaOptions* opts,
+                                      A3D_log_func logging_function,
+                                      const std::function<void(size_t)>& fnBatchDone = nullptr)
+{
+   // Exchange is only entered by one thread at a time
+   std::mutex sExchangeMutex;
+   const size_t uiBatchSize = std::max<size_t>(1, opts->m_uiParallelBatchSize);
+   // The items are numbered in the mesh cache in the order of apItems
+   const size_t uiCacheBase = opts->m_pMeshCache ? opts->m_pMeshCache->m_uiNextItem : 0;
+   const bool bCacheWriting = opts->m_pMeshCache && opts->m_pMeshCache->m_pFile;
+
+   std::vector<A3DBridgeMesh> asMeshes;
+   std::vector<A3DBridgeMeshKeys> asKeys;
+   std::vector<const A3DRiRepresentationItem*> apSameItems;
+   std::vector<long> aiTopoFaceBase;
+   std::vector<unsigned> aFaceCounts;
+   std::vector<PTSolid> aSolids;
+   std::vector<std::vector<PTEntityGroup>*> aGroups;
+   std::vector<std::array<size_t, 3>> aWeldCounts;
+   std::atomic<size_t> uiReordered{ 0 };
+
+   for (size_t uiFirst = 0; uiFirst < apItems.size(); uiFirst += uiBatchSize)
+   {
+      const size_t uiCount = std::min(uiBatchSize, apItems.size() - uiFirst);
+      asMeshes.assign(uiCount, A3DBridgeMesh());
+      aSolids.assign(uiCount, PV_ENTITY_NULL);
+      aGroups.assign(uiCount, NULL);
+      asKeys.assign(uiCount, A3DBridgeMeshKeys());
+      apSameItems.assign(uiCount, NULL);
+
+      // The mesh cache keeps the meshes as decoded, so when it is written they are welded once it has them
+      auto fnPrepare = [&](size_t ui)
+      {
+         stWeldDecodedMesh(opts, asMeshes[ui], aWeldCounts[ui].data());
+         stMeshKeys(opts, asMeshes[ui], asKeys[ui]);
+      };
+      aWeldCounts.assign(uiCount, std::array<size_t, 3>());
+      auto fnDecode = [&](size_t ui, A3DBridgeThreadPool* pItemPool)
+      {
+         A3DBridgeTraceSpan sSpan(opts->m_pTracer, "decode", "stDecodeRepresentationItem");
+         if (!stMeshCacheRead(opts->m_pMeshCache, uiCacheBase + uiFirst + ui, apItems[uiFirst + ui], asMeshes[ui],
+                              &sExchangeMutex, A3D_BRIDGE_STATS_OF(*opts), logging_function))
+         {
+            stDecodeRepresentationItem(apItems[uiFirst + ui], asMeshes[ui], &sExchangeMutex, A3D_BRIDGE_STATS_OF(*opts),
+                                       logging_function, pItemPool, opts->m_uiParallelDecodeMinTriangles);
+         }
+         A3D_BRIDGE_COUNT(A3D_BRIDGE_STATS_OF(*opts), m_uiMeshBytes, stMeshBytes(asMeshes[ui]));
+      };
+
+      // Too few items to keep every thread busy: they are decoded in turn, each splitting its faces across the pool
+      const bool bSplitItems = uiCount < sPool.GetThreadCount();
+      if (bSplitItems)
+      {
+         for (size_t ui = 0; ui < uiCount; ui++)
+         {
+            fnDecode(ui, &sPool);
+         }
+      }
+      else
+      {
+         sPool.ParallelFor(uiCount, [&](size_t ui)
+         {
+            fnDecode(ui, nullptr);
+            if (!bCacheWriting)
+            {
+               fnPrepare(ui);
+            }
+         });
+      }
+      if (bCacheWriting)
+      {
+         for (size_t ui = 0; ui < uiCount; ui++)
+         {
+            stMeshCacheWrite(opts->m_pMeshCache, uiCacheBase + uiFirst + ui, asMeshes[ui]);
+         }
+      }
+      if (bCacheWriting || bSplitItems)
+      {
+         sPool.ParallelFor(uiCount, fnPrepare);
+      }
+      for (const std::array<size_t, 3>& auiCounts : aWeldCounts)
+      {
+         opts->m_uiVerticesBeforeWelding += auiCounts[0];
+         opts->m_uiVerticesAfterWelding += auiCounts[1];
+         opts->m_uiWeldDegenerateTriangles += auiCounts[2];
+      }
+
+      // Hand out the app surface ids in item order; an item sharing the solid of an earlier one takes none
+      aiTopoFaceBase.resize(uiCount);
+      for (size_t ui = 0; ui < uiCount; ui++)
+      {
+         if (opts->m_bShareIdenticalMeshes || opts->m_bShareCongruentMeshes)
+         {
+            apSameItems[ui] = stMeshTableShare(opts, apItems[uiFirst + ui], asMeshes[ui], asKeys[ui],
+                                               &sExchangeMutex, logging_function);
+            if (apSameItems[ui])
+            {
+               asMeshes[ui] = A3DBridgeMesh();
+               continue;
+            }
+         }
+         aiTopoFaceBase[ui] = opts->m_iTopoFaceCount;
+         opts->m_iTopoFaceCount += asMeshes[ui].m_uiFaceCount;
+      }
+
+      aFaceCounts.resize(uiCount);
+      sPool.ParallelFor(uiCount, [&](size_t ui)
+      {
+         if (apSameItems[ui])
+         {
+            return;
+         }
+         A3DBridgeTraceSpan sSpan(opts->m_pTracer, "solid", "stCreatePTSolidFromMesh");
+         uiReordered += stReorderDecodedMesh(opts, asMeshes[ui]);
+         stCreatePTSolidFromMesh(asMeshes[ui], opts->m_Environment, aiTopoFaceBase[ui], opts->m_bLazySurfaceGroups,
+                                 &aSolids[ui], &aGroups[ui], A3D_BRIDGE_STATS_OF(*opts), logging_function);
+         if (aSolids[ui] != PV_ENTITY_NULL)
+         {
+            sSpan.AddTriangles(stMeshTriangleCount(asMeshes[ui]));
+         }
+         // Free the mesh as soon as Polygonica owns a copy
+         aFaceCounts[ui] = asMeshes[ui].m_uiFaceCount;
+         asMeshes[ui] = A3DBridgeMesh();
+      });
+
+      for (size_t ui = 0; ui < uiCount; ui++)
+      {
+         if (apSameItems[ui])
+         {
+            // The earlier item precedes it in apItems, so its solid is already in m_parts
+            opts->m_parts[apItems[uiFirst + ui]] = opts->m_parts[apSameItems[ui]];
+            continue;
+         }
+         stRecordTopoFaces(opts, aSolids[ui], aiTopoFaceBase[ui], aFaceCounts[ui]);
+         opts->m_parts[apItems[uiFirst + ui]] = aSolids[ui];
+         if (aSolids[ui] != PV_ENTITY_NULL)
+         {
+            opts->m_surface_groups.insert(std::make_pair(aSolids[ui], aGroups[ui]));
+            opts->m_topo_face_base.insert(std::make_pair(aSolids[ui], aiTopoFaceBase[ui]));
+         }
+      }
+      if (fnBatchDone)
+      {
+         fnBatchDone(uiFirst + uiCount);
+      }
+   }
+
+   if (opts->m_pMeshCache)
+   {
+      opts->m_pMeshCache->m_uiNextItem += apItems.size();
+   }
+   opts->m_uiReorderedTriangles += uiReordered;
+   return A3D_SUCCESS;
+}
+/***stCreatePTSolidsParallel******************************************/
+
+/*!
+\brief Pushes a node to visit; it inherits the current top of the path, transform and attribute stacks
+*/
+INTERNAL void stTraversalPush(A3DBridgeTraversal& sTraversal,
+                              A3DBridgeTraversalFrame::Kind eKind,
+                              const A3DEntity* pNode)
+{
+   A3DBridgeTraversalFrame sFrame;
+   sFrame.m_eKind = eKind;
+   sFrame.m_pNode = pNode;
+   sFrame.m_uiPathSize = sTraversal.m_pathIds.size();
+   sFrame.m_uiTransform = sTraversal.m_transforms.size() / 16 - 1;
+   sFrame.m_uiAttributes = sTraversal.m_attributes.size();
+   sTraversal.m_frames.push_back(sFrame);
+}
+/***stTraversalPush***************************************************/
+
+/*!
+\brief Pushes product occurrences to visit in their order, or from the highest pgOpts.m_pPriority
+*/
+INTERNAL void stTraversalPushOccurrences(A3DBridgeTraversal& sTraversal,
+                                         const A3DPolygonicaOptions& pgOpts,
+                                         A3DAsmProductOccurrence* const* ppOccurrences,
+                                         A3DUns32 uiSize)
+{
+   // The last frame pushed is visited first
+   if (!pgOpts.m_pPriority || uiSize < 2)
+   {
+      for (A3DUns32 ui = uiSize; ui-- > 0;)
+      {
+         stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kProductOccurrence, ppOccurrences[ui]);
+      }
+      return;
+   }
+
+   std::vector<std::pair<double, A3DUns32>> aPriorities(uiSize);
+   for (A3DUns32 ui = 0; ui < uiSize; ui++)
+   {
+      aPriorities[ui] = std::make_pair(pgOpts.m_pPriority(ppOccurrences[ui], pgOpts.m_pPriorityData), ui);
+   }
+   std::stable_sort(aPriorities.begin(), aPriorities.end(),
+                    [](const std::pair<double, A3DUns32>& a, const std::pair<double, A3DUns32>& b) { return a.first > b.first; });
+   for (A3DUns32 ui = uiSize; ui-- > 0;)
+   {
+      stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kProductOccurrence, ppOccurrences[aPriorities[ui].second]);
+   }
+}
+/***stTraversalPushOccurrences****************************************/
+
+/*!
+\brief Returns the trie of the path ids on the traversal stack
+*/
+INTERNAL A3DBridgePathTrie& stTraversalTrie(A3DBridgeTraversal& sTraversal,
+                                            A3DPolygonicaOptions& pgOpts)
+{
+   return sTraversal.m_recordings.empty() ? pgOpts.m_path_trie : sTraversal.m_recordings.back().m_record.m_trie;
+}
+/***stTraversalTrie***************************************************/
+
+/*!
+\brief Appends a node to the assembly path of the current node
+*/
+INTERNAL void stTraversalPushPath(A3DBridgeTraversal& sTraversal,
+                                  A3DPolygonicaOptions& pgOpts,
+                                  const A3DEntity* pNode)
+{
+   A3DBridgePathTrie& trie = stTraversalTrie(sTraversal, pgOpts);
+
+   // The traversal never extends the same path by the same node twice, so no lookup is needed
+   A3DUns32 uiPathId = (A3DUns32)trie.m_nodes.size();
+   trie.m_nodes.push_back((void*)pNode);
+   trie.m_parents.push_back(sTraversal.m_pathIds.back());
+   sTraversal.m_pathIds.push_back(uiPathId);
+}
+/***stTraversalPushPath***********************************************/
+
+/*!
+\brief Returns the style id of cascaded attributes data; equal data have equal ids
+*/
+INTERNAL A3DUns32 stTraversalStyleId(A3DBridgeTraversal& sTraversal,
+                                     const A3DMiscCascadedAttributesData& sData)
+{
+   const A3DGraphStyleData& sStyle = sData.m_sStyle;
+   std::string sKey;
+   auto append = [&sKey](const void* pField, size_t uiSize) { sKey.append((const char*)pField, uiSize); };
+   append(&sData.m_bShow, sizeof(sData.m_bShow));
+   append(&sData.m_bRemoved, sizeof(sData.m_bRemoved));
+   append(&sData.m_usLayer, sizeof(sData.m_usLayer));
+   append(&sStyle.m_dWidth, sizeof(sStyle.m_dWidth));
+   append(&sStyle.m_bVPicture, sizeof(sStyle.m_bVPicture));
+   append(&sStyle.m_uiLinePatternIndex, sizeof(sStyle.m_uiLinePatternIndex));
+   append(&sStyle.m_bMaterial, sizeof(sStyle.m_bMaterial));
+   append(&sStyle.m_uiRgbColorIndex, sizeof(sStyle.m_uiRgbColorIndex));
+   append(&sStyle.m_bIsTransparencyDefined, sizeof(sStyle.m_bIsTransparencyDefined));
+   append(&sStyle.m_ucTransparency, sizeof(sStyle.m_ucTransparency));
+   append(&sStyle.m_bSpecialCulling, sizeof(sStyle.m_bSpecialCulling));
+   append(&sStyle.m_bFrontCulling, sizeof(sStyle.m_bFrontCulling));
+   append(&sStyle.m_bBackCulling, sizeof(sStyle.m_bBackCulling));
+   append(&sStyle.m_bNoLight, sizeof(sStyle.m_bNoLight));
+
+   auto search = sTraversal.m_styleIds.find(sKey);
+   if (search == sTraversal.m_styleIds.end())
+   {
+      search = sTraversal.m_styleIds.insert(std::make_pair(sKey, (A3DUns32)sTraversal.m_styleIds.size())).first;
+   }
+   return search->second;
+}
+/***stTraversalStyleId************************************************/
+
+/*!
+\brief Pushes the cascaded attributes of a node computed from those of its parent
+With the attribute cache they are computed once per node and distinct parent attributes.
+\param sAttrData [out] The attributes of the node
+\return The cache entry of the node, NULL without the cache
+*/
+INTERNAL A3DBridgeCascadedEntry* stTraversalPushAttributes(const A3DRootBaseWithGraphics* pBase,
+                                                           A3DBridgeTraversal& sTraversal,
+                                                           const A3DBridgeTraversalFrame& sFrame,
+                                                           A3DMiscCascadedAttributesData& sAttrData,
+                                                           A3D_log_func logging_function)
+{
+   A3DMiscCascadedAttributes* pFatherAttr = sTraversal.m_attributes[sFrame.m_uiAttributes - 1];
+   if (!sTraversal.m_bCacheAttributes)
+   {
+      A3DMiscCascadedAttributes* pAttr;
+      CHECK_A3DSTATUS(stCreateAndPushCascadedAttributes(pBase, pFatherAttr, &pAttr, &sAttrData, logging_function),
+                      logging_function, "stTraversalPushAttributes - stCreateAndPushCascadedAttributes");
+      sTraversal.m_attributes.push_back(pAttr);
+      sTraversal.m_attributeStyles.push_back(0);
+      return NULL;
+   }
+
+   sTraversal.m_uiAttributeLookups++;
+   std::pair<const A3DEntity*, A3DUns32> key(pBase, sTraversal.m_attributeStyles[sFrame.m_uiAttributes - 1]);
+   auto search = sTraversal.m_attributeCache.find(key);
+   if (search == sTraversal.m_attributeCache.end())
+   {
+      A3DBridgeCascadedEntry sEntry;
+      CHECK_A3DSTATUS(stCreateAndPushCascadedAttributes(pBase, pFatherAttr, &sEntry.m_pAttr, &sEntry.m_sData, logging_function),
+                      logging_function, "stTraversalPushAttributes - stCreateAndPushCascadedAttributes");
+      sEntry.m_uiStyle = stTraversalStyleId(sTraversal, sEntry.m_sData);
+      search = sTraversal.m_attributeCache.insert(std::make_pair(key, sEntry)).first;
+   }
+   else
+   {
+      sTraversal.m_uiAttributeHits++;
+   }
+
+   sAttrData = search->second.m_sData;
+   sTraversal.m_attributes.push_back(search->second.m_pAttr);
+   sTraversal.m_attributeStyles.push_back(search->second.m_uiStyle);
+   return &search->second;
+}
+/***stTraversalPushAttributes*****************************************/
+
+/*!
+\brief Unwinds the stacks to the state they had when the frame was pushed
+Cascaded attributes of the nodes left behind are deleted.
+*/
+INTERNAL void stTraversalUnwind(A3DBridgeTraversal& sTraversal,
+                                size_t uiPathSize,
+                                size_t uiTransform,
+                                size_t uiAttributes)
+{
+   sTraversal.m_pathIds.resize(uiPathSize);
+   sTraversal.m_transforms.resize(16 * (uiTransform + 1));
+   while (sTraversal.m_attributes.size() > uiAttributes)
+   {
+      if (!sTraversal.m_bCacheAttributes)
+      {
+         A3DMiscCascadedAttributesDelete(sTraversal.m_attributes.back());
+      }
+      sTraversal.m_attributes.pop_back();
+   }
+   sTraversal.m_attributeStyles.resize(uiAttributes);
+}
+/***stTraversalUnwind*************************************************/
+
+
+/*!
+\brief Returns the slot of a packed colour in the palette, or the empty slot where it belongs
+*/
+INTERNAL size_t stStylePaletteSlot(const A3DBridgeStylePalette& palette,
+                                   A3DUns32 uiKey)
+{
+   const size_t uiMask = palette.m_slots.size() - 1;
+   A3DUns32 uiHash = uiKey * 0x9E3779B1u;
+   size_t uiSlot = (uiHash ^ (uiHash >> 15)) & uiMask;
+   while (palette.m_slots[uiSlot] != PV_ENTITY_NULL && palette.m_keys[uiSlot] != uiKey)
+   {
+      uiSlot = (uiSlot + 1) & uiMask;
+   }
+   return uiSlot;
+}
+/***stStylePaletteSlot************************************************/
+
+/*!
+\brief Doubles the slots of the palette, or allocates them the first time
+*/
+INTERNAL void stStylePaletteGrow(A3DBridgeStylePalette& palette)
+{
+   std::vector<A3DUns32> keys;
+   std::vector<PTRenderStyle> slots;
+   keys.swap(palette.m_keys);
+   slots.swap(palette.m_slots);
+
+   const size_t uiSize = slots.empty() ? 64 : 2 * slots.size();
+   palette.m_keys.assign(uiSize, 0);
+   palette.m_slots.assign(uiSize, (PTRenderStyle)PV_ENTITY_NULL);
+   for (size_t ui = 0; ui < slots.size(); ui++)
+   {
+      if (slots[ui] != PV_ENTITY_NULL)
+      {
+         size_t uiSlot = stStylePaletteSlot(palette, keys[ui]);
+         palette.m_keys[uiSlot] = keys[ui];
+         palette.m_slots[uiSlot] = slots[ui];
+      }
+   }
+}
+/***stStylePaletteGrow************************************************/
+
+INTERNAL PTRenderStyle LookupRenderStyleByColor(float r, float g, float b,
+                                                A3DPolygonicaOptions& pgOpts,
+                                                A3D_log_func logging_function)
+{
+   // Maps color definitions to closest color in a palette 
+   // to keep down number of styles used by Polygonica graphics
+   auto nearest255 = [](float clrInt) { return (unsigned int)(clrInt * 255.0 + 0.5); };
+
+   A3DUns32 lR = nearest255(r);
+   A3DUns32 lG = nearest255(g);
+   A3DUns32 lB = nearest255(b);
+   // Opaque until transparency is supported
+   A3DUns32 index = lR + (lG << 8) + (lB << 16) + (0xFFu << 24);
+
+   A3DBridgeStylePalette& palette = pgOpts.m_style_palette;
+   if (palette.m_slots.empty())
+   {
+      stStylePaletteGrow(palette);
+   }
+
+   size_t uiSlot = stStylePaletteSlot(palette, index);
+   if (palette.m_slots[uiSlot] != PV_ENTITY_NULL)
+   {
+      return palette.m_slots[uiSlot];
+   }
+
+   PTRenderStyle newStyle = PV_ENTITY_NULL;
+   if (pgOpts.m_uiMaxStyles != 0 && palette.m_styles.size() >= pgOpts.m_uiMaxStyles)
+   {
+      // The palette is full: use the style of the nearest colour
+      long lBest = -1;
+      for (size_t ui = 0; ui < palette.m_colours.size(); ui++)
+      {
+         long lDR = (long)(palette.m_colours[ui] & 0xFF) - (long)lR;
+         long lDG = (long)((palette.m_colours[ui] >> 8) & 0xFF) - (long)lG;
+         long lDB = (long)((palette.m_colours[ui] >> 16) & 0xFF) - (long)lB;
+         long lDistance = lDR * lDR + lDG * lDG + lDB * lDB;
+         if (lBest < 0 || lDistance < lBest)
+         {
+            lBest = lDistance;
+            newStyle = palette.m_styles[ui];
          }
       }
-      PFEntityListDestroy(faces, 0);
+      palette.m_uiMergedColours++;
+   }
+   else
+   {
+      float rgbcolor[] = { r,g,b };
+      float grey[] = { 0.25f,0.25f, 0.25f };
 
-      // Add a solid / group vector pair to the output map m_surface_groups
-      opts->m_surface_groups.insert(std::make_pair(*solid, groups));
-      opts->m_iTopoFaceCount += uFaceSize;
+      PTPolygonStyle polyStyle;
+
+      PFRenderStyleCreate(pgOpts.m_Environment, &newStyle);
+      polyStyle = PFEntityGetEntityProperty(newStyle, PV_RSTYLE_PROP_POLYGON_STYLE);
+      PFEntitySetColourProperty(polyStyle, PV_PSTYLE_PROP_COLOUR, PV_COLOUR_SINGLE_RGB_ARRAY, rgbcolor);
+      PFEntitySetColourProperty(polyStyle, PV_PSTYLE_PROP_BACK_COLOUR, PV_COLOUR_SINGLE_RGB_ARRAY, rgbcolor);
+      PFEntitySetNat32Property(polyStyle, PV_PSTYLE_PROP_TRANSPARENCY, 0);
+
+      PTEdgeStyle edgeStyle;
+      edgeStyle = PFEntityGetEntityProperty(newStyle, PV_RSTYLE_PROP_EDGE_STYLE);
+      PFEntitySetColourProperty(edgeStyle, PV_ESTYLE_PROP_COLOUR, PV_COLOUR_SINGLE_RGB_ARRAY, grey);
+      PFEntitySetEntityProperty(newStyle, PV_RSTYLE_PROP_EDGE_STYLE, 0);
+      palette.m_styles.push_back(newStyle);
+      palette.m_colours.push_back(index);
    }
 
-   A3DRiRepresentationItemGet(NULL, &sRiData);
-   A3DTess3DGet(NULL, &sTessData);
-   A3DTessBaseGet(NULL, &sBaseTessData);
+   palette.m_keys[uiSlot] = index;
+   palette.m_slots[uiSlot] = newStyle;
+   // Keep the table at most half full so probe sequences stay short
+   if (2 * ++palette.m_uiSlotsUsed > palette.m_slots.size())
+   {
+      stStylePaletteGrow(palette);
+   }
+   return newStyle;
+}
+/***LookupRenderStyleByColor******************************************/
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC has no scoped form, so contraction stays off for the code that follows
+#pragma fp_contract(off)
+#endif
 
+INTERNAL A3DStatus MultiplyMatrix(const double* padFather,
+                                  const double* pdThisMatrix, 
+                                  double* pdResult)
+{
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+   A3DStatus iRet = A3D_SUCCESS;
+   pdResult[0] = padFather[0] * pdThisMatrix[0] + padFather[4] * pdThisMatrix[1] + padFather[8] * pdThisMatrix[2] + padFather[12] * pdThisMatrix[3];
+   pdResult[1] = padFather[1] * pdThisMatrix[0] + padFather[5] * pdThisMatrix[1] + padFather[9] * pdThisMatrix[2] + padFather[13] * pdThisMatrix[3];
+   pdResult[2] = padFather[2] * pdThisMatrix[0] + padFather[6] * pdThisMatrix[1] + padFather[10] * pdThisMatrix[2] + padFather[14] * pdThisMatrix[3];
+   pdResult[3] = padFather[3] * pdThisMatrix[0] + padFather[7] * pdThisMatrix[1] + padFather[11] * pdThisMatrix[2] + padFather[15] * pdThisMatrix[3];
+   pdResult[4] = padFather[0] * pdThisMatrix[4] + padFather[4] * pdThisMatrix[5] + padFather[8] * pdThisMatrix[6] + padFather[12] * pdThisMatrix[7];
+   pdResult[5] = padFather[1] * pdThisMatrix[4] + padFather[5] * pdThisMatrix[5] + padFather[9] * pdThisMatrix[6] + padFather[13] * pdThisMatrix[7];
+   pdResult[6] = padFather[2] * pdThisMatrix[4] + padFather[6] * pdThisMatrix[5] + padFather[10] * pdThisMatrix[6] + padFather[14] * pdThisMatrix[7];
+   pdResult[7] = padFather[3] * pdThisMatrix[4] + padFather[7] * pdThisMatrix[5] + padFather[11] * pdThisMatrix[6] + padFather[15] * pdThisMatrix[7];
+   pdResult[8] = padFather[0] * pdThisMatrix[8] + padFather[4] * pdThisMatrix[9] + padFather[8] * pdThisMatrix[10] + padFather[12] * pdThisMatrix[11];
+   pdResult[9] = padFather[1] * pdThisMatrix[8] + padFather[5] * pdThisMatrix[9] + padFather[9] * pdThisMatrix[10] + padFather[13] * pdThisMatrix[11];
+   pdResult[10] = padFather[2] * pdThisMatrix[8] + padFather[6] * pdThisMatrix[9] + padFather[10] * pdThisMatrix[10] + padFather[14] * pdThisMatrix[11];
+   pdResult[11] = padFather[3] * pdThisMatrix[8] + padFather[7] * pdThisMatrix[9] + padFather[11] * pdThisMatrix[10] + padFather[15] * pdThisMatrix[11];
+   pdResult[12] = padFather[0] * pdThisMatrix[12] + padFather[4] * pdThisMatrix[13] + padFather[8] * pdThisMatrix[14] + padFather[12] * pdThisMatrix[15];
+   pdResult[13] = padFather[1] * pdThisMatrix[12] + padFather[5] * pdThisMatrix[13] + padFather[9] * pdThisMatrix[14] + padFather[13] * pdThisMatrix[15];
+   pdResult[14] = padFather[2] * pdThisMatrix[12] + padFather[6] * pdThisMatrix[13] + padFather[10] * pdThisMatrix[14] + padFather[14] * pdThisMatrix[15];
+   pdResult[15] = padFather[3] * pdThisMatrix[12] + padFather[7] * pdThisMatrix[13] + padFather[11] * pdThisMatrix[14] + padFather[15] * pdThisMatrix[15];
    return iRet;
 }
-/***A3DRiRepresentationItemCreatePTSolid******************************/
+/***MultiplyMatrix****************************************************/
 
-INTERNAL int traverseRepItem(const A3DRiRepresentationItem* pRepItem,
-                             std::vector<void*> assemblyPath,
-                             PTTransformMatrix transform,
-                             A3DMiscCascadedAttributes* pFatherAttr,
-                             A3DPolygonicaOptions& pgOpts,
-                             A3D_log_func logging_function);
+/*!
+\brief Composes two affine transforms, pdResult = pdFather * pdThisMatrix, as column-major 4x4 matrices
+\param pdFather The parent transform
+\param pdThisMatrix The local transform; its last row is taken to be 0 0 0 1
+\param pdResult The composed transform, distinct from the other two
+
+The last row is known, so only 3x4 entries are computed. Each entry sums the same products in the same
+order as MultiplyMatrix, and neither is contracted into fused multiply-adds (see A3D_BRIDGE_AFFINE_AVX2),
+so the result only differs in the sign of zero entries. A parent that is not affine is left to MultiplyMatrix.
+*/
+INTERNAL void stComposeAffine(const double* pdFather,
+                              const double* pdThisMatrix,
+                              double* pdResult)
+{
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+   if (pdFather[3] != 0. || pdFather[7] != 0. || pdFather[11] != 0. || pdFather[15] != 1.)
+   {
+      MultiplyMatrix(pdFather, pdThisMatrix, pdResult);
+      return;
+   }
 
-INTERNAL int traverseSet(const A3DRiSet* pSet,
-                         std::vector<void*> assemblyPath,
-                         PTTransformMatrix transform,
-                         A3DMiscCascadedAttributes* pAttr,
-                         A3DPolygonicaOptions& pgOpts,
-                         A3D_log_func logging_function)
+#if defined(A3D_BRIDGE_AFFINE_AVX2)
+   // One register per column; the last lane is overwritten below
+   const __m256d c0 = _mm256_loadu_pd(pdFather);
+   const __m256d c1 = _mm256_loadu_pd(pdFather + 4);
+   const __m256d c2 = _mm256_loadu_pd(pdFather + 8);
+   const __m256d c3 = _mm256_loadu_pd(pdFather + 12);
+   for (int iCol = 0; iCol < 4; iCol++)
+   {
+      const double* pdColumn = pdThisMatrix + 4 * iCol;
+      __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c0, _mm256_set1_pd(pdColumn[0])),
+                                              _mm256_mul_pd(c1, _mm256_set1_pd(pdColumn[1]))),
+                                _mm256_mul_pd(c2, _mm256_set1_pd(pdColumn[2])));
+      if (iCol == 3)
+      {
+         r = _mm256_add_pd(r, c3);
+      }
+      _mm256_storeu_pd(pdResult + 4 * iCol, r);
+   }
+#elif defined(A3D_BRIDGE_AFFINE_SSE2)
+   // Rows 0 and 1, then rows 2 and 3; the last row is overwritten below
+   for (int iRow = 0; iRow < 4; iRow += 2)
+   {
+      const __m128d c0 = _mm_loadu_pd(pdFather + iRow);
+      const __m128d c1 = _mm_loadu_pd(pdFather + 4 + iRow);
+      const __m128d c2 = _mm_loadu_pd(pdFather + 8 + iRow);
+      const __m128d c3 = _mm_loadu_pd(pdFather + 12 + iRow);
+      for (int iCol = 0; iCol < 4; iCol++)
+      {
+         const double* pdColumn = pdThisMatrix + 4 * iCol;
+         __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c0, _mm_set1_pd(pdColumn[0])),
+                                           _mm_mul_pd(c1, _mm_set1_pd(pdColumn[1]))),
+                                _mm_mul_pd(c2, _mm_set1_pd(pdColumn[2])));
+         if (iCol == 3)
+         {
+            r = _mm_add_pd(r, c3);
+         }
+         _mm_storeu_pd(pdResult + 4 * iCol + iRow, r);
+      }
+   }
+#else
+   for (int iCol = 0; iCol < 4; iCol++)
+   {
+      const double* pdColumn = pdThisMatrix + 4 * iCol;
+      for (int iRow = 0; iRow < 3; iRow++)
+      {
+         double d = pdFather[iRow] * pdColumn[0] + pdFather[4 + iRow] * pdColumn[1] + pdFather[8 + iRow] * pdColumn[2];
+         pdResult[4 * iCol + iRow] = iCol == 3 ? d + pdFather[12 + iRow] : d;
+      }
+   }
+#endif
+
+   pdResult[3] = pdResult[7] = pdResult[11] = 0.;
+   pdResult[15] = 1.;
+}
+/***stComposeAffine***************************************************/
+
+INTERNAL A3DVector3dData CrossProduct(const A3DVector3dData* X, const A3DVector3dData* Y)
 {
-   A3DInt32 iRet = A3D_SUCCESS;
-   A3DRiSetData sData;
-   A3D_INITIALIZE_DATA(A3DRiSetData, sData);
+   A3DVector3dData Z;
+   Z.m_dX = X->m_dY * Y->m_dZ - X->m_dZ * Y->m_dY;
+   Z.m_dY = X->m_dZ * Y->m_dX - X->m_dX * Y->m_dZ;
+   Z.m_dZ = X->m_dX * Y->m_dY - X->m_dY * Y->m_dX;
+   return Z;
+}
+/***CrossProduct****************************************************/
+
+/*!
+\brief Decodes a cartesian transformation into a column-major 4x4 matrix
+\param pTransformation The transformation
+\param m The matrix
+\return A3D_SUCCESS, or the error of A3DMiscCartesianTransformationGet
+*/
+INTERNAL A3DStatus stLocalTransform(A3DMiscTransformation* pTransformation,
+                                    double m[16])
+{
+   A3DMiscCartesianTransformationData sTransformData;
+   A3D_INITIALIZE_DATA(A3DMiscCartesianTransformationData, sTransformData);
+   A3DStatus iRet = A3DMiscCartesianTransformationGet(pTransformation, &sTransformData);
 
-   iRet = A3DRiSetGet(pSet, &sData);
    if (iRet == A3D_SUCCESS)
    {
-      for (A3DUns32 ui = 0; ui < sData.m_uiRepItemsSize; ++ui)
+      double dMirror = (sTransformData.m_ucBehaviour & kA3DTransformationMirror) ? -1. : 1.;
+      A3DVector3dData sZVector = CrossProduct(&(sTransformData.m_sXVector), &(sTransformData.m_sYVector));
+
+      m[0] = sTransformData.m_sXVector.m_dX * sTransformData.m_sScale.m_dX;
+      m[1] = sTransformData.m_sXVector.m_dY * sTransformData.m_sScale.m_dX;
+      m[2] = sTransformData.m_sXVector.m_dZ * sTransformData.m_sScale.m_dX;
+      m[3] = 0.;
+
+      m[4] = sTransformData.m_sYVector.m_dX * sTransformData.m_sScale.m_dY;
+      m[5] = sTransformData.m_sYVector.m_dY * sTransformData.m_sScale.m_dY;
+      m[6] = sTransformData.m_sYVector.m_dZ * sTransformData.m_sScale.m_dY;
+      m[7] = 0.;
+
+      m[8] = dMirror * sZVector.m_dX * sTransformData.m_sScale.m_dZ;
+      m[9] = dMirror * sZVector.m_dY * sTransformData.m_sScale.m_dZ;
+      m[10] = dMirror * sZVector.m_dZ * sTransformData.m_sScale.m_dZ;
+      m[11] = 0.;
+
+      m[12] = sTransformData.m_sOrigin.m_dX;
+      m[13] = sTransformData.m_sOrigin.m_dY;
+      m[14] = sTransformData.m_sOrigin.m_dZ;
+      m[15] = 1.;
+
+      A3DMiscCartesianTransformationGet(NULL, &sTransformData);
+   }
+
+   return iRet;
+}
+/***stLocalTransform**************************************************/
+
+/*!
+\brief Composes two transforms of the traversal, comparing the result with MultiplyMatrix in the test mode
+*/
+INTERNAL void stTraversalCompose(A3DBridgeTraversal& sTraversal,
+                                 const double* pdFather,
+                                 const double* pdThisMatrix,
+                                 double* pdResult)
+{
+   stComposeAffine(pdFather, pdThisMatrix, pdResult);
+
+   if (sTraversal.m_bCheckTransforms)
+   {
+      double adExpected[16];
+      MultiplyMatrix(pdFather, pdThisMatrix, adExpected);
+      for (int i = 0; i < 16; i++)
+      {
+         // == ignores the sign of zeros; NaNs match each other
+         if (pdResult[i] != adExpected[i] && (pdResult[i] == pdResult[i] || adExpected[i] == adExpected[i]))
+         {
+            sTraversal.m_uiTransformMismatches++;
+            break;
+         }
+      }
+   }
+}
+/***stTraversalCompose************************************************/
+
+/*!
+\brief Composes a transform with a transformation, decoding each distinct transformation once
+\param pTransformation The transformation
+\param transform The parent transform
+\param localTransform The composed transform; left unchanged if the transformation cannot be read
+\param sTraversal The traversal that interns the transformations
+\param logging_function Unused, the error being returned
+\return A3D_SUCCESS, or the error of A3DMiscCartesianTransformationGet
+*/
+INTERNAL A3DStatus stTransform(A3DMiscTransformation* pTransformation,
+                               const PTTransformMatrix transform,
+                               PTTransformMatrix& localTransform,
+                               A3DBridgeTraversal& sTraversal,
+                               A3D_log_func /*logging_function*/)
+{
+   size_t uiLocal;
+   auto search = sTraversal.m_localTransforms.find(pTransformation);
+   if (search != sTraversal.m_localTransforms.end())
+   {
+      uiLocal = search->second;
+   }
+   else
+   {
+      double m[16];
+      A3DStatus iRet = stLocalTransform(pTransformation, m);
+      if (iRet != A3D_SUCCESS)
+      {
+         return iRet;
+      }
+      uiLocal = sTraversal.m_localMatrices.size() / 16;
+      sTraversal.m_localMatrices.insert(sTraversal.m_localMatrices.end(), m, m + 16);
+      sTraversal.m_localTransforms.emplace(pTransformation, uiLocal);
+   }
+
+   stTraversalCompose(sTraversal, &transform[0][0], &sTraversal.m_localMatrices[16 * uiLocal], &localTransform[0][0]);
+   return A3D_SUCCESS;
+}
+/***stTransform*****************************************************/
+
+/*!
+\brief Returns the transform of a world entity of a representation item, applying its m_part_transforms entry if any
+\param pRepItem The representation item
+\param pdTransform The world transform of the instance
+\param worldTransform [out] The transform for PFWorldEntitySetTransform
+*/
+INTERNAL void stPartWorldTransform(const A3DPolygonicaOptions& pgOpts,
+                                   const A3DRiRepresentationItem* pRepItem,
+                                   const double* pdTransform,
+                                   PTTransformMatrix worldTransform)
+{
+   auto search = pgOpts.m_part_transforms.empty() ? pgOpts.m_part_transforms.end() : pgOpts.m_part_transforms.find(pRepItem);
+   if (search != pgOpts.m_part_transforms.end())
+   {
+      stComposeAffine(pdTransform, search->second.data(), &worldTransform[0][0]);
+   }
+   else
+   {
+      memcpy(worldTransform, pdTransform, 16 * sizeof(double));
+   }
+}
+/***stPartWorldTransform**********************************************/
+
+/*!
+\brief Adds an instance of a solid to the world with its transform, style and path
+\param solid The solid
+\param transform The world transform of the instance
+\param r, g, b The colour of the instance
+\param uiPathId The id in m_path_trie of the path of the instance in the assembly tree
+\param pgOpts [in,out] Options. The world entity is added to m_entities and m_paths
+\return PV_STATUS_OK - Operation succeeded
+*/
+INTERNAL PTStatus stAddWorldEntity(PTSolid solid,
+                                   PTTransformMatrix transform,
+                                   float r, float g, float b,
+                                   A3DUns32 uiPathId,
+                                   A3DPolygonicaOptions& pgOpts,
+                                   A3D_log_func logging_function)
+{
+   PTWorldEntity worldEntity;
+   PTStatus status;
+   bool bAdded;
+   {
+      A3D_BRIDGE_TIME_PHASE(A3D_BRIDGE_STATS_OF(pgOpts), A3D_PHASE_WORLD);
+      status = PFWorldAddEntity(pgOpts.m_World, solid, &worldEntity);
+      CHECK_PTSTATUS(status, logging_function, "traverseRepItem - PFWorldAddEntity");
+      bAdded = status == PV_STATUS_OK;
+      if (bAdded)
+      {
+         status = PFWorldEntitySetTransform(worldEntity, transform, NULL);
+      }
+   }
+   if (bAdded)
+   {
+      // Add the polygon render style to the output palette m_style_palette if required
+      PTRenderStyle poly_style;
+      {
+         A3D_BRIDGE_TIME_PHASE(A3D_BRIDGE_STATS_OF(pgOpts), A3D_PHASE_STYLES);
+         poly_style = LookupRenderStyleByColor(r, g, b, pgOpts, logging_function);
+      }
+      PFEntitySetEntityProperty(worldEntity, PV_WENTITY_PROP_STYLE, poly_style);
+
+      // Add the world entity and its path id to the output vectors m_entities and m_paths
+      pgOpts.m_entities.push_back(worldEntity);
+      pgOpts.m_paths.push_back(uiPathId);
+      PFEntityGetEntityProperty(worldEntity, PV_WENTITY_PROP_ENTITY);
+
+      if (pgOpts.m_dFirstEntitySeconds < 0.)
+      {
+         pgOpts.m_dFirstEntitySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - pgOpts.m_tStart).count();
+      }
+      if (pgOpts.m_pEntityCallback)
+      {
+         pgOpts.m_pEntityCallback(worldEntity, solid, transform, poly_style, uiPathId, pgOpts.m_pEntityCallbackData);
+      }
+   }
+   return status;
+}
+/***stAddWorldEntity************************************************/
+
+/*!
+\brief Sends an instance to the innermost prototype recording, or else to the world
+In the world the PTSolid is created if needed and the world entity added, or both are left to the thread pool.
+*/
+INTERNAL int stTraversalEmit(const A3DBridgeInstance& sInstance,
+                             A3DBridgeTraversal& sTraversal,
+                             A3DPolygonicaOptions& pgOpts,
+                             A3D_log_func logging_function)
+{
+   A3DInt32 iRet = A3D_SUCCESS;
+   const A3DRiRepresentationItem* pRepItem = sInstance.m_pRepItem;
+
+   if (!sTraversal.m_recordings.empty())
+   {
+      sTraversal.m_recordings.back().m_record.m_instances.push_back(sInstance);
+   }
+   else if (pgOpts.m_pDeferredWork)
+   {
+      // Record the instance; its PTSolid is built on the thread pool once the traversal ends
+      if (pgOpts.m_parts.find(pRepItem) == pgOpts.m_parts.end())
+      {
+         pgOpts.m_parts.insert(std::make_pair(pRepItem, (PTSolid)PV_ENTITY_NULL));
+         pgOpts.m_pDeferredWork->m_uniqueItems.push_back(pRepItem);
+         pgOpts.m_pDeferredWork->m_firstInstances.push_back(pgOpts.m_pDeferredWork->m_instances.size());
+      }
+      pgOpts.m_pDeferredWork->m_instances.push_back(sInstance);
+   }
+   else
+   {
+      // Create a PTSolid and add a representation item / solid pair to the output map m_parts
+      PTSolid solid = PV_ENTITY_NULL;
+      if (pgOpts.m_parts.find(pRepItem) == pgOpts.m_parts.end())
+      {
+         iRet = A3DRiRepresentationItemCreatePTSolid(pRepItem, &solid, &pgOpts);
+         pgOpts.m_parts.insert(std::make_pair(pRepItem, solid));
+      }
+      else
       {
-         iRet = traverseRepItem(sData.m_ppRepItems[ui], assemblyPath, transform, pAttr, pgOpts, logging_function);
+         solid = pgOpts.m_parts[pRepItem];
       }
 
-      A3DRiSetGet(NULL, &sData);
+      PTTransformMatrix worldTransform;
+      stPartWorldTransform(pgOpts, pRepItem, &sInstance.m_transform[0][0], worldTransform);
+      stAddWorldEntity(solid, worldTransform,
+                       sInstance.m_afRgb[0], sInstance.m_afRgb[1], sInstance.m_afRgb[2],
+                       sInstance.m_uiPathId, pgOpts, logging_function);
    }
-
    return iRet;
 }
-/***traverseSet*******************************************************/
+/***stTraversalEmit*************************************************/
 
-INTERNAL PTRenderStyle LookupRenderStyleByColor(float r, float g, float b,
-                                                A3DPolygonicaOptions& pgOpts,
-                                                A3D_log_func logging_function)
+/*!
+\brief Emits the instances of a recorded prototype for an occurrence using it
+\param pdParentTransform The transform of the occurrence
+\param uiParentPathId The path id of the occurrence on the traversal stack
+*/
+INTERNAL void stTraversalReplay(const A3DBridgePrototypeRecord& sRecord,
+                                const double* pdParentTransform,
+                                A3DUns32 uiParentPathId,
+                                A3DBridgeTraversal& sTraversal,
+                                A3DPolygonicaOptions& pgOpts,
+                                A3D_log_func logging_function)
 {
-   // Maps color definitions to closest color in a palette 
-   // to keep down number of styles used by Polygonica graphics
-   auto nearest255 = [](float clrInt) { return (unsigned int)(clrInt * 255.0 + 0.5); };
-
-   unsigned long lR = nearest255(r);
-   unsigned long lG = nearest255(g);
-   unsigned long lB = nearest255(b);
-   unsigned long index = lR + (lG << 8) + (lB << 16);
-
-   auto search = pgOpts.m_style_palette.find(index);
-   if (search == pgOpts.m_style_palette.end())
+   // Graft the recorded paths below the path of the occurrence; a parent always precedes its children
+   A3DBridgePathTrie& trie = stTraversalTrie(sTraversal, pgOpts);
+   std::vector<A3DUns32> auiPathIds(sRecord.m_trie.m_nodes.size());
+   auiPathIds[0] = uiParentPathId;
+   for (size_t ui = 1; ui < auiPathIds.size(); ui++)
    {
-      float rgbcolor[] = { r,g,b };
-      float grey[] = { 0.25f,0.25f, 0.25f };
+      auiPathIds[ui] = (A3DUns32)trie.m_nodes.size();
+      trie.m_nodes.push_back(sRecord.m_trie.m_nodes[ui]);
+      trie.m_parents.push_back(auiPathIds[sRecord.m_trie.m_parents[ui]]);
+   }
 
-      PTRenderStyle newStyle;
-      PTPolygonStyle polyStyle;
+   for (const A3DBridgeInstance& sRecorded : sRecord.m_instances)
+   {
+      A3DBridgeInstance sInstance = sRecorded;
+      stTraversalCompose(sTraversal, pdParentTransform, &sRecorded.m_transform[0][0], &sInstance.m_transform[0][0]);
+      sInstance.m_uiPathId = auiPathIds[sRecorded.m_uiPathId];
+      stTraversalEmit(sInstance, sTraversal, pgOpts, logging_function);
+   }
+}
+/***stTraversalReplay***********************************************/
 
-      PFRenderStyleCreate(pgOpts.m_Environment, &newStyle);
-      polyStyle = PFEntityGetEntityProperty(newStyle, PV_RSTYLE_PROP_POLYGON_STYLE);
-      PFEntitySetColourProperty(polyStyle, PV_PSTYLE_PROP_COLOUR, PV_COLOUR_SINGLE_RGB_ARRAY, rgbcolor);
-      PFEntitySetColourProperty(polyStyle, PV_PSTYLE_PROP_BACK_COLOUR, PV_COLOUR_SINGLE_RGB_ARRAY, rgbcolor);
-      PFEntitySetNat32Property(polyStyle, PV_PSTYLE_PROP_TRANSPARENCY, 0);
+/*!
+\brief Ends the prototype recordings whose subtree has been visited
+Each record is kept for the next instances and replayed for the occurrence that started it.
+*/
+INTERNAL void stTraversalEndRecordings(A3DBridgeTraversal& sTraversal,
+                                       A3DPolygonicaOptions& pgOpts,
+                                       A3D_log_func logging_function)
+{
+   while (!sTraversal.m_recordings.empty() &&
+          sTraversal.m_frames.size() <= sTraversal.m_recordings.back().m_uiFrames)
+   {
+      A3DBridgePrototypeRecording sRecording = std::move(sTraversal.m_recordings.back());
+      sTraversal.m_recordings.pop_back();
 
-      PTEdgeStyle edgeStyle;
-      edgeStyle = PFEntityGetEntityProperty(newStyle, PV_RSTYLE_PROP_EDGE_STYLE);
-      PFEntitySetColourProperty(edgeStyle, PV_ESTYLE_PROP_COLOUR, PV_COLOUR_SINGLE_RGB_ARRAY, grey);
-      PFEntitySetEntityProperty(newStyle, PV_RSTYLE_PROP_EDGE_STYLE, 0);
-      pgOpts.m_style_palette[index] = newStyle;
-      return newStyle;
+      A3DBridgePrototypeRecord& sRecord = sTraversal.m_prototypes[sRecording.m_key];
+      sRecord = std::move(sRecording.m_record);
+      stTraversalReplay(sRecord, &sRecording.m_parentTransform[0][0], sRecording.m_uiParentPathId,
+                        sTraversal, pgOpts, logging_function);
    }
-
-   return search->second;
 }
-/***LookupRenderStyleByColor******************************************/
+/***stTraversalEndRecordings****************************************/
 
-INTERNAL A3DStatus MultiplyMatrix(const double* padFather,
-                                  const double* pdThisMatrix, 
-                                  double* pdResult)
+/*!
+\brief Opens the span of a node whose subtree is about to be visited, if pgOpts.m_pTracer is set
+The span takes the name of the node and ends in stTraversalTraceEnd once the frames of the subtree are visited.
+*/
+INTERNAL void stTraversalTraceBegin(A3DBridgeTraversal& sTraversal,
+                                    A3DPolygonicaOptions& pgOpts,
+                                    const char* pcCategory,
+                                    const A3DEntity* pNode,
+                                    A3D_log_func logging_function)
 {
-   A3DStatus iRet = A3D_SUCCESS;
-   pdResult[0] = padFather[0] * pdThisMatrix[0] + padFather[4] * pdThisMatrix[1] + padFather[8] * pdThisMatrix[2] + padFather[12] * pdThisMatrix[3];
-   pdResult[1] = padFather[1] * pdThisMatrix[0] + padFather[5] * pdThisMatrix[1] + padFather[9] * pdThisMatrix[2] + padFather[13] * pdThisMatrix[3];
-   pdResult[2] = padFather[2] * pdThisMatrix[0] + padFather[6] * pdThisMatrix[1] + padFather[10] * pdThisMatrix[2] + padFather[14] * pdThisMatrix[3];
-   pdResult[3] = padFather[3] * pdThisMatrix[0] + padFather[7] * pdThisMatrix[1] + padFather[11] * pdThisMatrix[2] + padFather[15] * pdThisMatrix[3];
-   pdResult[4] = padFather[0] * pdThisMatrix[4] + padFather[4] * pdThisMatrix[5] + padFather[8] * pdThisMatrix[6] + padFather[12] * pdThisMatrix[7];
-   pdResult[5] = padFather[1] * pdThisMatrix[4] + padFather[5] * pdThisMatrix[5] + padFather[9] * pdThisMatrix[6] + padFather[13] * pdThisMatrix[7];
-   pdResult[6] = padFather[2] * pdThisMatrix[4] + padFather[6] * pdThisMatrix[5] + padFather[10] * pdThisMatrix[6] + padFather[14] * pdThisMatrix[7];
-   pdResult[7] = padFather[3] * pdThisMatrix[4] + padFather[7] * pdThisMatrix[5] + padFather[11] * pdThisMatrix[6] + padFather[15] * pdThisMatrix[7];
-   pdResult[8] = padFather[0] * pdThisMatrix[8] + padFather[4] * pdThisMatrix[9] + padFather[8] * pdThisMatrix[10] + padFather[12] * pdThisMatrix[11];
-   pdResult[9] = padFather[1] * pdThisMatrix[8] + padFather[5] * pdThisMatrix[9] + padFather[9] * pdThisMatrix[10] + padFather[13] * pdThisMatrix[11];
-   pdResult[10] = padFather[2] * pdThisMatrix[8] + padFather[6] * pdThisMatrix[9] + padFather[10] * pdThisMatrix[10] + padFather[14] * pdThisMatrix[11];
-   pdResult[11] = padFather[3] * pdThisMatrix[8] + padFather[7] * pdThisMatrix[9] + padFather[11] * pdThisMatrix[10] + padFather[15] * pdThisMatrix[11];
-   pdResult[12] = padFather[0] * pdThisMatrix[12] + padFather[4] * pdThisMatrix[13] + padFather[8] * pdThisMatrix[14] + padFather[12] * pdThisMatrix[15];
-   pdResult[13] = padFather[1] * pdThisMatrix[12] + padFather[5] * pdThisMatrix[13] + padFather[9] * pdThisMatrix[14] + padFather[13] * pdThisMatrix[15];
-   pdResult[14] = padFather[2] * pdThisMatrix[12] + padFather[6] * pdThisMatrix[13] + padFather[10] * pdThisMatrix[14] + padFather[14] * pdThisMatrix[15];
-   pdResult[15] = padFather[3] * pdThisMatrix[12] + padFather[7] * pdThisMatrix[13] + padFather[11] * pdThisMatrix[14] + padFather[15] * pdThisMatrix[15];
-   return iRet;
+   A3DBridgeTraceBuffer* pBuffer = pgOpts.m_pTracer ? pgOpts.m_pTracer->ThreadBuffer() : NULL;
+   if (!pBuffer)
+   {
+      return;
+   }
+
+   A3DBridgeTraceOpenSpan sSpan;
+   stGetName(pNode, sSpan.m_sEvent.m_sName, logging_function);
+   if (sSpan.m_sEvent.m_sName.empty())
+   {
+      sSpan.m_sEvent.m_sName = pcCategory;
+   }
+   sSpan.m_sEvent.m_pcCategory = pcCategory;
+   sSpan.m_sEvent.m_uiStartNs = pgOpts.m_pTracer->NowNs();
+   sSpan.m_uiFrames = sTraversal.m_frames.size();
+   sSpan.m_uiTrianglesStart = pBuffer->m_uiTriangles;
+   sTraversal.m_traceSpans.push_back(std::move(sSpan));
 }
-/***MultiplyMatrix****************************************************/
+/***stTraversalTraceBegin*******************************************/
 
-INTERNAL A3DVector3dData CrossProduct(const A3DVector3dData* X, const A3DVector3dData* Y)
+/*!
+\brief Ends the spans of the nodes whose subtree has been visited, or every span if bAll is set
+*/
+INTERNAL void stTraversalTraceEnd(A3DBridgeTraversal& sTraversal,
+                                  A3DPolygonicaOptions& pgOpts,
+                                  bool bAll)
 {
-   A3DVector3dData Z;
-   Z.m_dX = X->m_dY * Y->m_dZ - X->m_dZ * Y->m_dY;
-   Z.m_dY = X->m_dZ * Y->m_dX - X->m_dX * Y->m_dZ;
-   Z.m_dZ = X->m_dX * Y->m_dY - X->m_dY * Y->m_dX;
-   return Z;
+   while (!sTraversal.m_traceSpans.empty() &&
+          (bAll || sTraversal.m_frames.size() <= sTraversal.m_traceSpans.back().m_uiFrames))
+   {
+      A3DBridgeTraceOpenSpan& sSpan = sTraversal.m_traceSpans.back();
+      A3DBridgeTraceBuffer* pBuffer = pgOpts.m_pTracer->ThreadBuffer();
+      sSpan.m_sEvent.m_uiDurationNs = pgOpts.m_pTracer->NowNs() - sSpan.m_sEvent.m_uiStartNs;
+      sSpan.m_sEvent.m_uiTriangles = pBuffer->m_uiTriangles - sSpan.m_uiTrianglesStart;
+      pBuffer->m_events.push_back(std::move(sSpan.m_sEvent));
+      sTraversal.m_traceSpans.pop_back();
+   }
 }
-/***CrossProduct****************************************************/
+/***stTraversalTraceEnd*********************************************/
 
-INTERNAL A3DStatus stTransform(A3DMiscTransformation* pTransformation,
-                               PTTransformMatrix transform, 
-                               PTTransformMatrix& localTransform, 
-                               A3D_log_func logging_function)
+INTERNAL int traverseSet(const A3DRiSet* pSet,
+                         A3DBridgeTraversal& sTraversal,
+                         A3DPolygonicaOptions& /*pgOpts*/,
+                         A3D_log_func /*logging_function*/)
 {
-   A3DStatus iRet = A3D_SUCCESS;
-
-   A3DMiscCartesianTransformationData sTransformData;
-   A3D_INITIALIZE_DATA(A3DMiscCartesianTransformationData, sTransformData);
-   iRet = A3DMiscCartesianTransformationGet(pTransformation, &sTransformData);
+   A3DInt32 iRet = A3D_SUCCESS;
+   A3DRiSetData sData;
+   A3D_INITIALIZE_DATA(A3DRiSetData, sData);
 
+   iRet = A3DRiSetGet(pSet, &sData);
    if (iRet == A3D_SUCCESS)
    {
-      double dMirror = (sTransformData.m_ucBehaviour & kA3DTransformationMirror) ? -1. : 1.;
-      A3DVector3dData sZVector;
-      double m[16];
-      memset(m, 0, 16 * sizeof(double));
-      sZVector = CrossProduct(&(sTransformData.m_sXVector), &(sTransformData.m_sYVector));
-
-      m[12] = sTransformData.m_sOrigin.m_dX;
-      m[13] = sTransformData.m_sOrigin.m_dY;
-      m[14] = sTransformData.m_sOrigin.m_dZ;
-
-      m[0] = sTransformData.m_sXVector.m_dX * sTransformData.m_sScale.m_dX;
-      m[1] = sTransformData.m_sXVector.m_dY * sTransformData.m_sScale.m_dX;
-      m[2] = sTransformData.m_sXVector.m_dZ * sTransformData.m_sScale.m_dX;
-
-      m[4] = sTransformData.m_sYVector.m_dX * sTransformData.m_sScale.m_dY;
-      m[5] = sTransformData.m_sYVector.m_dY * sTransformData.m_sScale.m_dY;
-      m[6] = sTransformData.m_sYVector.m_dZ * sTransformData.m_sScale.m_dY;
-
-      m[8] = dMirror * sZVector.m_dX * sTransformData.m_sScale.m_dZ;
-      m[9] = dMirror * sZVector.m_dY * sTransformData.m_sScale.m_dZ;
-      m[10] = dMirror * sZVector.m_dZ * sTransformData.m_sScale.m_dZ;
-
-      m[15] = 1.;
-
-      MultiplyMatrix((double*)transform, m, (double*)localTransform);
+      // Pushed in reverse so they are visited in order
+      for (A3DUns32 ui = sData.m_uiRepItemsSize; ui-- > 0;)
+      {
+         stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kRepItem, sData.m_ppRepItems[ui]);
+      }
 
-      A3DMiscCartesianTransformationGet(NULL, &sTransformData);
+      A3DRiSetGet(NULL, &sData);
    }
 
    return iRet;
 }
-/***stTransform*****************************************************/
+/***traverseSet*******************************************************/
 
 INTERNAL int traverseRepItem(const A3DRiRepresentationItem* pRepItem,
-                             std::vector<void*> assemblyPath,
-                             PTTransformMatrix transform,
-                             A3DMiscCascadedAttributes* pFatherAttr,
+                             A3DBridgeTraversal& sTraversal,
+                             const A3DBridgeTraversalFrame& sFrame,
                              A3DPolygonicaOptions& pgOpts,
                              A3D_log_func logging_function)
 {
    A3DInt32 iRet = A3D_SUCCESS;
-   PTStatus status = PV_STATUS_OK;
    A3DEEntityType eType;
+   stTraversalTraceBegin(sTraversal, pgOpts, "item", pRepItem, logging_function);
 
-   A3DMiscCascadedAttributes* pAttr;
    A3DMiscCascadedAttributesData sAttrData;
-   CHECK_A3DSTATUS(stCreateAndPushCascadedAttributes(pRepItem, pFatherAttr, &pAttr, &sAttrData, logging_function),
-      logging_function, "traverseRepItem - stCreateAndPushCascadedAttributes");
-   const MiscCascadedAttributesGuard sMCAttrGuard(pAttr);
+   // The attributes live until the items of a set are visited
+   A3DBridgeCascadedEntry* pCached = stTraversalPushAttributes(pRepItem, sTraversal, sFrame, sAttrData, logging_function);
 
-   float r, g, b;
-   CHECK_A3DSTATUS(stExtractColorFromGraphicData(pRepItem, sAttrData.m_sStyle, r, g, b, logging_function),
-      logging_function, "traverseRepItem - stExtractColorFromGraphicData");
+   // Black when Exchange has no colour for the style
+   float r = 0.f, g = 0.f, b = 0.f;
+   if (pCached && pCached->m_bHasRgb)
+   {
+      r = pCached->m_afRgb[0];
+      g = pCached->m_afRgb[1];
+      b = pCached->m_afRgb[2];
+   }
+   else
+   {
+      bool bHasRgb = false;
+      CHECK_A3DSTATUS(stColourTableLookup(sTraversal.m_colourTable, pRepItem, sAttrData.m_sStyle, r, g, b, logging_function,
+                                          &bHasRgb),
+         logging_function, "traverseRepItem - stColourTableLookup");
+      // Only a resolved colour is cached, so an item without one looks it up again
+      if (pCached && bHasRgb)
+      {
+         pCached->m_bHasRgb = true;
+         pCached->m_afRgb[0] = r;
+         pCached->m_afRgb[1] = g;
+         pCached->m_afRgb[2] = b;
+      }
+   }
 
    CHECK_A3DSTATUS(A3DEntityGetType(pRepItem, &eType),
       logging_function, "traverseRepItem - A3DEntityGetType");
@@ -832,7 +4483,7 @@ INTERNAL int traverseRepItem(const A3DRiRepresentationItem* pRepItem,
    {
       case kA3DTypeRiSet:
       {
-         iRet = traverseSet(pRepItem, assemblyPath, transform, pAttr, pgOpts, logging_function);
+         iRet = traverseSet(pRepItem, sTraversal, pgOpts, logging_function);
          break;
       }
       case kA3DTypeRiBrepModel:
@@ -842,6 +4493,7 @@ INTERNAL int traverseRepItem(const A3DRiRepresentationItem* pRepItem,
          A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, sData);
          iRet = A3DRiRepresentationItemGet(pRepItem, &sData);
 
+         double* transform = &sTraversal.m_transforms[16 * sFrame.m_uiTransform];
          PTTransformMatrix localTransform;
          memcpy(localTransform, transform, 16 * sizeof(double));
 
@@ -851,227 +4503,820 @@ INTERNAL int traverseRepItem(const A3DRiRepresentationItem* pRepItem,
             A3D_INITIALIZE_DATA(A3DRiCoordinateSystemData, sCoordSysData);
             iRet = A3DRiCoordinateSystemGet(sData.m_pCoordinateSystem, &sCoordSysData);
 
-            iRet = stTransform(sCoordSysData.m_pTransformation, transform, localTransform, logging_function);
+            iRet = stTransform(sCoordSysData.m_pTransformation, (double(*)[4])transform, localTransform, sTraversal, logging_function);
 
             A3DRiCoordinateSystemGet(NULL, &sCoordSysData);
          }
 
          A3DRiRepresentationItemGet(NULL, &sData);
 
-         // Create a PTSolid and add a representation item / solid pair to the output map m_parts
-         PTSolid solid;
-         if (pgOpts.m_parts.find(pRepItem) == pgOpts.m_parts.end())
+         A3DBridgeInstance sInstance;
+         sInstance.m_pRepItem = pRepItem;
+         memcpy(sInstance.m_transform, localTransform, 16 * sizeof(double));
+         sInstance.m_afRgb[0] = r;
+         sInstance.m_afRgb[1] = g;
+         sInstance.m_afRgb[2] = b;
+         sInstance.m_uiPathId = sTraversal.m_pathIds.back();
+         iRet = stTraversalEmit(sInstance, sTraversal, pgOpts, logging_function);
+         break;
+      }
+      default:
+      {
+         iRet = A3D_NOT_IMPLEMENTED;
+         log(logging_function, "traverseRepItem of type " + std::to_string(eType) + " is not implemented", A3D_LOG_WARN);
+         break;
+      }
+   }
+   return iRet;
+}
+/***traverseRepItem*************************************************/
+
+INTERNAL int stTraversePartDef(const A3DAsmPartDefinition* pPart,
+                               A3DBridgeTraversal& sTraversal,
+                               const A3DBridgeTraversalFrame& sFrame,
+                               A3DPolygonicaOptions& pgOpts, 
+                               A3D_log_func logging_function)
+{
+   A3DInt32 iRet = A3D_SUCCESS;
+   stTraversalTraceBegin(sTraversal, pgOpts, "part", pPart, logging_function);
+
+   A3DMiscCascadedAttributesData sAttrData;
+   stTraversalPushAttributes(pPart, sTraversal, sFrame, sAttrData, logging_function);
+
+   A3DAsmPartDefinitionData sData;
+   A3D_INITIALIZE_DATA(A3DAsmPartDefinitionData, sData);
+
+   stTraversalPushPath(sTraversal, pgOpts, pPart);
+
+   iRet = A3DAsmPartDefinitionGet(pPart, &sData);
+   if (iRet == A3D_SUCCESS)
+   {
+      // Pushed in reverse so they are visited in order
+      for (A3DUns32 ui = sData.m_uiRepItemsSize; ui-- > 0;)
+      {
+         stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kRepItem, sData.m_ppRepItems[ui]);
+      }
+
+      A3DAsmPartDefinitionGet(NULL, &sData);
+   }
+
+   return iRet;
+}
+/***stTraversePartDef***********************************************/
+
+INTERNAL int stTraversePOccurrence(const A3DAsmProductOccurrence* pOccurrence,
+                                   A3DBridgeTraversal& sTraversal,
+                                   const A3DBridgeTraversalFrame& sFrame,
+                                   bool isPrototype, 
+                                   A3DPolygonicaOptions& pgOpts, 
+                                   A3D_log_func logging_function)
+{
+   A3DInt32 iRet = A3D_SUCCESS;
+   stTraversalTraceBegin(sTraversal, pgOpts, isPrototype ? "prototype" : "occurrence", pOccurrence, logging_function);
+
+   A3DMiscCascadedAttributesData sAttrData;
+   stTraversalPushAttributes(pOccurrence, sTraversal, sFrame, sAttrData, logging_function);
+
+   A3DAsmProductOccurrenceData sData;
+   A3D_INITIALIZE_DATA(A3DAsmProductOccurrenceData, sData);
+   iRet = A3DAsmProductOccurrenceGet(pOccurrence, &sData);
+
+   if (iRet == A3D_SUCCESS)
+   {
+      if (sData.m_pLocation)
+      {
+         A3DEEntityType eType = kA3DTypeUnknown;
+         iRet = A3DEntityGetType(sData.m_pLocation, &eType);
+         if (eType == kA3DTypeMiscCartesianTransformation)
+         {
+            // The children use a new transform on top of the stack
+            PTTransformMatrix transform, localTransform;
+            memcpy(transform, &sTraversal.m_transforms[16 * sFrame.m_uiTransform], 16 * sizeof(double));
+            memcpy(localTransform, transform, 16 * sizeof(double));
+            iRet = stTransform(sData.m_pLocation, transform, localTransform, sTraversal, logging_function);
+            sTraversal.m_transforms.insert(sTraversal.m_transforms.end(), &localTransform[0][0], &localTransform[0][0] + 16);
+         }
+         else if (eType == kA3DTypeMiscGeneralTransformation)
          {
-            iRet = A3DRiRepresentationItemCreatePTSolid(pRepItem, &solid, &pgOpts);
-            pgOpts.m_parts.insert(std::make_pair(pRepItem, solid));
+            log(logging_function, "In stTraversePOccurrence, cannot process location type kA3DTypeMiscGeneralTransformation", A3D_LOG_ERROR);
          }
          else
          {
-            solid = pgOpts.m_parts[pRepItem];
+            log(logging_function, "In stTraversePOccurrence, the location type " + std::to_string(eType) + " is unknown", A3D_LOG_ERROR);
          }
+      }
 
-         PTWorldEntity worldEntity;
-         status = PFWorldAddEntity(pgOpts.m_World, solid, &worldEntity);
-         CHECK_PTSTATUS(status, logging_function, "traverseRepItem - PFWorldAddEntity");
-         if (status == PV_STATUS_OK)
-         {
-            status = PFWorldEntitySetTransform(worldEntity, localTransform, NULL);
+      if (!isPrototype)
+      {
+         stTraversalPushPath(sTraversal, pgOpts, pOccurrence);
+      }
 
-            // Add the polygon render style to the output map m_style_palette if required
-            PTRenderStyle poly_style = LookupRenderStyleByColor(r, g, b, pgOpts, logging_function);
-            PFEntitySetEntityProperty(worldEntity, PV_WENTITY_PROP_STYLE, poly_style);
+      // The part is visited after the child occurrences, so it is pushed first
+      if (sData.m_pPart)
+      {
+         stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kPartDefinition, sData.m_pPart);
+      }
 
-            // Add a world entity / path pair to the output map m_paths
-            std::vector<void*>* path = new std::vector<void*>(assemblyPath);
-            pgOpts.m_paths.insert(std::make_pair(worldEntity, path));
+      if (sData.m_pPrototype)
+      {
+         stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kPrototype, sData.m_pPrototype);
+      }
+      else if (sData.m_pExternalData)
+      {
+         stTraversalPush(sTraversal, A3DBridgeTraversalFrame::kPrototype, sData.m_pExternalData);
+      }
+      else
+      {
+         stTraversalPushOccurrences(sTraversal, pgOpts, sData.m_ppPOccurrences, sData.m_uiPOccurrencesSize);
+      }
 
-            // Add the world entity to the output vector m_entities
-            pgOpts.m_entities.push_back(worldEntity);
-            PFEntityGetEntityProperty(worldEntity, PV_WENTITY_PROP_ENTITY);
-         }
-         break;
+      CHECK_A3DSTATUS(A3DAsmProductOccurrenceGet(NULL, &sData), logging_function, "stTraversePOccurrence - A3DAsmProductOccurrenceGet");
+   }
+
+   return iRet;
+}
+/***stTraversePOccurrence*******************************************/
+
+/*!
+\brief Visits a prototype, or replays it if pgOpts.m_bCachePrototypes is set and it was visited before
+A first visit with caching is recorded relative to the occurrence using the prototype.
+*/
+INTERNAL int stTraversePrototype(const A3DAsmProductOccurrence* pPrototype,
+                                 A3DBridgeTraversal& sTraversal,
+                                 const A3DBridgeTraversalFrame& sFrame,
+                                 A3DPolygonicaOptions& pgOpts,
+                                 A3D_log_func logging_function)
+{
+   if (!pgOpts.m_bCachePrototypes)
+   {
+      return stTraversePOccurrence(pPrototype, sTraversal, sFrame, true, pgOpts, logging_function);
+   }
+
+   // The colours of the subtree may depend on the colour the prototype inherits
+   A3DMiscCascadedAttributesData sAttrData;
+   A3D_INITIALIZE_DATA(A3DMiscCascadedAttributesData, sAttrData);
+   CHECK_A3DSTATUS(A3DMiscCascadedAttributesGet(sTraversal.m_attributes[sFrame.m_uiAttributes - 1], &sAttrData),
+                   logging_function, "stTraversePrototype - A3DMiscCascadedAttributesGet");
+   A3DUns64 uiStyle = ((A3DUns64)sAttrData.m_sStyle.m_bMaterial << 32) | sAttrData.m_sStyle.m_uiRgbColorIndex;
+   std::pair<const A3DEntity*, A3DUns64> key(pPrototype, uiStyle);
+
+   const double* pdTransform = &sTraversal.m_transforms[16 * sFrame.m_uiTransform];
+   auto search = sTraversal.m_prototypes.find(key);
+   if (search != sTraversal.m_prototypes.end())
+   {
+      stTraversalReplay(search->second, pdTransform, sTraversal.m_pathIds.back(), sTraversal, pgOpts, logging_function);
+      return A3D_SUCCESS;
+   }
+
+   A3DBridgePrototypeRecording sRecording;
+   sRecording.m_key = key;
+   sRecording.m_uiFrames = sTraversal.m_frames.size();
+   memcpy(sRecording.m_parentTransform, pdTransform, 16 * sizeof(double));
+   sRecording.m_uiParentPathId = sTraversal.m_pathIds.back();
+   sTraversal.m_recordings.push_back(std::move(sRecording));
+
+   // The subtree starts from the identity and from the empty path of the recording's trie
+   PTTransformMatrix identity;
+   PMInitTransformMatrix(identity);
+   sTraversal.m_transforms.insert(sTraversal.m_transforms.end(), &identity[0][0], &identity[0][0] + 16);
+   sTraversal.m_pathIds.push_back(0);
+
+   A3DBridgeTraversalFrame sRelativeFrame = sFrame;
+   sRelativeFrame.m_uiTransform = sTraversal.m_transforms.size() / 16 - 1;
+   return stTraversePOccurrence(pPrototype, sTraversal, sRelativeFrame, true, pgOpts, logging_function);
+}
+/***stTraversePrototype*********************************************/
+
+/*!
+\brief Visits the frames of the traversal until its stack is empty
+Nodes are visited depth first in the same order as a recursive traversal, without recursion.
+*/
+INTERNAL int stTraversalRun(A3DBridgeTraversal& sTraversal,
+                            A3DPolygonicaOptions& pgOpts,
+                            A3D_log_func logging_function)
+{
+   while (!sTraversal.m_frames.empty())
+   {
+      // A replayed prototype belongs to the span of the occurrence using it
+      stTraversalEndRecordings(sTraversal, pgOpts, logging_function);
+      stTraversalTraceEnd(sTraversal, pgOpts, false);
+
+      const A3DBridgeTraversalFrame sFrame = sTraversal.m_frames.back();
+      sTraversal.m_frames.pop_back();
+      A3D_BRIDGE_COUNT(A3D_BRIDGE_STATS_OF(pgOpts), m_uiNodes, 1);
+
+      stTraversalUnwind(sTraversal, sFrame.m_uiPathSize, sFrame.m_uiTransform, sFrame.m_uiAttributes);
+
+      switch (sFrame.m_eKind)
+      {
+         case A3DBridgeTraversalFrame::kProductOccurrence:
+            stTraversePOccurrence(sFrame.m_pNode, sTraversal, sFrame, false, pgOpts, logging_function);
+            break;
+         case A3DBridgeTraversalFrame::kPrototype:
+            stTraversePrototype(sFrame.m_pNode, sTraversal, sFrame, pgOpts, logging_function);
+            break;
+         case A3DBridgeTraversalFrame::kPartDefinition:
+            stTraversePartDef(sFrame.m_pNode, sTraversal, sFrame, pgOpts, logging_function);
+            break;
+         case A3DBridgeTraversalFrame::kRepItem:
+            traverseRepItem(sFrame.m_pNode, sTraversal, sFrame, pgOpts, logging_function);
+            break;
+      }
+   }
+
+   stTraversalEndRecordings(sTraversal, pgOpts, logging_function);
+   stTraversalTraceEnd(sTraversal, pgOpts, true);
+
+   // Delete the attributes of the last branch, keeping the caller's
+   stTraversalUnwind(sTraversal, 0, 0, 1);
+   for (auto& entry : sTraversal.m_attributeCache)
+   {
+      A3DMiscCascadedAttributesDelete(entry.second.m_pAttr);
+   }
+   sTraversal.m_attributeCache.clear();
+   return A3D_SUCCESS;
+}
+/***stTraversalRun**************************************************/
+
+#ifdef A3D_BRIDGE_STATS
+/*!
+\brief Returns an estimate of the bytes held by an unordered container: its nodes and its buckets
+*/
+template <typename Container>
+INTERNAL size_t stStatsHashBytes(const Container& container)
+{
+   return container.size() * (sizeof(typename Container::value_type) + 2 * sizeof(void*)) +
+          container.bucket_count() * sizeof(void*);
+}
+/***stStatsHashBytes**************************************************/
+
+/*!
+\brief Completes the counts of pgOpts.m_stats from the outputs of the conversion and logs the statistics
+*/
+INTERNAL void stStatsFinish(A3DPolygonicaOptions& pgOpts,
+                            A3D_log_func logging_function)
+{
+   A3DBridgeStats& sStats = pgOpts.m_stats;
+   sStats.m_uiRepItems = pgOpts.m_parts.size();
+   sStats.m_uiEntities = pgOpts.m_entities.size();
+   sStats.m_uiStyles = pgOpts.m_style_palette.size();
+
+   const A3DBridgeStylePalette& palette = pgOpts.m_style_palette;
+   size_t uiBytes = pgOpts.m_entities.capacity() * sizeof(PTWorldEntity) +
+                    pgOpts.m_paths.capacity() * sizeof(A3DUns32) +
+                    pgOpts.m_topo_faces.capacity() * sizeof(A3DBridgeTopoFace) +
+                    pgOpts.m_path_trie.m_nodes.capacity() * sizeof(void*) +
+                    pgOpts.m_path_trie.m_parents.capacity() * sizeof(A3DUns32) +
+                    palette.m_keys.capacity() * sizeof(A3DUns32) + palette.m_slots.capacity() * sizeof(PTRenderStyle) +
+                    palette.m_styles.capacity() * sizeof(PTRenderStyle) + palette.m_colours.capacity() * sizeof(A3DUns32) +
+                    stStatsHashBytes(pgOpts.m_parts) + stStatsHashBytes(pgOpts.m_part_transforms) +
+                    stStatsHashBytes(pgOpts.m_mesh_table.m_items) + stStatsHashBytes(pgOpts.m_mesh_table.m_congruentItems) +
+                    stStatsHashBytes(pgOpts.m_surface_groups) + stStatsHashBytes(pgOpts.m_topo_face_base);
+   for (const auto& entry : pgOpts.m_surface_groups)
+   {
+      if (entry.second)
+      {
+         uiBytes += sizeof(std::vector<PTEntityGroup>) + entry.second->capacity() * sizeof(PTEntityGroup);
       }
-      default:
+   }
+   uiBytes += stStatsHashBytes(pgOpts.m_surface_faces);
+   for (const auto& entry : pgOpts.m_surface_faces)
+   {
+      for (const std::vector<PTEntity>& bucket : entry.second)
       {
-         iRet = A3D_NOT_IMPLEMENTED;
-         log(logging_function, "traverseRepItem of type " + std::to_string(eType) + " is not implemented", A3D_LOG_WARN);
-         break;
+         uiBytes += sizeof(std::vector<PTEntity>) + bucket.capacity() * sizeof(PTEntity);
       }
    }
-   return iRet;
+   sStats.m_uiContainerBytes = uiBytes;
+
+   static const char* s_apcPhases[A3D_PHASE_COUNT] = { "conversion", "traversal", "Exchange getters", "triangles", "welding",
+                                                       "reordering", "PFSolidCreateFromMesh", "surface groups", "styles", "world entities" };
+   for (int i = 0; i < A3D_PHASE_COUNT; i++)
+   {
+      log(logging_function, std::string("A3DModelCreatePGWorld - stats: ") + s_apcPhases[i] + " wall ms: " +
+          std::to_string(1e-6 * (double)sStats.m_auiWallNs[i]) + ", cpu ms: " + std::to_string(1e-6 * (double)sStats.m_auiCpuNs[i]),
+          A3D_LOG_INFO);
+   }
+   log(logging_function, "A3DModelCreatePGWorld - stats: nodes: " + std::to_string(sStats.m_uiNodes) +
+       ", representation items: " + std::to_string(sStats.m_uiRepItems) + ", solids: " + std::to_string(sStats.m_uiSolids) +
+       ", triangles: " + std::to_string(sStats.m_uiTriangles) + ", world entities: " + std::to_string(sStats.m_uiEntities) +
+       ", styles: " + std::to_string(sStats.m_uiStyles) + ", groups: " + std::to_string(sStats.m_uiGroups) +
+       ", mesh bytes: " + std::to_string(sStats.m_uiMeshBytes) + ", container bytes: " + std::to_string(sStats.m_uiContainerBytes),
+       A3D_LOG_INFO);
 }
-/***traverseRepItem*************************************************/
+/***stStatsFinish*****************************************************/
+#endif
 
-INTERNAL int stTraversePartDef(const A3DAsmPartDefinition* pPart,
-                               std::vector<void*> assemblyPath, 
-                               PTTransformMatrix transform, 
-                               A3DMiscCascadedAttributes* pFatherAttr, 
-                               A3DPolygonicaOptions& pgOpts, 
-                               A3D_log_func logging_function)
+/*!
+\brief Creates a Polygonica world and PTSolids list from the provided model.
+\param pModelFile The model file to parse solids and transforms. Should contain A3DRiPolyBrep or A3DRiBrepModel
+\param A3DPolygonicaOptions [out] opts The structure containing the resultant world populated with solids
+With m_pEntityCallback set, each world entity is passed to the callback as soon as it is added.
+With m_pTracer set, the spans of the conversion are added to the tracer.
+With m_bWeldVertices set, the vertex reduction is in m_uiVerticesBeforeWelding and m_uiVerticesAfterWelding, and
+the times of welding and of PFSolidCreateFromMesh are in the stats below.
+With m_bReorderTriangles set, the triangles of the large, scattered meshes are reordered for locality before
+PFSolidCreateFromMesh; their count is in m_uiReorderedTriangles.
+With m_sMeshCacheDirectory and m_sMeshCacheKey set, the decoded meshes are read from the cache file of the key
+if it exists, else written to it.
+When A3D_BRIDGE_STATS is defined the timings and counts of the conversion are in m_stats and logged.
+\return A3D_SUCCESS - Operation succeeded
+  A3D_PG_NOT_INITIALIZED - Polygonica was not unlocked or initialized correctly
+  A3D_PG_INVALID_RI - Representation item is unsupported type
+  A3D_PG_ERROR - Internal polygonica error
+*/
+INTERNAL int A3DModelCreatePGWorld(const A3DAsmModelFile* pModelFile,
+                                   A3DPolygonicaOptions& pgOpts, 
+                                   A3D_log_func logging_function = nullptr)
 {
-   A3DInt32 iRet = A3D_SUCCESS;
+   A3DStatus iRet = A3D_SUCCESS;
+   A3DBridgeTraceSpan sSpan(pgOpts.m_pTracer, "conversion", "A3DModelCreatePGWorld");
+   pgOpts.m_tStart = std::chrono::steady_clock::now();
+   pgOpts.m_dFirstEntitySeconds = -1.;
+   pgOpts.m_uiVerticesBeforeWelding = pgOpts.m_uiVerticesAfterWelding = pgOpts.m_uiWeldDegenerateTriangles = 0;
+   pgOpts.m_uiReorderedTriangles = 0;
+#ifdef A3D_BRIDGE_STATS
+   pgOpts.m_stats = A3DBridgeStats();
+   A3DBridgePhaseTimer sConversionTimer(&pgOpts.m_stats, A3D_PHASE_CONVERSION);
+#endif
 
+   A3DAsmModelFileData sData;
+   A3D_INITIALIZE_DATA(A3DAsmModelFileData, sData);
+
+   PTTransformMatrix transform;
+   PMInitTransformMatrix(transform);
+
+   // Allocate cascaded attributes
    A3DMiscCascadedAttributes* pAttr;
-   A3DMiscCascadedAttributesData sAttrData;
-   CHECK_A3DSTATUS(stCreateAndPushCascadedAttributes(pPart, pFatherAttr, &pAttr, &sAttrData, logging_function), 
-                   logging_function, "stTraversePartDef - stCreateAndPushCascadedAttributes");
+   CHECK_A3DSTATUS(A3DMiscCascadedAttributesCreate(&pAttr), logging_function, "A3DModelCreatePTWorld");
    const MiscCascadedAttributesGuard sMCAttrGuard(pAttr);
 
-   A3DAsmPartDefinitionData sData;
-   A3D_INITIALIZE_DATA(A3DAsmPartDefinitionData, sData);
+   A3DBridgeTraversal sTraversal;
+   sTraversal.m_transforms.assign(&transform[0][0], &transform[0][0] + 16);
+   sTraversal.m_attributes.push_back(pAttr);
+   sTraversal.m_pathIds.push_back(0);
+   sTraversal.m_bCacheAttributes = pgOpts.m_bCacheAttributes;
+   sTraversal.m_bCheckTransforms = pgOpts.m_bCheckTransforms;
+   if (sTraversal.m_bCacheAttributes)
+   {
+      A3DMiscCascadedAttributesData sAttrData;
+      A3D_INITIALIZE_DATA(A3DMiscCascadedAttributesData, sAttrData);
+      CHECK_A3DSTATUS(A3DMiscCascadedAttributesGet(pAttr, &sAttrData), logging_function, "A3DModelCreatePTWorld - A3DMiscCascadedAttributesGet");
+      sTraversal.m_attributeStyles.push_back(stTraversalStyleId(sTraversal, sAttrData));
+   }
+   else
+   {
+      sTraversal.m_attributeStyles.push_back(0);
+   }
 
-   assemblyPath.push_back((void*)pPart);
+   A3DBridgeMeshCache sMeshCache;
+   if (!pgOpts.m_sMeshCacheDirectory.empty() && !pgOpts.m_sMeshCacheKey.empty())
+   {
+      stMeshCacheOpen(sMeshCache, pgOpts.m_sMeshCacheDirectory, pgOpts.m_sMeshCacheKey, logging_function);
+      pgOpts.m_pMeshCache = &sMeshCache;
+   }
 
-   iRet = A3DAsmPartDefinitionGet(pPart, &sData);
+   // With several threads the traversal only records the instances and the PTSolids are built afterwards
+   A3DBridgeDeferredWork sDeferredWork;
+   if (pgOpts.m_uiThreadCount > 1)
+   {
+      pgOpts.m_pDeferredWork = &sDeferredWork;
+   }
+
+   iRet = A3DAsmModelFileGet(pModelFile, &sData);
    if (iRet == A3D_SUCCESS)
    {
-      A3DUns32 ui;
+      stTraversalPushOccurrences(sTraversal, pgOpts, sData.m_ppPOccurrences, sData.m_uiPOccurrencesSize);
+      CHECK_A3DSTATUS(A3DAsmModelFileGet(NULL, &sData), logging_function, "A3DModelCreatePTWorld - A3DAsmModelFileGet");
+
+      A3D_BRIDGE_TIME_PHASE(A3D_BRIDGE_STATS_OF(pgOpts), A3D_PHASE_TRAVERSAL);
+      stTraversalRun(sTraversal, pgOpts, logging_function);
+   }
+
+   pgOpts.m_uiAttributeCacheLookups = sTraversal.m_uiAttributeLookups;
+   pgOpts.m_uiAttributeCacheHits = sTraversal.m_uiAttributeHits;
+   pgOpts.m_uiColourCallsAvoided = sTraversal.m_colourTable.m_uiCallsAvoided;
+   pgOpts.m_uiTransformMismatches = sTraversal.m_uiTransformMismatches;
+   if (sTraversal.m_colourTable.m_uiCallsAvoided != 0)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - Exchange colour calls avoided: " +
+          std::to_string(sTraversal.m_colourTable.m_uiCallsAvoided), A3D_LOG_INFO);
+   }
+   if (pgOpts.m_style_palette.m_uiMergedColours != 0)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - colours merged into the nearest render style: " +
+          std::to_string(pgOpts.m_style_palette.m_uiMergedColours), A3D_LOG_INFO);
+   }
+   if (sTraversal.m_bCheckTransforms)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - transforms differing from MultiplyMatrix: " +
+          std::to_string(sTraversal.m_uiTransformMismatches), sTraversal.m_uiTransformMismatches ? A3D_LOG_ERROR : A3D_LOG_INFO);
+   }
+   if (sTraversal.m_bCacheAttributes)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - attribute cache hits: " + std::to_string(sTraversal.m_uiAttributeHits) +
+          " of " + std::to_string(sTraversal.m_uiAttributeLookups), A3D_LOG_INFO);
+   }
+
+   if (pgOpts.m_pDeferredWork)
+   {
+      pgOpts.m_pDeferredWork = nullptr;
+
+      // Add the world entities in traversal order as soon as the PTSolids they use are built,
+      // so m_pEntityCallback receives them batch by batch
+      size_t uiNextInstance = 0;
+      auto fnAddEntities = [&](size_t uiItemsBuilt)
+      {
+         const size_t uiReady = uiItemsBuilt < sDeferredWork.m_firstInstances.size() ?
+                                sDeferredWork.m_firstInstances[uiItemsBuilt] : sDeferredWork.m_instances.size();
+         for (; uiNextInstance < uiReady; uiNextInstance++)
+         {
+            A3DBridgeInstance& sInstance = sDeferredWork.m_instances[uiNextInstance];
+            PTTransformMatrix worldTransform;
+            stPartWorldTransform(pgOpts, sInstance.m_pRepItem, &sInstance.m_transform[0][0], worldTransform);
+            stAddWorldEntity(pgOpts.m_parts[sInstance.m_pRepItem], worldTransform,
+                             sInstance.m_afRgb[0], sInstance.m_afRgb[1], sInstance.m_afRgb[2],
+                             sInstance.m_uiPathId, pgOpts, logging_function);
+         }
+      };
 
-      for (ui = 0; ui < sData.m_uiRepItemsSize; ++ui)
+      A3DBridgeThreadPool sPool(pgOpts.m_uiThreadCount);
       {
-         traverseRepItem(sData.m_ppRepItems[ui], assemblyPath, transform, pAttr, pgOpts, logging_function);
+         A3DBridgeTraceSpan sParallelSpan(pgOpts.m_pTracer, "conversion", "stCreatePTSolidsParallel");
+         stCreatePTSolidsParallel(sDeferredWork.m_uniqueItems, sPool, &pgOpts, logging_function, fnAddEntities);
       }
+      // The instances after the last new item, or all of them if every item already had a PTSolid
+      fnAddEntities(sDeferredWork.m_uniqueItems.size());
+   }
 
-      A3DAsmPartDefinitionGet(NULL, &sData);
+   if (pgOpts.m_bWeldVertices)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - vertices welded from " + std::to_string(pgOpts.m_uiVerticesBeforeWelding) +
+          " to " + std::to_string(pgOpts.m_uiVerticesAfterWelding) + ", triangles dropped: " +
+          std::to_string(pgOpts.m_uiWeldDegenerateTriangles), A3D_LOG_INFO);
+   }
+   if (pgOpts.m_bReorderTriangles)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - triangles reordered: " + std::to_string(pgOpts.m_uiReorderedTriangles),
+          A3D_LOG_INFO);
+   }
+
+   pgOpts.m_pMeshCache = nullptr;
+   // The kept meshes may borrow the arrays of the mesh cache file
+   pgOpts.m_mesh_table.m_meshes.clear();
+   pgOpts.m_uiMeshCacheHits = sMeshCache.m_uiHits;
+   if (sMeshCache.m_pcData)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - representation items read from the mesh cache: " +
+          std::to_string(pgOpts.m_uiMeshCacheHits) + " of " + std::to_string(sMeshCache.m_uiNextItem), A3D_LOG_INFO);
+   }
+   stMeshCacheClose(sMeshCache, iRet == A3D_SUCCESS, logging_function);
+
+   if (pgOpts.m_bShareIdenticalMeshes || pgOpts.m_bShareCongruentMeshes)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - representation items sharing the PTSolid of an identical mesh: " +
+          std::to_string(pgOpts.m_mesh_table.m_uiSharedItems) + ", of a congruent mesh: " +
+          std::to_string(pgOpts.m_mesh_table.m_uiCongruentItems) + ", mesh bytes not passed to Polygonica: " +
+          std::to_string(pgOpts.m_mesh_table.m_uiSharedBytes) + ", hash collisions: " +
+          std::to_string(pgOpts.m_mesh_table.m_uiCollisions), A3D_LOG_INFO);
    }
 
-   assemblyPath.pop_back();
+   pgOpts.m_dTotalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - pgOpts.m_tStart).count();
+   if (pgOpts.m_pEntityCallback)
+   {
+      log(logging_function, "A3DModelCreatePGWorld - seconds to the first world entity: " + std::to_string(pgOpts.m_dFirstEntitySeconds) +
+          ", to the last: " + std::to_string(pgOpts.m_dTotalSeconds), A3D_LOG_INFO);
+   }
+
+#ifdef A3D_BRIDGE_STATS
+   sConversionTimer.Stop();
+   stStatsFinish(pgOpts, logging_function);
+#endif
 
    return iRet;
 }
-/***stTraversePartDef***********************************************/
+/***A3DModelCreatePGWorld*******************************************/
 
-INTERNAL int stTraversePOccurrence(const A3DAsmProductOccurrence* pOccurrence,
-                                   std::vector<void*> assemblyPath, 
-                                   PTTransformMatrix transform, 
-                                   A3DMiscCascadedAttributes* pFatherAttr, 
-                                   bool isPrototype, 
-                                   A3DPolygonicaOptions& pgOpts, 
-                                   A3D_log_func logging_function)
+/*!
+\brief A priority for A3DPolygonicaOptions::m_pPriority that visits the subtrees with the largest bounding box first
+\param pOccurrence The product occurrence
+\return The length of the diagonal of its bounding box, 0 if Exchange cannot compute it
+*/
+INTERNAL double A3DBridgeBoundingBoxPriority(const A3DAsmProductOccurrence* pOccurrence,
+                                             void* /*pData*/)
 {
-   A3DInt32 iRet = A3D_SUCCESS;
+   A3DBoundingBoxData sBox;
+   A3D_INITIALIZE_DATA(A3DBoundingBoxData, sBox);
+   if (A3DMiscGetBoundingBox(pOccurrence, &sBox) != A3D_SUCCESS)
+   {
+      return 0.;
+   }
+   double dX = sBox.m_sMax.m_dX - sBox.m_sMin.m_dX;
+   double dY = sBox.m_sMax.m_dY - sBox.m_sMin.m_dY;
+   double dZ = sBox.m_sMax.m_dZ - sBox.m_sMin.m_dZ;
+   return std::sqrt(dX * dX + dY * dY + dZ * dZ);
+}
+/***A3DBridgeBoundingBoxPriority************************************/
 
-   A3DMiscCascadedAttributes* pAttr;
-   A3DMiscCascadedAttributesData sAttrData;
-   CHECK_A3DSTATUS(stCreateAndPushCascadedAttributes(pOccurrence, pFatherAttr, &pAttr, &sAttrData, logging_function), 
-                   logging_function, "stTraversePOccurrence - stCreateAndPushCascadedAttributes");
-   const MiscCascadedAttributesGuard sMCAttrGuard(pAttr);
+/*!
+\brief Returns the nodes of an assembly path
+\param pgOpts The options filled by A3DModelCreatePGWorld
+\param uiPathId The path id, e.g. m_paths[i] for the world entity m_entities[i]
+\param path [out] The product occurrences and part definition of the path, from the root down
+\return A3D_SUCCESS - Operation succeeded
+  A3D_ERROR - The path id is not in m_path_trie
+*/
+INTERNAL A3DStatus A3DBridgeGetPath(const A3DPolygonicaOptions& pgOpts,
+                                    A3DUns32 uiPathId,
+                                    std::vector<void*>& path)
+{
+   const A3DBridgePathTrie& trie = pgOpts.m_path_trie;
+   path.clear();
+   if (uiPathId >= trie.m_nodes.size())
+   {
+      return A3D_ERROR;
+   }
 
-   PTTransformMatrix localTransform;
-   memcpy(localTransform, transform, 16 * sizeof(double));
+   for (A3DUns32 uiId = uiPathId; uiId != 0; uiId = trie.m_parents[uiId])
+   {
+      path.push_back(trie.m_nodes[uiId]);
+   }
+   std::reverse(path.begin(), path.end());
+   return A3D_SUCCESS;
+}
+/***A3DBridgeGetPath************************************************/
 
-   A3DAsmProductOccurrenceData sData;
-   A3D_INITIALIZE_DATA(A3DAsmProductOccurrenceData, sData);
-   iRet = A3DAsmProductOccurrenceGet(pOccurrence, &sData);
+/*!
+\brief Returns the group of the faces of a PTSolid on one CAD surface, creating it on first request
+\param pgOpts [in,out] The options filled by A3DModelCreatePGWorld. The group is kept in m_surface_groups
+\param solid A PTSolid of m_parts
+\param iTopoFace The index of the CAD surface in the tessellation of the representation item
+\param group [out] The group, PV_ENTITY_NULL on failure
+\return A3D_SUCCESS - Operation succeeded
+  A3D_ERROR - The solid has no surface groups or iTopoFace is out of range
+*/
+INTERNAL A3DStatus A3DBridgeGetSurfaceGroup(A3DPolygonicaOptions& pgOpts,
+                                            PTSolid solid,
+                                            long iTopoFace,
+                                            PTEntityGroup* group,
+                                            A3D_log_func logging_function = nullptr)
+{
+   *group = PV_ENTITY_NULL;
 
-   if (iRet == A3D_SUCCESS)
+   auto search = pgOpts.m_surface_groups.find(solid);
+   auto base = pgOpts.m_topo_face_base.find(solid);
+   if (search == pgOpts.m_surface_groups.end() || search->second == NULL || base == pgOpts.m_topo_face_base.end() ||
+       iTopoFace < 0 || iTopoFace >= (long)search->second->size())
    {
-      A3DUns32 ui;
+      log(logging_function, "A3DBridgeGetSurfaceGroup - no surface " + std::to_string(iTopoFace) + " for the solid", A3D_LOG_ERROR);
+      return A3D_ERROR;
+   }
 
-      if (sData.m_pLocation)
+   PTEntityGroup& cached = (*search->second)[iTopoFace];
+   if (cached == PV_ENTITY_NULL)
+   {
+      A3D_BRIDGE_TIME_PHASE(A3D_BRIDGE_STATS_OF(pgOpts), A3D_PHASE_GROUPS);
+      A3D_BRIDGE_COUNT(A3D_BRIDGE_STATS_OF(pgOpts), m_uiGroups, 1);
+      PTStatus status = PFEntityGroupCreate(pgOpts.m_Environment, &cached);
+      CHECK_PTSTATUS(status, logging_function, "A3DBridgeGetSurfaceGroup - PFEntityGroupCreate");
+      if (status != PV_STATUS_OK)
       {
-         A3DEEntityType eType = kA3DTypeUnknown;
-         iRet = A3DEntityGetType(sData.m_pLocation, &eType);
-         if (eType == kA3DTypeMiscCartesianTransformation)
-         {
-            iRet = stTransform(sData.m_pLocation, transform, localTransform, logging_function);
-         }
-         else if (eType == kA3DTypeMiscGeneralTransformation)
-         {
-            log(logging_function, "In stTraversePOccurrence, cannot process location type kA3DTypeMiscGeneralTransformation", A3D_LOG_ERROR);
-         }
-         else
+         cached = PV_ENTITY_NULL;
+         return A3D_ERROR;
+      }
+
+      // The first request for the solid walks its faces once, bucketing them by surface for this and later groups
+      auto bucketed = pgOpts.m_surface_faces.find(solid);
+      if (bucketed == pgOpts.m_surface_faces.end())
+      {
+         const long iSurfaces = (long)search->second->size();
+         bucketed = pgOpts.m_surface_faces.insert(std::make_pair(solid, std::vector<std::vector<PTEntity>>(iSurfaces))).first;
+         PTEntityList faces = PV_ENTITY_NULL;
+         PFEntityCreateEntityList(solid, PV_ENTITY_TYPE_FACE, NULL, &faces);
+         for (PTEntity face = PFEntityListGetFirst(faces); face != PV_ENTITY_NULL; face = PFEntityListGetNext(faces, face))
          {
-            log(logging_function, "In stTraversePOccurrence, the location type " + std::to_string(eType) + " is unknown", A3D_LOG_ERROR);
+            long iFaceTopoFace = (long)((long long)PFEntityGetPointerProperty(face, PV_FACE_PROP_APP_SURFACE) - base->second);
+            if (iFaceTopoFace >= 0 && iFaceTopoFace < iSurfaces)
+            {
+               bucketed->second[iFaceTopoFace].push_back(face);
+            }
          }
+         PFEntityListDestroy(faces, 0);
       }
 
-      if (!isPrototype)
+      // Add the faces of the solid on this surface
+      std::vector<PTEntity>& bucket = bucketed->second[iTopoFace];
+      for (PTEntity face : bucket)
       {
-         assemblyPath.push_back((void*)pOccurrence);
+         PFEntityGroupAddEntity(cached, face);
       }
+      std::vector<PTEntity>().swap(bucket);
+   }
 
-      if (sData.m_pPrototype)
+   *group = cached;
+   return A3D_SUCCESS;
+}
+/***A3DBridgeGetSurfaceGroup****************************************/
+
+/*!
+\brief Finds the CAD surface of a face of a PTSolid built by the bridge, in constant time
+\param pgOpts [in,out] The options filled by A3DModelCreatePGWorld
+\param face The face, e.g. a picked face
+\param sTopoFace [out] The solid and the index of the CAD surface of the face
+\param group [out] If not NULL, the group of the faces on the same CAD surface, see A3DBridgeGetSurfaceGroup
+\return A3D_SUCCESS - Operation succeeded
+  A3D_ERROR - The app surface of the face is not one of the bridge
+*/
+INTERNAL A3DStatus A3DBridgeFindTopoFace(A3DPolygonicaOptions& pgOpts,
+                                         PTFace face,
+                                         A3DBridgeTopoFace& sTopoFace,
+                                         PTEntityGroup* group = NULL,
+                                         A3D_log_func logging_function = nullptr)
+{
+   sTopoFace = A3DBridgeTopoFace();
+   if (group)
+   {
+      *group = PV_ENTITY_NULL;
+   }
+
+   // unsigned long long used to remove compiler warning.
+   auto app_surface_index = (long long)PFEntityGetPointerProperty(face, PV_FACE_PROP_APP_SURFACE);
+   if (app_surface_index < 0 || app_surface_index >= (long long)pgOpts.m_topo_faces.size() ||
+       pgOpts.m_topo_faces[app_surface_index].m_solid == PV_ENTITY_NULL)
+   {
+      log(logging_function, "A3DBridgeFindTopoFace - invalid AppSurface retrieved from PTFace", A3D_LOG_ERROR);
+      return A3D_ERROR;
+   }
+
+   sTopoFace = pgOpts.m_topo_faces[app_surface_index];
+   if (group)
+   {
+      return A3DBridgeGetSurfaceGroup(pgOpts, sTopoFace.m_solid, sTopoFace.m_iTopoFace, group, logging_function);
+   }
+   return A3D_SUCCESS;
+}
+/***A3DBridgeFindTopoFace*******************************************/
+
+/*!
+\brief Appends a string to JSON text as a quoted JSON string
+*/
+INTERNAL void stTraceJsonString(std::string& sJson, const std::string& sText)
+{
+   sJson += '"';
+   for (unsigned char c : sText)
+   {
+      if (c == '"' || c == '\\')
       {
-         stTraversePOccurrence(sData.m_pPrototype, assemblyPath, localTransform, pAttr, true, pgOpts, logging_function);
+         sJson += '\\';
+         sJson += (char)c;
       }
-      else if (sData.m_pExternalData)
+      else if (c < 0x20)
       {
-         stTraversePOccurrence(sData.m_pExternalData, assemblyPath, localTransform, pAttr, true, pgOpts, logging_function);
+         char acEscape[8];
+         snprintf(acEscape, sizeof(acEscape), "\\u%04x", c);
+         sJson += acEscape;
       }
       else
       {
-         for (ui = 0; ui < sData.m_uiPOccurrencesSize; ++ui)
-         {
-            stTraversePOccurrence(sData.m_ppPOccurrences[ui], assemblyPath, localTransform, pAttr, false, pgOpts, logging_function);
-         }
+         sJson += (char)c;
       }
+   }
+   sJson += '"';
+}
+/***stTraceJsonString*********************************************/
 
-      if (sData.m_pPart)
+/*!
+\brief Writes the spans recorded by a tracer as Chrome trace-event JSON, which Perfetto and chrome://tracing load
+Each thread that recorded spans is a track. Call it while no conversion records into the tracer.
+\param tracer The tracer
+\param sJson [out] The JSON document
+*/
+INTERNAL void A3DBridgeTracerJson(const A3DBridgeTracer& tracer,
+                                  std::string& sJson)
+{
+   sJson = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+   bool bFirst = true;
+   char acNumbers[128];
+   for (unsigned uiThread = 0; uiThread < tracer.BufferCount(); uiThread++)
+   {
+      const A3DBridgeTraceBuffer* pBuffer = tracer.m_apBuffers[uiThread].load(std::memory_order_acquire);
+      if (!pBuffer)
       {
-         stTraversePartDef(sData.m_pPart, assemblyPath, localTransform, pAttr, pgOpts, logging_function);
+         continue;
       }
 
-      if (!isPrototype)
+      snprintf(acNumbers, sizeof(acNumbers), "%s\n{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%s %u\"}}",
+               bFirst ? "" : ",", uiThread, uiThread == 0 ? "bridge" : "bridge worker", uiThread);
+      sJson += acNumbers;
+      bFirst = false;
+
+      // Chrome traces take microseconds
+      for (const A3DBridgeTraceEvent& sEvent : pBuffer->m_events)
       {
-         assemblyPath.pop_back();
+         sJson += ",\n{\"ph\":\"X\",\"pid\":1,\"name\":";
+         stTraceJsonString(sJson, sEvent.m_sName);
+         snprintf(acNumbers, sizeof(acNumbers), ",\"cat\":\"%s\",\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"triangles\":%zu}}",
+                  sEvent.m_pcCategory, uiThread, 1e-3 * (double)sEvent.m_uiStartNs, 1e-3 * (double)sEvent.m_uiDurationNs,
+                  sEvent.m_uiTriangles);
+         sJson += acNumbers;
       }
-      CHECK_A3DSTATUS(A3DAsmProductOccurrenceGet(NULL, &sData), logging_function, "stTraversePOccurrence - A3DAsmProductOccurrenceGet");
    }
-
-   return iRet;
+   sJson += "\n]}\n";
 }
-/***stTraversePOccurrence*******************************************/
+/***A3DBridgeTracerJson*******************************************/
 
 /*!
-\brief Creates a Polygonica world and PTSolids list from the provided model.
-\param pModelFile The model file to parse solids and transforms. Should contain A3DRiPolyBrep or A3DRiBrepModel
-\param A3DPolygonicaOptions [out] opts The structure containing the resultant world populated with solids
+\brief Writes the spans recorded by a tracer to a Chrome trace-event JSON file, see A3DBridgeTracerJson
+\param tracer The tracer
+\param pcPath The path of the file
 \return A3D_SUCCESS - Operation succeeded
-  A3D_PG_NOT_INITIALIZED - Polygonica was not unlocked or initialized correctly
-  A3D_PG_INVALID_RI - Representation item is unsupported type
-  A3D_PG_ERROR - Internal polygonica error
+  A3D_ERROR - The file could not be written
 */
-INTERNAL int A3DModelCreatePGWorld(const A3DAsmModelFile* pModelFile,
-                                   A3DPolygonicaOptions& pgOpts, 
-                                   A3D_log_func logging_function = nullptr)
+INTERNAL A3DStatus A3DBridgeTracerWrite(const A3DBridgeTracer& tracer,
+                                        const char* pcPath,
+                                        A3D_log_func logging_function = nullptr)
 {
-   A3DStatus iRet = A3D_SUCCESS;
-
-   A3DAsmModelFileData sData;
-   A3D_INITIALIZE_DATA(A3DAsmModelFileData, sData);
-
-   PTTransformMatrix transform;
-   PMInitTransformMatrix(transform);
+   std::string sJson;
+   A3DBridgeTracerJson(tracer, sJson);
 
-   std::vector<void*> assemblyPath;
+   FILE* pFile = fopen(pcPath, "wb");
+   bool bWritten = pFile && fwrite(sJson.data(), 1, sJson.size(), pFile) == sJson.size();
+   if (pFile && fclose(pFile) != 0)
+   {
+      bWritten = false;
+   }
+   if (!bWritten)
+   {
+      log(logging_function, std::string("A3DBridgeTracerWrite - cannot write ") + pcPath, A3D_LOG_ERROR);
+      return A3D_ERROR;
+   }
+   return A3D_SUCCESS;
+}
+/***A3DBridgeTracerWrite******************************************/
 
-   // Allocate cascaded attributes
-   A3DMiscCascadedAttributes* pAttr;
-   CHECK_A3DSTATUS(A3DMiscCascadedAttributesCreate(&pAttr), logging_function, "A3DModelCreatePTWorld");
-   const MiscCascadedAttributesGuard sMCAttrGuard(pAttr);
+/*!
+\brief Computes a key for A3DPolygonicaOptions::m_sMeshCacheKey from the content of a CAD file and its load parameters
+\param pcPath The CAD file
+\param pLoadParameters [in] The parameters that change the tessellation, hashed as bytes, e.g. &sLoadData.m_sTessellation
+of an A3DRWParamsLoadData initialised with A3D_INITIALIZE_DATA. May be NULL
+\param uiLoadParametersBytes The size of the parameters
+\param sKey [out] The key, 16 hexadecimal digits
+\return A3D_SUCCESS - Operation succeeded
+  A3D_ERROR - The file could not be read
+*/
+INTERNAL A3DStatus A3DBridgeMeshCacheKey(const char* pcPath,
+                                         const void* pLoadParameters,
+                                         size_t uiLoadParametersBytes,
+                                         std::string& sKey,
+                                         A3D_log_func logging_function = nullptr)
+{
+   FILE* pFile = fopen(pcPath, "rb");
+   if (!pFile)
+   {
+      log(logging_function, std::string("A3DBridgeMeshCacheKey - cannot read ") + pcPath, A3D_LOG_ERROR);
+      return A3D_ERROR;
+   }
 
-   iRet = A3DAsmModelFileGet(pModelFile, &sData);
-   if (iRet == A3D_SUCCESS)
+   // The file is hashed in blocks of a fixed size, so the key does not depend on how it is read
+   A3DUns64 uiHash = 14695981039346656037ULL;
+   std::vector<unsigned char> acBlock(1 << 20);
+   size_t uiRead;
+   while ((uiRead = fread(acBlock.data(), 1, acBlock.size(), pFile)) > 0)
    {
-      for (A3DUns32 ui = 0; ui < sData.m_uiPOccurrencesSize; ++ui)
-      {
-         stTraversePOccurrence(sData.m_ppPOccurrences[ui], assemblyPath, transform, pAttr, false, pgOpts, logging_function);
-      }
-      CHECK_A3DSTATUS(A3DAsmModelFileGet(NULL, &sData), logging_function, "A3DModelCreatePTWorld - A3DAsmModelFileGet");
+      stHashBytes(uiHash, acBlock.data(), uiRead);
    }
+   bool bFailed = ferror(pFile) != 0;
+   fclose(pFile);
+   if (bFailed)
+   {
+      log(logging_function, std::string("A3DBridgeMeshCacheKey - cannot read ") + pcPath, A3D_LOG_ERROR);
+      return A3D_ERROR;
+   }
+   if (pLoadParameters)
+   {
+      stHashBytes(uiHash, pLoadParameters, uiLoadParametersBytes);
+   }
+   A3DUns32 uiVersion = A3D_BRIDGE_MESH_CACHE_VERSION;
+   stHashBytes(uiHash, &uiVersion, sizeof(uiVersion));
 
-   return iRet;
+   char acKey[17];
+   snprintf(acKey, sizeof(acKey), "%016llx", (unsigned long long)uiHash);
+   sKey = acKey;
+   return A3D_SUCCESS;
 }
-/***A3DModelCreatePGWorld*******************************************/
+/***A3DBridgeMeshCacheKey*********************************************/
 
 INTERNAL int A3DDestroyBridgeSolids(A3DPolygonicaOptions& bridge_data)
 {
-   /* Destroy PTSolids created by the bridge */
+   /* Destroy PTSolids created by the bridge; items with identical meshes may share one */
+   std::unordered_set<PTSolid> destroyed;
    for (auto i = bridge_data.m_parts.begin();
         i != bridge_data.m_parts.end(); i++)
    {
-      PFSolidDestroy((PTSolid)i->second);
+      if (destroyed.insert(i->second).second)
+      {
+         PFSolidDestroy((PTSolid)i->second);
+      }
    }
    return A3D_SUCCESS;
 }
@@ -1096,6 +5341,8 @@ INTERNAL int A3DDestroyBridgePartsData(A3DPolygonicaOptions& bridge_data)
    // Currently not required as the unordered_map will be cleaned up when it goes out of scope
    // This function left in as it may be required if m_parts is replaced with a non-C++ type
    bridge_data.m_parts.clear();
+   bridge_data.m_mesh_table = A3DBridgeMeshTable();
+   bridge_data.m_part_transforms.clear();
    return A3D_SUCCESS;
 }
 /***A3DDestroyBridgePartsData***************************************/
@@ -1114,14 +5361,11 @@ INTERNAL int A3DDestroyBridgeEntitiesData(A3DPolygonicaOptions& bridge_data)
 INTERNAL int A3DDestroyBridgeStylesData(A3DPolygonicaOptions& bridge_data)
 {
    /* Destroy render styles data created by the bridge in the A3DPolygonicaOptions struct */
-   for (auto i = bridge_data.m_style_palette.begin();
-        i != bridge_data.m_style_palette.end(); i++)
+   for (PTRenderStyle style : bridge_data.m_style_palette.m_styles)
    {
-      PFRenderStyleDestroy((PTRenderStyle)i->second);
+      PFRenderStyleDestroy(style);
    }
-   // Currently not required as the map will be cleaned up when it goes out of scope
-   // This function left in as it may be required if m_style_palette is replaced with a non-C++ type
-   bridge_data.m_style_palette.clear();
+   bridge_data.m_style_palette = A3DBridgeStylePalette();
    return A3D_SUCCESS;
 }
 /***A3DDestroyBridgeStylesData**************************************/
@@ -1133,31 +5377,62 @@ INTERNAL int A3DDestroyBridgeSurfaceGroupsData(A3DPolygonicaOptions& bridge_data
         i != bridge_data.m_surface_groups.end(); i++)
    {
       std::vector <PTEntityGroup>* groups = (std::vector <PTEntityGroup>*)i->second;
+      if (groups == NULL)
+      {
+         continue;
+      }
       for (int topoFace = 0; topoFace < groups->size(); topoFace++)
       {
-         PFEntityGroupDestroy((*groups)[topoFace]);
+         if ((*groups)[topoFace] != PV_ENTITY_NULL)
+         {
+            PFEntityGroupDestroy((*groups)[topoFace]);
+         }
       }
       delete groups;
    }
    // Currently not required as the unordered_map will be cleaned up when it goes out of scope
    // This function left in as it may be required if m_surface_groups is replaced with a non-C++ type
    bridge_data.m_surface_groups.clear();
+   bridge_data.m_surface_faces.clear();
+   bridge_data.m_topo_face_base.clear();
+   bridge_data.m_topo_faces.clear();
    return A3D_SUCCESS;
 }
 /***A3DDestroyBridgeSurfaceGroupsData*******************************/
 
-INTERNAL int A3DDestroyBridgePathsData(A3DPolygonicaOptions& bridge_data)
+INTERNAL int A3DDestroyBridgeSurfaceGroups(A3DPolygonicaOptions& bridge_data)
 {
-   /* Destroy path data created by the bridge in the A3DPolygonicaOptions struct */
-   for (auto i = bridge_data.m_paths.begin(); 
-        i != bridge_data.m_paths.end(); i++)
+   /* Destroy the surface groups created so far, keeping their slots so A3DBridgeGetSurfaceGroup can create them again */
+   for (auto i = bridge_data.m_surface_groups.begin();
+        i != bridge_data.m_surface_groups.end(); i++)
    {
-      std::vector<void*>* path = (std::vector<void*>*)i->second;
-      delete path;
+      std::vector <PTEntityGroup>* groups = (std::vector <PTEntityGroup>*)i->second;
+      if (groups == NULL)
+      {
+         continue;
+      }
+      for (PTEntityGroup& group : *groups)
+      {
+         if (group != PV_ENTITY_NULL)
+         {
+            PFEntityGroupDestroy(group);
+            group = PV_ENTITY_NULL;
+         }
+      }
    }
-   // Currently not required as the unordered_map will be cleaned up when it goes out of scope
+   // Groups created again bucket the faces again
+   bridge_data.m_surface_faces.clear();
+   return A3D_SUCCESS;
+}
+/***A3DDestroyBridgeSurfaceGroups***********************************/
+
+INTERNAL int A3DDestroyBridgePathsData(A3DPolygonicaOptions& bridge_data)
+{
+   /* Destroy path data created by the bridge in the A3DPolygonicaOptions struct */
+   // Currently not required as the vectors will be cleaned up when they go out of scope
    // This function left in as it may be required if m_paths is replaced with a non-C++ type
    bridge_data.m_paths.clear();
+   bridge_data.m_path_trie = A3DBridgePathTrie();
    return A3D_SUCCESS;
 }
 /***A3DDestroyBridgePathsData***************************************/
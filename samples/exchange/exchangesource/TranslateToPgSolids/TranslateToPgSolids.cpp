@@ -69,25 +69,11 @@ void print_name(std::string str, A3D_log_level level)
 
 static PTEntityGroup findRegionFromFaceAppData(PTFace face)
 {
-	PTSolid solid = PFEntityGetEntityProperty(face, PV_FACE_PROP_SOLID);
-	PTEnvironment env = PFEntityGetEntityProperty(solid, PV_SOLID_PROP_ENVIRONMENT);
-	PTEntityGroup region = PV_ENTITY_NULL; 
-
-	
-	void* topoFace = PFEntityGetPointerProperty(face, PV_FACE_PROP_APP_SURFACE);
-	// Use a category to find all the faces with the same topoface, and highlight them
-
-	PTCategoryOpts options;
-	PMInitCategoryOpts(&options);
-	options.fn_face = face_in_category_cb;
-	options.app_data = (PTPointer)topoFace;
-
-	PTCategory category;
-	PFCategoryCreate(env, PV_CRITERION_CALLBACK, &options, &category);
-
-	PFEntityGroupCreate(env, &region);
-	PFEntityGroupCreateFromCategory(solid, category, &region);
-	PFCategoryDestroy(category);
+	// The bridge maps the face's app surface to its topoface and the group of all the faces
+	// on that topoface. The group belongs to the bridge and is destroyed with its data
+	A3DBridgeTopoFace topoFace;
+	PTEntityGroup region = PV_ENTITY_NULL;
+	A3DBridgeFindTopoFace(pgOpts, face, topoFace, &region);
 
 	return region;
 }
@@ -195,11 +181,12 @@ int wmain(A3DInt32 iArgc, A3DUniChar** ppcArgv)
 	// Print entity paths
 	for (int i = 0; i < pgOpts.m_entities.size(); i++)
 	{
-		std::vector<void*>* path = (std::vector<void*> *)pgOpts.m_paths[pgOpts.m_entities[i]];
-		for (int j = 0; j < path->size(); j++)
+		std::vector<void*> path;
+		A3DBridgeGetPath(pgOpts, pgOpts.m_paths[i], path);
+		for (int j = 0; j < path.size(); j++)
 		{
 			A3DEEntityType eType = kA3DTypeUnknown;
-			void* pNode = path->at(j);
+			void* pNode = path[j];
 			A3DEntityGetType(pNode, &eType);
 			if (eType == kA3DTypeAsmProductOccurrence)
 			{
@@ -211,8 +198,6 @@ int wmain(A3DInt32 iArgc, A3DUniChar** ppcArgv)
 		printf("\n");
 	}
 
-	PTEntityGroup oldRegion = PV_ENTITY_NULL;
-
 	do
 	{
 		PTNat32 mouse_x, mouse_y;
@@ -257,9 +242,6 @@ int wmain(A3DInt32 iArgc, A3DUniChar** ppcArgv)
 				PTSolid solid = PFEntityGetEntityProperty(face, PV_FACE_PROP_SOLID);
 				PTEntityGroup selectedRegion = findRegionFromFaceAppData(face);
 				status = PFHighlightCreate(solid, selectedRegion, &highlight);
-				if ( oldRegion != PV_ENTITY_NULL )
-					PFEntityGroupDestroy(oldRegion);
-				oldRegion = selectedRegion;
 			}
 
 			PFEntityGroupDestroy(entityGroup);
@@ -0,0 +1,450 @@
+/*
+*   Description:
+*
+*      HOOPS Exchange stand-in
+*      A minimal, in-memory implementation of the subset of the HOOPS Exchange API
+*      used by the Exchange Polygonica Bridge, its samples and its benchmarks.
+*      The declarations mirror the names, data structures and calling conventions
+*      of the real SDK so that the bridge header compiles unchanged against it.
+*
+*      Entities are created with the A3D*Create functions and read back with the
+*      A3D*Get functions. Getters copy array data exactly as the real SDK does, and
+*      the copies are released with a second call passing a NULL entity.
+*
+*      This is not HOOPS Exchange. It is only intended for building and benchmarking
+*      the bridge on platforms where the real SDK is not available.
+*/
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+/*********************************************************************/
+/***types*************************************************************/
+/*********************************************************************/
+
+typedef void A3DVoid;
+typedef void* A3DPtr;
+typedef char A3DBool;
+typedef char A3DUTF8Char;
+typedef wchar_t A3DUniChar;
+typedef unsigned char A3DUns8;
+typedef unsigned short A3DUns16;
+typedef unsigned int A3DUns32;
+typedef unsigned long long A3DUns64;
+typedef int A3DInt32;
+typedef double A3DDouble;
+typedef int A3DStatus;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* Every Exchange entity is opaque */
+typedef void A3DEntity;
+typedef void A3DRootBase;
+typedef void A3DRootBaseWithGraphics;
+typedef void A3DAsmModelFile;
+typedef void A3DAsmProductOccurrence;
+typedef void A3DAsmPartDefinition;
+typedef void A3DRiRepresentationItem;
+typedef void A3DRiSet;
+typedef void A3DRiBrepModel;
+typedef void A3DRiPolyBrepModel;
+typedef void A3DRiCoordinateSystem;
+typedef void A3DTessBase;
+typedef void A3DTess3D;
+typedef void A3DMiscTransformation;
+typedef void A3DMiscCartesianTransformation;
+typedef void A3DMiscCascadedAttributes;
+typedef void A3DGraphics;
+typedef void A3DGlobal;
+
+/*********************************************************************/
+/***status codes******************************************************/
+/*********************************************************************/
+
+#define A3D_SUCCESS                     0
+#define A3D_ERROR                      -1
+#define A3D_NOT_IMPLEMENTED            -3
+#define A3D_INVALID_DATA_STRUCT_SIZE   -4
+#define A3D_INVALID_DATA_STRUCT_NULL   -5
+#define A3D_INVALID_ENTITY_NULL        -6
+#define A3D_INVALID_ENTITY_TYPE        -7
+#define A3D_LOAD_INVALID_FILE_FORMAT   -1003
+
+#define A3D_DEFAULT_COLOR_INDEX        ((A3DUns32)-1)
+#define A3D_DEFAULT_STYLE_INDEX        ((A3DUns32)-1)
+#define A3D_DEFAULT_MATERIAL_INDEX     ((A3DUns32)-1)
+
+#define A3D_INITIALIZE_DATA(T, S) { memset(&(S), 0, sizeof(T)); (S).m_usStructSize = (A3DUns16)sizeof(T); }
+
+/*********************************************************************/
+/***enums and flags***************************************************/
+/*********************************************************************/
+
+enum A3DEEntityType
+{
+   kA3DTypeUnknown = 0,
+   kA3DTypeAsmModelFile = 301,
+   kA3DTypeAsmProductOccurrence = 302,
+   kA3DTypeAsmPartDefinition = 303,
+   kA3DTypeRiSet = 501,
+   kA3DTypeRiBrepModel = 502,
+   kA3DTypeRiPolyBrepModel = 503,
+   kA3DTypeRiCoordinateSystem = 504,
+   kA3DTypeTess3D = 601,
+   kA3DTypeMiscCartesianTransformation = 701,
+   kA3DTypeMiscGeneralTransformation = 702,
+   kA3DTypeMiscCascadedAttributes = 703,
+   kA3DTypeGraphics = 801
+};
+
+enum A3DEReadGeomTessMode
+{
+   kA3DReadGeomOnly,
+   kA3DReadGeomAndTess,
+   kA3DReadTessOnly
+};
+
+/* A3DTessFaceData::m_usUsedEntitiesFlags */
+#define kA3DTessFaceDataPolyface                        0x0001
+#define kA3DTessFaceDataTriangle                        0x0002
+#define kA3DTessFaceDataTriangleFan                     0x0004
+#define kA3DTessFaceDataTriangleStripe                  0x0008
+#define kA3DTessFaceDataPolyfaceOneNormal               0x0010
+#define kA3DTessFaceDataTriangleOneNormal               0x0020
+#define kA3DTessFaceDataTriangleFanOneNormal            0x0040
+#define kA3DTessFaceDataTriangleStripeOneNormal         0x0080
+#define kA3DTessFaceDataPolyfaceTextured                0x0100
+#define kA3DTessFaceDataTriangleTextured                0x0200
+#define kA3DTessFaceDataTriangleFanTextured             0x0400
+#define kA3DTessFaceDataTriangleStripeTextured          0x0800
+#define kA3DTessFaceDataPolyfaceOneNormalTextured       0x1000
+#define kA3DTessFaceDataTriangleOneNormalTextured       0x2000
+#define kA3DTessFaceDataTriangleFanOneNormalTextured    0x4000
+#define kA3DTessFaceDataTriangleStripeOneNormalTextured 0x8000
+
+/* Fan and stripe point counts in A3DTessFaceData::m_puiSizesTriangulated */
+#define kA3DTessFaceDataNormalSingle                    0x40000000
+#define kA3DTessFaceDataNormalMask                      0x3FFFFFFF
+
+/* A3DMiscCartesianTransformationData::m_ucBehaviour */
+#define kA3DTransformationIdentity                      0x00
+#define kA3DTransformationTranslate                     0x01
+#define kA3DTransformationRotate                        0x02
+#define kA3DTransformationMirror                        0x04
+#define kA3DTransformationScale                         0x08
+#define kA3DTransformationNonUniformScale               0x10
+
+/* A3DGraphicsData::m_usBehaviour */
+#define kA3DGraphicsShow                                0x0001
+#define kA3DGraphicsSonHeritShow                        0x0002
+#define kA3DGraphicsFatherHeritShow                     0x0004
+#define kA3DGraphicsSonHeritColor                       0x0008
+#define kA3DGraphicsFatherHeritColor                    0x0010
+#define kA3DGraphicsRemoved                             0x0100
+
+/*********************************************************************/
+/***data structures***************************************************/
+/*********************************************************************/
+
+struct A3DVector3dData
+{
+   A3DUns16 m_usStructSize;
+   A3DDouble m_dX;
+   A3DDouble m_dY;
+   A3DDouble m_dZ;
+};
+
+struct A3DBoundingBoxData
+{
+   A3DUns16 m_usStructSize;
+   A3DVector3dData m_sMin;
+   A3DVector3dData m_sMax;
+};
+
+struct A3DRootBaseData
+{
+   A3DUns16 m_usStructSize;
+   A3DUTF8Char* m_pcName;
+   A3DUns32 m_uiPersistentId;
+   A3DUns32 m_uiNonPersistentId;
+};
+
+struct A3DGraphicsData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns32 m_uiLayerIndex;
+   A3DUns32 m_uiStyleIndex;
+   A3DUns16 m_usBehaviour;
+};
+
+struct A3DRootBaseWithGraphicsData
+{
+   A3DUns16 m_usStructSize;
+   A3DGraphics* m_pGraphics;
+};
+
+struct A3DGraphStyleData
+{
+   A3DUns16 m_usStructSize;
+   A3DDouble m_dWidth;
+   A3DBool m_bVPicture;
+   A3DUns32 m_uiLinePatternIndex;
+   A3DBool m_bMaterial;
+   A3DUns32 m_uiRgbColorIndex;
+   A3DBool m_bIsTransparencyDefined;
+   A3DUns8 m_ucTransparency;
+   A3DBool m_bSpecialCulling;
+   A3DBool m_bFrontCulling;
+   A3DBool m_bBackCulling;
+   A3DBool m_bNoLight;
+};
+
+struct A3DGraphRgbColorData
+{
+   A3DUns16 m_usStructSize;
+   A3DDouble m_dRed;
+   A3DDouble m_dGreen;
+   A3DDouble m_dBlue;
+};
+
+struct A3DGraphMaterialData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns32 m_uiAmbient;
+   A3DUns32 m_uiDiffuse;
+   A3DUns32 m_uiEmissive;
+   A3DUns32 m_uiSpecular;
+   A3DDouble m_dAmbientAlpha;
+   A3DDouble m_dDiffuseAlpha;
+   A3DDouble m_dEmissiveAlpha;
+   A3DDouble m_dSpecularAlpha;
+   A3DDouble m_dShininess;
+};
+
+struct A3DGlobalData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns32 m_uiColorsSize;
+   A3DUns32 m_uiPicturesSize;
+   A3DUns32 m_uiTextureDefinitionsSize;
+   A3DUns32 m_uiMaterialsSize;
+   A3DUns32 m_uiTextureApplicationsSize;
+   A3DUns32 m_uiLinePatternsSize;
+   A3DUns32 m_uiStylesSize;
+};
+
+struct A3DMiscCascadedAttributesData
+{
+   A3DUns16 m_usStructSize;
+   A3DBool m_bShow;
+   A3DBool m_bRemoved;
+   A3DUns16 m_usLayer;
+   A3DGraphStyleData m_sStyle;
+};
+
+struct A3DMiscCartesianTransformationData
+{
+   A3DUns16 m_usStructSize;
+   A3DVector3dData m_sOrigin;
+   A3DVector3dData m_sXVector;
+   A3DVector3dData m_sYVector;
+   A3DVector3dData m_sScale;
+   A3DUns8 m_ucBehaviour;
+};
+
+struct A3DAsmModelFileData
+{
+   A3DUns16 m_usStructSize;
+   A3DBool m_bUnitFromCAD;
+   A3DDouble m_dUnit;
+   A3DUns32 m_uiPOccurrencesSize;
+   A3DAsmProductOccurrence** m_ppPOccurrences;
+};
+
+struct A3DAsmProductOccurrenceData
+{
+   A3DUns16 m_usStructSize;
+   A3DAsmPartDefinition* m_pPart;
+   A3DAsmProductOccurrence* m_pPrototype;
+   A3DAsmProductOccurrence* m_pExternalData;
+   A3DUns32 m_uiPOccurrencesSize;
+   A3DAsmProductOccurrence** m_ppPOccurrences;
+   A3DMiscTransformation* m_pLocation;
+   A3DUns8 m_ucBehaviour;
+   A3DUns32 m_uiProductFlags;
+};
+
+struct A3DAsmPartDefinitionData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns32 m_uiRepItemsSize;
+   A3DRiRepresentationItem** m_ppRepItems;
+};
+
+struct A3DRiSetData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns32 m_uiRepItemsSize;
+   A3DRiRepresentationItem** m_ppRepItems;
+};
+
+struct A3DRiRepresentationItemData
+{
+   A3DUns16 m_usStructSize;
+   A3DTessBase* m_pTessBase;
+   A3DRiCoordinateSystem* m_pCoordinateSystem;
+};
+
+struct A3DRiPolyBrepModelData
+{
+   A3DUns16 m_usStructSize;
+   A3DBool m_bIsClosed;
+};
+
+struct A3DRiBrepModelData
+{
+   A3DUns16 m_usStructSize;
+   A3DBool m_bSolid;
+};
+
+struct A3DRiCoordinateSystemData
+{
+   A3DUns16 m_usStructSize;
+   A3DMiscTransformation* m_pTransformation;
+};
+
+struct A3DTessBaseData
+{
+   A3DUns16 m_usStructSize;
+   A3DBool m_bIsCalculated;
+   A3DUns32 m_uiCoordSize;
+   A3DDouble* m_pdCoords;
+};
+
+struct A3DTessFaceData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns16 m_usUsedEntitiesFlags;
+   A3DUns32 m_uiStartTriangulated;
+   A3DUns32 m_uiSizesTriangulatedSize;
+   A3DUns32* m_puiSizesTriangulated;
+   A3DUns32 m_uiStartWire;
+   A3DUns32 m_uiSizesWiresSize;
+   A3DUns32* m_puiSizesWires;
+   A3DUns32 m_uiStyleIndexesSize;
+   A3DUns32* m_puiStyleIndexes;
+   A3DUns32 m_uiRGBAVerticesSize;
+   A3DUns8* m_pucRGBAVertices;
+   A3DBool m_bIsRGBA;
+   A3DUns32 m_uiTextureCoordIndexesSize;
+   A3DBool m_bOptimized;
+};
+
+struct A3DTess3DData
+{
+   A3DUns16 m_usStructSize;
+   A3DUns32 m_uiNormalSize;
+   A3DDouble* m_pdNormals;
+   A3DUns32 m_uiWireIndexSize;
+   A3DUns32* m_puiWireIndexes;
+   A3DUns32 m_uiTriangulatedIndexSize;
+   A3DUns32* m_puiTriangulatedIndexes;
+   A3DUns32 m_uiFaceTessSize;
+   A3DTessFaceData* m_psFaceTessData;
+   A3DUns32 m_uiTextureCoordSize;
+   A3DDouble* m_pdTextureCoords;
+   A3DBool m_bHasFaces;
+   A3DBool m_bMustRecalculateNormals;
+};
+
+/*********************************************************************/
+/***functions*********************************************************/
+/*********************************************************************/
+
+const A3DUTF8Char* A3DMiscGetErrorMsg(A3DStatus eStatus);
+
+A3DStatus A3DEntityGetType(const A3DEntity* pEntity, A3DEEntityType* peEntityType);
+
+A3DStatus A3DRootBaseGet(const A3DRootBase* pRootBase, A3DRootBaseData* pData);
+A3DStatus A3DRootBaseSet(A3DRootBase* pRootBase, const A3DRootBaseData* pData);
+A3DStatus A3DRootBaseWithGraphicsGet(const A3DRootBaseWithGraphics* pBase, A3DRootBaseWithGraphicsData* pData);
+A3DStatus A3DRootBaseWithGraphicsSet(A3DRootBaseWithGraphics* pBase, const A3DRootBaseWithGraphicsData* pData);
+A3DStatus A3DGraphicsCreate(const A3DGraphicsData* pData, A3DGraphics** ppGraphics);
+A3DStatus A3DGraphicsGet(const A3DGraphics* pGraphics, A3DGraphicsData* pData);
+
+A3DStatus A3DGlobalGetPointer(A3DGlobal** ppGlobal);
+A3DStatus A3DGlobalGet(const A3DGlobal* pGlobal, A3DGlobalData* pData);
+A3DStatus A3DGlobalInsertGraphRgbColor(const A3DGraphRgbColorData* pData, A3DUns32* puiIndex);
+A3DStatus A3DGlobalInsertGraphMaterial(const A3DGraphMaterialData* pData, A3DUns32* puiIndex);
+A3DStatus A3DGlobalInsertGraphStyle(const A3DGraphStyleData* pData, A3DUns32* puiIndex);
+A3DStatus A3DGlobalGetGraphRgbColorData(A3DUns32 uiIndexRgbColor, A3DGraphRgbColorData* pData);
+A3DStatus A3DGlobalGetGraphMaterialData(A3DUns32 uiIndexMaterial, A3DGraphMaterialData* pData);
+A3DStatus A3DGlobalGetGraphStyleData(A3DUns32 uiIndexStyle, A3DGraphStyleData* pData);
+A3DStatus A3DGlobalIsMaterialTexture(A3DUns32 uiIndexMaterial, A3DBool* pbIsTexture);
+
+A3DStatus A3DMiscCascadedAttributesCreate(A3DMiscCascadedAttributes** ppAttr);
+A3DStatus A3DMiscCascadedAttributesPush(A3DMiscCascadedAttributes* pAttr,
+                                        const A3DRootBaseWithGraphics* pBase,
+                                        const A3DMiscCascadedAttributes* pFather);
+A3DStatus A3DMiscCascadedAttributesGet(const A3DMiscCascadedAttributes* pAttr, A3DMiscCascadedAttributesData* pData);
+A3DStatus A3DMiscCascadedAttributesDelete(A3DMiscCascadedAttributes* pAttr);
+
+A3DStatus A3DMiscGetBoundingBox(const A3DEntity* pEntity, A3DBoundingBoxData* pData);
+
+A3DStatus A3DMiscCartesianTransformationCreate(const A3DMiscCartesianTransformationData* pData,
+                                               A3DMiscCartesianTransformation** ppTransformation);
+A3DStatus A3DMiscCartesianTransformationGet(const A3DMiscCartesianTransformation* pTransformation,
+                                            A3DMiscCartesianTransformationData* pData);
+
+A3DStatus A3DAsmModelFileCreate(const A3DAsmModelFileData* pData, A3DAsmModelFile** ppModelFile);
+A3DStatus A3DAsmModelFileGet(const A3DAsmModelFile* pModelFile, A3DAsmModelFileData* pData);
+A3DStatus A3DAsmModelFileDelete(A3DAsmModelFile* pModelFile);
+
+A3DStatus A3DAsmProductOccurrenceCreate(const A3DAsmProductOccurrenceData* pData,
+                                        A3DAsmProductOccurrence** ppOccurrence);
+A3DStatus A3DAsmProductOccurrenceGet(const A3DAsmProductOccurrence* pOccurrence,
+                                     A3DAsmProductOccurrenceData* pData);
+
+A3DStatus A3DAsmPartDefinitionCreate(const A3DAsmPartDefinitionData* pData, A3DAsmPartDefinition** ppPart);
+A3DStatus A3DAsmPartDefinitionGet(const A3DAsmPartDefinition* pPart, A3DAsmPartDefinitionData* pData);
+
+A3DStatus A3DRiSetCreate(const A3DRiSetData* pData, A3DRiSet** ppSet);
+A3DStatus A3DRiSetGet(const A3DRiSet* pSet, A3DRiSetData* pData);
+
+A3DStatus A3DRiPolyBrepModelCreate(const A3DRiPolyBrepModelData* pData, A3DRiPolyBrepModel** ppPolyBrep);
+A3DStatus A3DRiBrepModelCreate(const A3DRiBrepModelData* pData, A3DRiBrepModel** ppBrep);
+A3DStatus A3DRiRepresentationItemGet(const A3DRiRepresentationItem* pRi, A3DRiRepresentationItemData* pData);
+A3DStatus A3DRiRepresentationItemSet(A3DRiRepresentationItem* pRi, const A3DRiRepresentationItemData* pData);
+
+A3DStatus A3DRiCoordinateSystemCreate(const A3DRiCoordinateSystemData* pData,
+                                      A3DRiCoordinateSystem** ppCoordinateSystem);
+A3DStatus A3DRiCoordinateSystemGet(const A3DRiCoordinateSystem* pCoordinateSystem,
+                                   A3DRiCoordinateSystemData* pData);
+
+A3DStatus A3DTess3DCreate(const A3DTess3DData* pData, A3DTess3D** ppTess3D);
+A3DStatus A3DTess3DGet(const A3DTess3D* pTess3D, A3DTess3DData* pData);
+A3DStatus A3DTessBaseSet(A3DTessBase* pTessBase, const A3DTessBaseData* pData);
+A3DStatus A3DTessBaseGet(const A3DTessBase* pTessBase, A3DTessBaseData* pData);
+
+/*********************************************************************/
+/***loader************************************************************/
+/*********************************************************************/
+
+/* Nothing to load: the stand-in functions are linked in. The loader keeps sample and benchmark code identical to
+   the one built against HOOPS Exchange */
+#ifdef INITIALIZE_A3D_API
+struct A3DSDKHOOPSExchangeLoader
+{
+   explicit A3DSDKHOOPSExchangeLoader(const A3DUTF8Char* /*pcLibraryPath*/, const A3DUTF8Char* /*pcLicense*/ = nullptr)
+   {}
+
+   A3DStatus m_eSDKStatus = A3D_SUCCESS;
+   A3DAsmModelFile* m_psModelFile = nullptr;
+};
+#endif
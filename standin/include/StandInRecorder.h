@@ -0,0 +1,47 @@
+/*
+*   Description:
+*
+*      Exchange and Polygonica stand-in recorder
+*      Every stand-in A3D and PF function counts its calls. These functions
+*      read and reset the counters, and report the memory held by live
+*      Polygonica stand-in entities so benchmarks can measure bridge behaviour.
+*/
+#pragma once
+
+#include <A3DSDKIncludes.h>
+
+#include <stdio.h>
+#include <vector>
+
+struct StandInCallCount
+{
+   const char* m_pcName;
+   unsigned long long m_ullCount;
+};
+/***StandInCallCount**************************************************/
+
+/* Counts of every stand-in function called at least once since the last reset */
+std::vector<StandInCallCount> StandInGetCallCounts();
+/* Count for one function, e.g. "A3DTess3DGet" or "PFSolidCreateFromMesh" */
+unsigned long long StandInGetCallCount(const char* pcName);
+/* Total of all A3D* (Exchange) or PF* (Polygonica) calls */
+unsigned long long StandInGetExchangeCallCount();
+unsigned long long StandInGetPolygonicaCallCount();
+void StandInResetCallCounts();
+void StandInPrintCallCounts(FILE* pFile);
+
+/* Bytes and entities currently held by Polygonica stand-in entities */
+size_t StandInGetLivePGBytes();
+size_t StandInGetLivePGEntities();
+/* Number of coincident vertices PFSolidCreateFromMesh stitched since the last reset */
+unsigned long long StandInGetStitchedVertexCount();
+
+/* Corner points and first-corner normal of a face created by PFSolidCreateFromMesh; false for other entities */
+bool StandInGetFaceGeometry(void* pFace, double adPoints[9], double adNormal[3]);
+/* The transform set on a world entity */
+bool StandInGetWorldEntityTransform(void* pWorldEntity, double adTransform[16]);
+
+/* Adds a texture application to the material index space; A3DGlobalIsMaterialTexture reports it as a texture */
+A3DStatus StandInGlobalInsertTextureMaterial(A3DUns32* puiIndex);
+/* Clears the global colour, material and style tables */
+void StandInGlobalReset();
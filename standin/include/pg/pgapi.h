@@ -0,0 +1,182 @@
+/*
+*   Description:
+*
+*      Polygonica stand-in
+*      A minimal, in-memory implementation of the subset of the Polygonica API
+*      used by the Exchange Polygonica Bridge, its samples and its benchmarks.
+*      The declarations mirror the names, option structures and calling conventions
+*      of the real SDK so that the bridge header compiles unchanged against it.
+*
+*      Every PF call is counted, see StandInRecorder.h.
+*
+*      This is not Polygonica. It is only intended for building and benchmarking
+*      the bridge on platforms where the real SDK is not available.
+*/
+#pragma once
+
+#include <stddef.h>
+
+/*********************************************************************/
+/***types*************************************************************/
+/*********************************************************************/
+
+typedef int PTStatus;
+typedef int PTBoolean;
+typedef int PTInt32;
+typedef unsigned int PTNat32;
+typedef unsigned long long PTNat64;
+typedef float PTFloat;
+typedef double PTDouble;
+typedef void* PTPointer;
+
+typedef PTDouble PTPoint[3];
+typedef PTDouble PTVector[3];
+typedef PTDouble PTBounds[6];
+typedef PTDouble PTTransformMatrix[4][4];
+
+/* Every Polygonica entity is opaque */
+typedef void* PTEntity;
+typedef PTEntity PTEnvironment;
+typedef PTEntity PTWorld;
+typedef PTEntity PTWorldEntity;
+typedef PTEntity PTSolid;
+typedef PTEntity PTFace;
+typedef PTEntity PTEntityGroup;
+typedef PTEntity PTEntityList;
+typedef PTEntity PTCategory;
+typedef PTEntity PTRenderStyle;
+typedef PTEntity PTPolygonStyle;
+typedef PTEntity PTEdgeStyle;
+
+#define PV_ENTITY_NULL 0
+
+/*********************************************************************/
+/***status codes******************************************************/
+/*********************************************************************/
+
+#define PV_STATUS_OK                   0x0000
+#define PV_STATUS_BAD_CALL             0x0001
+#define PV_STATUS_MEMORY               0x0002
+#define PV_STATUS_EXCEPTION            0x0004
+#define PV_STATUS_FILE_IO              0x0008
+#define PV_STATUS_INTERRUPT            0x0010
+#define PV_STATUS_INTERNAL_ERROR       0x0020
+
+#define PM_STATUS_FROM_API_ERROR_CODE(c) ((c) & 0xFF)
+#define PM_FN_FROM_API_ERROR_CODE(c)     (((c) >> 8) & 0xFFF)
+#define PM_ERR_FROM_API_ERROR_CODE(c)    (((c) >> 20) & 0xFFF)
+
+/*********************************************************************/
+/***properties and enums**********************************************/
+/*********************************************************************/
+
+enum
+{
+   PV_ENV_PROP_ERROR_REPORT_CB = 1,
+   PV_SOLID_PROP_APP_DATA,
+   PV_SOLID_PROP_ENVIRONMENT,
+   PV_FACE_PROP_APP_SURFACE,
+   PV_FACE_PROP_SOLID,
+   PV_WENTITY_PROP_STYLE,
+   PV_WENTITY_PROP_ENTITY,
+   PV_WORLD_PROP_BOUNDS,
+   PV_RSTYLE_PROP_POLYGON_STYLE,
+   PV_RSTYLE_PROP_EDGE_STYLE,
+   PV_PSTYLE_PROP_COLOUR,
+   PV_PSTYLE_PROP_BACK_COLOUR,
+   PV_PSTYLE_PROP_TRANSPARENCY,
+   PV_PSTYLE_PROP_2_SIDES,
+   PV_ESTYLE_PROP_COLOUR,
+   PV_HLIGHT_PROP_STYLE
+};
+
+enum
+{
+   PV_ENTITY_TYPE_FACE = 1,
+   PV_ENTITY_TYPE_SOLID,
+   PV_ENTITY_TYPE_WORLD_ENTITY
+};
+
+enum
+{
+   PV_COLOUR_SINGLE_RGB_ARRAY = 1,
+   PV_COLOUR_DOUBLE_RGB_ARRAY
+};
+
+#define PV_LICENSE "stand-in"
+
+/*********************************************************************/
+/***option structures*************************************************/
+/*********************************************************************/
+
+struct PTInitialiseOpts
+{
+   PTNat32 n_threads;
+};
+
+struct PTEnvironmentOpts
+{
+   PTPointer app_data;
+};
+
+struct PTWorldOpts
+{
+   PTPointer app_data;
+};
+
+struct PTMeshSolidOpts
+{
+   PTVector* normals;
+   PTInt32* normal_indices;
+   PTPointer* app_surfaces;
+   PTBoolean allow_open;
+};
+
+/*********************************************************************/
+/***functions*********************************************************/
+/*********************************************************************/
+
+void PMInitInitialiseOpts(PTInitialiseOpts* opts);
+void PMInitEnvironmentOpts(PTEnvironmentOpts* opts);
+void PMInitMeshSolidOpts(PTMeshSolidOpts* opts);
+void PMInitTransformMatrix(PTTransformMatrix matrix);
+
+PTStatus PFInitialise(const char* licence, PTInitialiseOpts* opts);
+PTStatus PFTerminate();
+
+PTStatus PFEnvironmentCreate(PTEnvironmentOpts* opts, PTEnvironment* env);
+PTStatus PFEnvironmentDestroy(PTEnvironment env);
+
+PTStatus PFWorldCreate(PTEnvironment env, PTWorldOpts* opts, PTWorld* world);
+PTStatus PFWorldDestroy(PTWorld world);
+PTStatus PFWorldAddEntity(PTWorld world, PTEntity entity, PTWorldEntity* world_entity);
+PTStatus PFWorldRemoveEntity(PTWorldEntity world_entity);
+PTStatus PFWorldEntitySetTransform(PTWorldEntity world_entity, PTTransformMatrix matrix, PTPointer opts);
+
+PTStatus PFSolidCreateFromMesh(PTEnvironment env,
+                               PTNat32 n_faces,
+                               PTNat32* n_loops,
+                               PTNat32* n_vertices,
+                               PTNat32* indices,
+                               PTDouble* vertices,
+                               PTMeshSolidOpts* opts,
+                               PTSolid* solid);
+PTStatus PFSolidDestroy(PTSolid solid);
+
+PTStatus PFEntityGroupCreate(PTEnvironment env, PTEntityGroup* group);
+PTStatus PFEntityGroupAddEntity(PTEntityGroup group, PTEntity entity);
+PTStatus PFEntityGroupDestroy(PTEntityGroup group);
+
+PTStatus PFEntityCreateEntityList(PTEntity entity, PTNat32 type, PTPointer opts, PTEntityList* list);
+PTEntity PFEntityListGetFirst(PTEntityList list);
+PTEntity PFEntityListGetNext(PTEntityList list, PTEntity entity);
+PTStatus PFEntityListDestroy(PTEntityList list, PTNat32 flags);
+
+PTPointer PFEntityGetPointerProperty(PTEntity entity, PTNat32 property);
+PTStatus PFEntitySetPointerProperty(PTEntity entity, PTNat32 property, PTPointer value);
+PTEntity PFEntityGetEntityProperty(PTEntity entity, PTNat32 property);
+PTStatus PFEntitySetEntityProperty(PTEntity entity, PTNat32 property, PTEntity value);
+PTStatus PFEntitySetColourProperty(PTEntity entity, PTNat32 property, PTNat32 type, const void* colour);
+PTStatus PFEntitySetNat32Property(PTEntity entity, PTNat32 property, PTNat32 value);
+PTStatus PFEntitySetBooleanProperty(PTEntity entity, PTNat32 property, PTBoolean value);
+PTStatus PFEntityGetBoundsProperty(PTEntity entity, PTNat32 property, PTBounds bounds);
@@ -0,0 +1,14 @@
+/*
+*   Description:
+*
+*      Polygonica stand-in
+*      Render styles. See pgapi.h.
+*/
+#pragma once
+
+#include "pgapi.h"
+
+PTStatus PFRenderStyleCreate(PTEnvironment env, PTRenderStyle* style);
+PTStatus PFRenderStyleDestroy(PTRenderStyle style);
+PTStatus PFPolygonStyleCreate(PTEnvironment env, PTPolygonStyle* style);
+PTStatus PFPolygonStyleDestroy(PTPolygonStyle style);
@@ -0,0 +1,898 @@
+/*
+*   Description:
+*
+*      HOOPS Exchange stand-in
+*      In-memory PRC-like entities and the A3D functions the bridge calls.
+*      See A3DSDKIncludes.h.
+*/
+
+#include "StandInRecorderInternal.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*********************************************************************/
+/***entities**********************************************************/
+/*********************************************************************/
+
+namespace
+{
+   struct SIEntity
+   {
+      explicit SIEntity(A3DEEntityType eType) : m_eType(eType) {}
+      virtual ~SIEntity() {}
+
+      A3DEEntityType m_eType;
+      std::string m_sName;
+      A3DGraphics* m_pGraphics = NULL;
+   };
+
+   struct SIGraphics : SIEntity
+   {
+      SIGraphics() : SIEntity(kA3DTypeGraphics) {}
+      A3DGraphicsData m_sData;
+   };
+
+   struct SIModelFile : SIEntity
+   {
+      SIModelFile() : SIEntity(kA3DTypeAsmModelFile) {}
+      std::vector<A3DAsmProductOccurrence*> m_apOccurrences;
+   };
+
+   struct SIOccurrence : SIEntity
+   {
+      SIOccurrence() : SIEntity(kA3DTypeAsmProductOccurrence) {}
+      A3DAsmPartDefinition* m_pPart = NULL;
+      A3DAsmProductOccurrence* m_pPrototype = NULL;
+      A3DAsmProductOccurrence* m_pExternalData = NULL;
+      std::vector<A3DAsmProductOccurrence*> m_apOccurrences;
+      A3DMiscTransformation* m_pLocation = NULL;
+   };
+
+   struct SIPartDefinition : SIEntity
+   {
+      SIPartDefinition() : SIEntity(kA3DTypeAsmPartDefinition) {}
+      std::vector<A3DRiRepresentationItem*> m_apRepItems;
+   };
+
+   struct SIRepresentationItem : SIEntity
+   {
+      explicit SIRepresentationItem(A3DEEntityType eType) : SIEntity(eType) {}
+      A3DTessBase* m_pTessBase = NULL;
+      A3DRiCoordinateSystem* m_pCoordinateSystem = NULL;
+   };
+
+   struct SISet : SIRepresentationItem
+   {
+      SISet() : SIRepresentationItem(kA3DTypeRiSet) {}
+      std::vector<A3DRiRepresentationItem*> m_apRepItems;
+   };
+
+   struct SICoordinateSystem : SIEntity
+   {
+      SICoordinateSystem() : SIEntity(kA3DTypeRiCoordinateSystem) {}
+      A3DMiscTransformation* m_pTransformation = NULL;
+   };
+
+   struct SITransformation : SIEntity
+   {
+      SITransformation() : SIEntity(kA3DTypeMiscCartesianTransformation) {}
+      A3DMiscCartesianTransformationData m_sData;
+   };
+
+   struct SIFace
+   {
+      A3DTessFaceData m_sData;
+      std::vector<A3DUns32> m_auiSizes;
+   };
+
+   struct SITess : SIEntity
+   {
+      SITess() : SIEntity(kA3DTypeTess3D) {}
+      std::vector<A3DDouble> m_adCoords;
+      std::vector<A3DDouble> m_adNormals;
+      std::vector<A3DDouble> m_adTextureCoords;
+      std::vector<A3DUns32> m_auiTriangulatedIndexes;
+      std::vector<SIFace> m_asFaces;
+   };
+
+   struct SICascadedAttributes
+   {
+      A3DMiscCascadedAttributesData m_sData;
+      bool m_bColorLocked = false;
+   };
+
+   struct SIMaterial
+   {
+      A3DGraphMaterialData m_sData;
+      bool m_bTexture;
+   };
+
+   struct SIGlobal
+   {
+      std::vector<A3DGraphRgbColorData> m_asColors;
+      std::vector<SIMaterial> m_asMaterials;
+      std::vector<A3DGraphStyleData> m_asStyles;
+   };
+
+   SIGlobal& GetGlobal()
+   {
+      static SIGlobal sGlobal;
+      return sGlobal;
+   }
+
+   SIEntity* AsEntity(const void* pEntity)
+   {
+      return static_cast<SIEntity*>(const_cast<void*>(pEntity));
+   }
+
+   template <typename T>
+   T* As(const void* pEntity, A3DEEntityType eType)
+   {
+      SIEntity* pBase = AsEntity(pEntity);
+      return (pBase && pBase->m_eType == eType) ? static_cast<T*>(pBase) : NULL;
+   }
+
+   SIRepresentationItem* AsRepresentationItem(const void* pEntity)
+   {
+      SIEntity* pBase = AsEntity(pEntity);
+      if (pBase && (pBase->m_eType == kA3DTypeRiBrepModel || pBase->m_eType == kA3DTypeRiPolyBrepModel || pBase->m_eType == kA3DTypeRiSet))
+      {
+         return static_cast<SIRepresentationItem*>(pBase);
+      }
+      return NULL;
+   }
+
+   template <typename T>
+   T* CopyArray(const T* pSource, A3DUns32 uiSize)
+   {
+      if (!uiSize || !pSource)
+      {
+         return NULL;
+      }
+      T* pCopy = static_cast<T*>(malloc(uiSize * sizeof(T)));
+      memcpy(pCopy, pSource, uiSize * sizeof(T));
+      return pCopy;
+   }
+
+   void InitStyle(A3DGraphStyleData& sStyle)
+   {
+      A3D_INITIALIZE_DATA(A3DGraphStyleData, sStyle);
+      sStyle.m_uiRgbColorIndex = A3D_DEFAULT_COLOR_INDEX;
+      sStyle.m_uiLinePatternIndex = A3D_DEFAULT_STYLE_INDEX;
+      sStyle.m_dWidth = 1.;
+   }
+}
+
+/*********************************************************************/
+/***base and graphics*************************************************/
+/*********************************************************************/
+
+const A3DUTF8Char* A3DMiscGetErrorMsg(A3DStatus eStatus)
+{
+   STANDIN_RECORD_CALL("A3DMiscGetErrorMsg");
+   switch (eStatus)
+   {
+      case A3D_SUCCESS: return "A3D_SUCCESS";
+      case A3D_NOT_IMPLEMENTED: return "A3D_NOT_IMPLEMENTED";
+      case A3D_INVALID_DATA_STRUCT_SIZE: return "A3D_INVALID_DATA_STRUCT_SIZE";
+      case A3D_INVALID_DATA_STRUCT_NULL: return "A3D_INVALID_DATA_STRUCT_NULL";
+      case A3D_INVALID_ENTITY_NULL: return "A3D_INVALID_ENTITY_NULL";
+      case A3D_INVALID_ENTITY_TYPE: return "A3D_INVALID_ENTITY_TYPE";
+      case A3D_LOAD_INVALID_FILE_FORMAT: return "A3D_LOAD_INVALID_FILE_FORMAT";
+      default: return "A3D_ERROR";
+   }
+}
+
+A3DStatus A3DEntityGetType(const A3DEntity* pEntity, A3DEEntityType* peEntityType)
+{
+   STANDIN_RECORD_CALL("A3DEntityGetType");
+   if (!pEntity)
+   {
+      *peEntityType = kA3DTypeUnknown;
+      return A3D_INVALID_ENTITY_NULL;
+   }
+   *peEntityType = AsEntity(pEntity)->m_eType;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRootBaseGet(const A3DRootBase* pRootBase, A3DRootBaseData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRootBaseGet");
+   if (!pRootBase)
+   {
+      free(pData->m_pcName);
+      A3D_INITIALIZE_DATA(A3DRootBaseData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SIEntity* pEntity = AsEntity(pRootBase);
+   pData->m_pcName = pEntity->m_sName.empty() ? NULL
+      : CopyArray(pEntity->m_sName.c_str(), (A3DUns32)pEntity->m_sName.size() + 1);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRootBaseSet(A3DRootBase* pRootBase, const A3DRootBaseData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRootBaseSet");
+   if (!pRootBase) return A3D_INVALID_ENTITY_NULL;
+   AsEntity(pRootBase)->m_sName = pData->m_pcName ? pData->m_pcName : "";
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRootBaseWithGraphicsGet(const A3DRootBaseWithGraphics* pBase, A3DRootBaseWithGraphicsData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRootBaseWithGraphicsGet");
+   if (!pBase)
+   {
+      A3D_INITIALIZE_DATA(A3DRootBaseWithGraphicsData, (*pData));
+      return A3D_SUCCESS;
+   }
+   pData->m_pGraphics = AsEntity(pBase)->m_pGraphics;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRootBaseWithGraphicsSet(A3DRootBaseWithGraphics* pBase, const A3DRootBaseWithGraphicsData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRootBaseWithGraphicsSet");
+   if (!pBase) return A3D_INVALID_ENTITY_NULL;
+   AsEntity(pBase)->m_pGraphics = pData->m_pGraphics;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGraphicsCreate(const A3DGraphicsData* pData, A3DGraphics** ppGraphics)
+{
+   STANDIN_RECORD_CALL("A3DGraphicsCreate");
+   SIGraphics* pGraphics = new SIGraphics;
+   pGraphics->m_sData = *pData;
+   *ppGraphics = pGraphics;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGraphicsGet(const A3DGraphics* pGraphics, A3DGraphicsData* pData)
+{
+   STANDIN_RECORD_CALL("A3DGraphicsGet");
+   if (!pGraphics)
+   {
+      A3D_INITIALIZE_DATA(A3DGraphicsData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SIGraphics* pSIGraphics = As<SIGraphics>(pGraphics, kA3DTypeGraphics);
+   if (!pSIGraphics) return A3D_INVALID_ENTITY_TYPE;
+   *pData = pSIGraphics->m_sData;
+   return A3D_SUCCESS;
+}
+
+/*********************************************************************/
+/***global tables*****************************************************/
+/*********************************************************************/
+
+A3DStatus A3DGlobalGetPointer(A3DGlobal** ppGlobal)
+{
+   STANDIN_RECORD_CALL("A3DGlobalGetPointer");
+   *ppGlobal = &GetGlobal();
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalGet(const A3DGlobal* pGlobal, A3DGlobalData* pData)
+{
+   STANDIN_RECORD_CALL("A3DGlobalGet");
+   if (!pGlobal)
+   {
+      A3D_INITIALIZE_DATA(A3DGlobalData, (*pData));
+      return A3D_SUCCESS;
+   }
+   const SIGlobal* pSIGlobal = static_cast<const SIGlobal*>(pGlobal);
+   pData->m_uiColorsSize = (A3DUns32)pSIGlobal->m_asColors.size();
+   pData->m_uiMaterialsSize = (A3DUns32)pSIGlobal->m_asMaterials.size();
+   pData->m_uiStylesSize = (A3DUns32)pSIGlobal->m_asStyles.size();
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalInsertGraphRgbColor(const A3DGraphRgbColorData* pData, A3DUns32* puiIndex)
+{
+   STANDIN_RECORD_CALL("A3DGlobalInsertGraphRgbColor");
+   std::vector<A3DGraphRgbColorData>& asColors = GetGlobal().m_asColors;
+   for (size_t i = 0; i < asColors.size(); i++)
+   {
+      if (asColors[i].m_dRed == pData->m_dRed && asColors[i].m_dGreen == pData->m_dGreen && asColors[i].m_dBlue == pData->m_dBlue)
+      {
+         *puiIndex = (A3DUns32)i;
+         return A3D_SUCCESS;
+      }
+   }
+   *puiIndex = (A3DUns32)asColors.size();
+   asColors.push_back(*pData);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalInsertGraphMaterial(const A3DGraphMaterialData* pData, A3DUns32* puiIndex)
+{
+   STANDIN_RECORD_CALL("A3DGlobalInsertGraphMaterial");
+   std::vector<SIMaterial>& asMaterials = GetGlobal().m_asMaterials;
+   *puiIndex = (A3DUns32)asMaterials.size();
+   asMaterials.push_back({ *pData, false });
+   return A3D_SUCCESS;
+}
+
+A3DStatus StandInGlobalInsertTextureMaterial(A3DUns32* puiIndex)
+{
+   std::vector<SIMaterial>& asMaterials = GetGlobal().m_asMaterials;
+   SIMaterial sMaterial;
+   A3D_INITIALIZE_DATA(A3DGraphMaterialData, sMaterial.m_sData);
+   sMaterial.m_sData.m_uiDiffuse = A3D_DEFAULT_COLOR_INDEX;
+   sMaterial.m_bTexture = true;
+   *puiIndex = (A3DUns32)asMaterials.size();
+   asMaterials.push_back(sMaterial);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalInsertGraphStyle(const A3DGraphStyleData* pData, A3DUns32* puiIndex)
+{
+   STANDIN_RECORD_CALL("A3DGlobalInsertGraphStyle");
+   std::vector<A3DGraphStyleData>& asStyles = GetGlobal().m_asStyles;
+   *puiIndex = (A3DUns32)asStyles.size();
+   asStyles.push_back(*pData);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalGetGraphRgbColorData(A3DUns32 uiIndexRgbColor, A3DGraphRgbColorData* pData)
+{
+   STANDIN_RECORD_CALL("A3DGlobalGetGraphRgbColorData");
+   const std::vector<A3DGraphRgbColorData>& asColors = GetGlobal().m_asColors;
+   if (uiIndexRgbColor == A3D_DEFAULT_COLOR_INDEX)
+   {
+      A3D_INITIALIZE_DATA(A3DGraphRgbColorData, (*pData));
+      return A3D_SUCCESS;
+   }
+   if (uiIndexRgbColor >= asColors.size()) return A3D_ERROR;
+   *pData = asColors[uiIndexRgbColor];
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalGetGraphMaterialData(A3DUns32 uiIndexMaterial, A3DGraphMaterialData* pData)
+{
+   STANDIN_RECORD_CALL("A3DGlobalGetGraphMaterialData");
+   const std::vector<SIMaterial>& asMaterials = GetGlobal().m_asMaterials;
+   if (uiIndexMaterial >= asMaterials.size() || asMaterials[uiIndexMaterial].m_bTexture) return A3D_ERROR;
+   *pData = asMaterials[uiIndexMaterial].m_sData;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalGetGraphStyleData(A3DUns32 uiIndexStyle, A3DGraphStyleData* pData)
+{
+   STANDIN_RECORD_CALL("A3DGlobalGetGraphStyleData");
+   const std::vector<A3DGraphStyleData>& asStyles = GetGlobal().m_asStyles;
+   if (uiIndexStyle >= asStyles.size()) return A3D_ERROR;
+   *pData = asStyles[uiIndexStyle];
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DGlobalIsMaterialTexture(A3DUns32 uiIndexMaterial, A3DBool* pbIsTexture)
+{
+   STANDIN_RECORD_CALL("A3DGlobalIsMaterialTexture");
+   const std::vector<SIMaterial>& asMaterials = GetGlobal().m_asMaterials;
+   if (uiIndexMaterial >= asMaterials.size()) return A3D_ERROR;
+   *pbIsTexture = asMaterials[uiIndexMaterial].m_bTexture ? TRUE : FALSE;
+   return A3D_SUCCESS;
+}
+
+void StandInGlobalReset()
+{
+   SIGlobal& sGlobal = GetGlobal();
+   sGlobal.m_asColors.clear();
+   sGlobal.m_asMaterials.clear();
+   sGlobal.m_asStyles.clear();
+}
+
+/*********************************************************************/
+/***cascaded attributes***********************************************/
+/*********************************************************************/
+
+A3DStatus A3DMiscCascadedAttributesCreate(A3DMiscCascadedAttributes** ppAttr)
+{
+   STANDIN_RECORD_CALL("A3DMiscCascadedAttributesCreate");
+   SICascadedAttributes* pAttr = new SICascadedAttributes;
+   A3D_INITIALIZE_DATA(A3DMiscCascadedAttributesData, pAttr->m_sData);
+   pAttr->m_sData.m_bShow = TRUE;
+   pAttr->m_sData.m_usLayer = (A3DUns16)-1;
+   InitStyle(pAttr->m_sData.m_sStyle);
+   *ppAttr = pAttr;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DMiscCascadedAttributesPush(A3DMiscCascadedAttributes* pAttr,
+                                        const A3DRootBaseWithGraphics* pBase,
+                                        const A3DMiscCascadedAttributes* pFather)
+{
+   STANDIN_RECORD_CALL("A3DMiscCascadedAttributesPush");
+   if (!pAttr || !pBase) return A3D_INVALID_ENTITY_NULL;
+   SICascadedAttributes* pSIAttr = static_cast<SICascadedAttributes*>(pAttr);
+   if (pFather)
+   {
+      *pSIAttr = *static_cast<const SICascadedAttributes*>(pFather);
+   }
+
+   SIGraphics* pGraphics = As<SIGraphics>(AsEntity(pBase)->m_pGraphics, kA3DTypeGraphics);
+   if (pGraphics)
+   {
+      const A3DGraphicsData& sGraphics = pGraphics->m_sData;
+      if (!(sGraphics.m_usBehaviour & kA3DGraphicsShow))
+      {
+         pSIAttr->m_sData.m_bShow = FALSE;
+      }
+      if (sGraphics.m_usBehaviour & kA3DGraphicsRemoved)
+      {
+         pSIAttr->m_sData.m_bRemoved = TRUE;
+      }
+      if (sGraphics.m_uiLayerIndex != (A3DUns32)-1)
+      {
+         pSIAttr->m_sData.m_usLayer = (A3DUns16)sGraphics.m_uiLayerIndex;
+      }
+      if (!pSIAttr->m_bColorLocked && sGraphics.m_uiStyleIndex != A3D_DEFAULT_STYLE_INDEX)
+      {
+         A3DGlobalGetGraphStyleData(sGraphics.m_uiStyleIndex, &pSIAttr->m_sData.m_sStyle);
+      }
+      if (sGraphics.m_usBehaviour & kA3DGraphicsFatherHeritColor)
+      {
+         pSIAttr->m_bColorLocked = true;
+      }
+   }
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DMiscCascadedAttributesGet(const A3DMiscCascadedAttributes* pAttr, A3DMiscCascadedAttributesData* pData)
+{
+   STANDIN_RECORD_CALL("A3DMiscCascadedAttributesGet");
+   if (!pAttr)
+   {
+      A3D_INITIALIZE_DATA(A3DMiscCascadedAttributesData, (*pData));
+      return A3D_SUCCESS;
+   }
+   *pData = static_cast<const SICascadedAttributes*>(pAttr)->m_sData;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DMiscCascadedAttributesDelete(A3DMiscCascadedAttributes* pAttr)
+{
+   STANDIN_RECORD_CALL("A3DMiscCascadedAttributesDelete");
+   delete static_cast<SICascadedAttributes*>(pAttr);
+   return A3D_SUCCESS;
+}
+
+/*********************************************************************/
+/***transformations***************************************************/
+/*********************************************************************/
+
+A3DStatus A3DMiscCartesianTransformationCreate(const A3DMiscCartesianTransformationData* pData,
+                                               A3DMiscCartesianTransformation** ppTransformation)
+{
+   STANDIN_RECORD_CALL("A3DMiscCartesianTransformationCreate");
+   SITransformation* pTransformation = new SITransformation;
+   pTransformation->m_sData = *pData;
+   *ppTransformation = pTransformation;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DMiscCartesianTransformationGet(const A3DMiscCartesianTransformation* pTransformation,
+                                            A3DMiscCartesianTransformationData* pData)
+{
+   STANDIN_RECORD_CALL("A3DMiscCartesianTransformationGet");
+   if (!pTransformation)
+   {
+      A3D_INITIALIZE_DATA(A3DMiscCartesianTransformationData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SITransformation* pSITransformation = As<SITransformation>(pTransformation, kA3DTypeMiscCartesianTransformation);
+   if (!pSITransformation) return A3D_INVALID_ENTITY_TYPE;
+   *pData = pSITransformation->m_sData;
+   return A3D_SUCCESS;
+}
+
+/* The box of the coordinates of every tessellation below the entity, without the locations and
+   coordinate systems: enough for the bridge to compare the sizes of subtrees */
+static void stExtendBoundingBox(const void* pEntity, A3DBoundingBoxData* pData, bool& bEmpty)
+{
+   SIEntity* pBase = AsEntity(pEntity);
+   if (!pBase)
+   {
+      return;
+   }
+   switch (pBase->m_eType)
+   {
+      case kA3DTypeAsmProductOccurrence:
+      {
+         SIOccurrence* pOccurrence = static_cast<SIOccurrence*>(pBase);
+         stExtendBoundingBox(pOccurrence->m_pPart, pData, bEmpty);
+         stExtendBoundingBox(pOccurrence->m_pPrototype, pData, bEmpty);
+         stExtendBoundingBox(pOccurrence->m_pExternalData, pData, bEmpty);
+         for (A3DAsmProductOccurrence* pChild : pOccurrence->m_apOccurrences)
+         {
+            stExtendBoundingBox(pChild, pData, bEmpty);
+         }
+         break;
+      }
+      case kA3DTypeAsmPartDefinition:
+         for (A3DRiRepresentationItem* pRepItem : static_cast<SIPartDefinition*>(pBase)->m_apRepItems)
+         {
+            stExtendBoundingBox(pRepItem, pData, bEmpty);
+         }
+         break;
+      case kA3DTypeRiSet:
+         for (A3DRiRepresentationItem* pRepItem : static_cast<SISet*>(pBase)->m_apRepItems)
+         {
+            stExtendBoundingBox(pRepItem, pData, bEmpty);
+         }
+         break;
+      case kA3DTypeRiBrepModel:
+      case kA3DTypeRiPolyBrepModel:
+      {
+         SITess* pTess = As<SITess>(static_cast<SIRepresentationItem*>(pBase)->m_pTessBase, kA3DTypeTess3D);
+         for (size_t ui = 0; pTess && ui + 2 < pTess->m_adCoords.size(); ui += 3)
+         {
+            const double* pd = &pTess->m_adCoords[ui];
+            if (bEmpty)
+            {
+               pData->m_sMin.m_dX = pData->m_sMax.m_dX = pd[0];
+               pData->m_sMin.m_dY = pData->m_sMax.m_dY = pd[1];
+               pData->m_sMin.m_dZ = pData->m_sMax.m_dZ = pd[2];
+               bEmpty = false;
+            }
+            pData->m_sMin.m_dX = std::min(pData->m_sMin.m_dX, pd[0]);
+            pData->m_sMin.m_dY = std::min(pData->m_sMin.m_dY, pd[1]);
+            pData->m_sMin.m_dZ = std::min(pData->m_sMin.m_dZ, pd[2]);
+            pData->m_sMax.m_dX = std::max(pData->m_sMax.m_dX, pd[0]);
+            pData->m_sMax.m_dY = std::max(pData->m_sMax.m_dY, pd[1]);
+            pData->m_sMax.m_dZ = std::max(pData->m_sMax.m_dZ, pd[2]);
+         }
+         break;
+      }
+      default:
+         break;
+   }
+}
+
+A3DStatus A3DMiscGetBoundingBox(const A3DEntity* pEntity, A3DBoundingBoxData* pData)
+{
+   STANDIN_RECORD_CALL("A3DMiscGetBoundingBox");
+   if (!pEntity) return A3D_INVALID_ENTITY_NULL;
+   bool bEmpty = true;
+   stExtendBoundingBox(pEntity, pData, bEmpty);
+   return A3D_SUCCESS;
+}
+
+/*********************************************************************/
+/***assembly**********************************************************/
+/*********************************************************************/
+
+A3DStatus A3DAsmModelFileCreate(const A3DAsmModelFileData* pData, A3DAsmModelFile** ppModelFile)
+{
+   STANDIN_RECORD_CALL("A3DAsmModelFileCreate");
+   SIModelFile* pModelFile = new SIModelFile;
+   pModelFile->m_apOccurrences.assign(pData->m_ppPOccurrences, pData->m_ppPOccurrences + pData->m_uiPOccurrencesSize);
+   *ppModelFile = pModelFile;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DAsmModelFileGet(const A3DAsmModelFile* pModelFile, A3DAsmModelFileData* pData)
+{
+   STANDIN_RECORD_CALL("A3DAsmModelFileGet");
+   if (!pModelFile)
+   {
+      free(pData->m_ppPOccurrences);
+      A3D_INITIALIZE_DATA(A3DAsmModelFileData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SIModelFile* pSIModelFile = As<SIModelFile>(pModelFile, kA3DTypeAsmModelFile);
+   if (!pSIModelFile) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_dUnit = 1.;
+   pData->m_uiPOccurrencesSize = (A3DUns32)pSIModelFile->m_apOccurrences.size();
+   pData->m_ppPOccurrences = CopyArray(pSIModelFile->m_apOccurrences.data(), pData->m_uiPOccurrencesSize);
+   return A3D_SUCCESS;
+}
+
+static void stCollect(const void* pEntity, std::unordered_set<SIEntity*>& sEntities)
+{
+   if (!pEntity) return;
+   SIEntity* pSIEntity = AsEntity(pEntity);
+   if (!sEntities.insert(pSIEntity).second) return;
+
+   stCollect(pSIEntity->m_pGraphics, sEntities);
+   switch (pSIEntity->m_eType)
+   {
+      case kA3DTypeAsmModelFile:
+         for (void* pChild : static_cast<SIModelFile*>(pSIEntity)->m_apOccurrences) stCollect(pChild, sEntities);
+         break;
+      case kA3DTypeAsmProductOccurrence:
+      {
+         SIOccurrence* pOccurrence = static_cast<SIOccurrence*>(pSIEntity);
+         stCollect(pOccurrence->m_pPart, sEntities);
+         stCollect(pOccurrence->m_pPrototype, sEntities);
+         stCollect(pOccurrence->m_pExternalData, sEntities);
+         stCollect(pOccurrence->m_pLocation, sEntities);
+         for (void* pChild : pOccurrence->m_apOccurrences) stCollect(pChild, sEntities);
+         break;
+      }
+      case kA3DTypeAsmPartDefinition:
+         for (void* pChild : static_cast<SIPartDefinition*>(pSIEntity)->m_apRepItems) stCollect(pChild, sEntities);
+         break;
+      case kA3DTypeRiSet:
+         for (void* pChild : static_cast<SISet*>(pSIEntity)->m_apRepItems) stCollect(pChild, sEntities);
+         stCollect(static_cast<SIRepresentationItem*>(pSIEntity)->m_pTessBase, sEntities);
+         stCollect(static_cast<SIRepresentationItem*>(pSIEntity)->m_pCoordinateSystem, sEntities);
+         break;
+      case kA3DTypeRiBrepModel:
+      case kA3DTypeRiPolyBrepModel:
+         stCollect(static_cast<SIRepresentationItem*>(pSIEntity)->m_pTessBase, sEntities);
+         stCollect(static_cast<SIRepresentationItem*>(pSIEntity)->m_pCoordinateSystem, sEntities);
+         break;
+      case kA3DTypeRiCoordinateSystem:
+         stCollect(static_cast<SICoordinateSystem*>(pSIEntity)->m_pTransformation, sEntities);
+         break;
+      default:
+         break;
+   }
+}
+
+A3DStatus A3DAsmModelFileDelete(A3DAsmModelFile* pModelFile)
+{
+   STANDIN_RECORD_CALL("A3DAsmModelFileDelete");
+   if (!pModelFile) return A3D_INVALID_ENTITY_NULL;
+   std::unordered_set<SIEntity*> sEntities;
+   stCollect(pModelFile, sEntities);
+   for (SIEntity* pEntity : sEntities)
+   {
+      delete pEntity;
+   }
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DAsmProductOccurrenceCreate(const A3DAsmProductOccurrenceData* pData,
+                                        A3DAsmProductOccurrence** ppOccurrence)
+{
+   STANDIN_RECORD_CALL("A3DAsmProductOccurrenceCreate");
+   SIOccurrence* pOccurrence = new SIOccurrence;
+   pOccurrence->m_pPart = pData->m_pPart;
+   pOccurrence->m_pPrototype = pData->m_pPrototype;
+   pOccurrence->m_pExternalData = pData->m_pExternalData;
+   pOccurrence->m_pLocation = pData->m_pLocation;
+   pOccurrence->m_apOccurrences.assign(pData->m_ppPOccurrences, pData->m_ppPOccurrences + pData->m_uiPOccurrencesSize);
+   *ppOccurrence = pOccurrence;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DAsmProductOccurrenceGet(const A3DAsmProductOccurrence* pOccurrence,
+                                     A3DAsmProductOccurrenceData* pData)
+{
+   STANDIN_RECORD_CALL("A3DAsmProductOccurrenceGet");
+   if (!pOccurrence)
+   {
+      free(pData->m_ppPOccurrences);
+      A3D_INITIALIZE_DATA(A3DAsmProductOccurrenceData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SIOccurrence* pSIOccurrence = As<SIOccurrence>(pOccurrence, kA3DTypeAsmProductOccurrence);
+   if (!pSIOccurrence) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_pPart = pSIOccurrence->m_pPart;
+   pData->m_pPrototype = pSIOccurrence->m_pPrototype;
+   pData->m_pExternalData = pSIOccurrence->m_pExternalData;
+   pData->m_pLocation = pSIOccurrence->m_pLocation;
+   pData->m_uiPOccurrencesSize = (A3DUns32)pSIOccurrence->m_apOccurrences.size();
+   pData->m_ppPOccurrences = CopyArray(pSIOccurrence->m_apOccurrences.data(), pData->m_uiPOccurrencesSize);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DAsmPartDefinitionCreate(const A3DAsmPartDefinitionData* pData, A3DAsmPartDefinition** ppPart)
+{
+   STANDIN_RECORD_CALL("A3DAsmPartDefinitionCreate");
+   SIPartDefinition* pPart = new SIPartDefinition;
+   pPart->m_apRepItems.assign(pData->m_ppRepItems, pData->m_ppRepItems + pData->m_uiRepItemsSize);
+   *ppPart = pPart;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DAsmPartDefinitionGet(const A3DAsmPartDefinition* pPart, A3DAsmPartDefinitionData* pData)
+{
+   STANDIN_RECORD_CALL("A3DAsmPartDefinitionGet");
+   if (!pPart)
+   {
+      free(pData->m_ppRepItems);
+      A3D_INITIALIZE_DATA(A3DAsmPartDefinitionData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SIPartDefinition* pSIPart = As<SIPartDefinition>(pPart, kA3DTypeAsmPartDefinition);
+   if (!pSIPart) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_uiRepItemsSize = (A3DUns32)pSIPart->m_apRepItems.size();
+   pData->m_ppRepItems = CopyArray(pSIPart->m_apRepItems.data(), pData->m_uiRepItemsSize);
+   return A3D_SUCCESS;
+}
+
+/*********************************************************************/
+/***representation items**********************************************/
+/*********************************************************************/
+
+A3DStatus A3DRiSetCreate(const A3DRiSetData* pData, A3DRiSet** ppSet)
+{
+   STANDIN_RECORD_CALL("A3DRiSetCreate");
+   SISet* pSet = new SISet;
+   pSet->m_apRepItems.assign(pData->m_ppRepItems, pData->m_ppRepItems + pData->m_uiRepItemsSize);
+   *ppSet = pSet;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiSetGet(const A3DRiSet* pSet, A3DRiSetData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRiSetGet");
+   if (!pSet)
+   {
+      free(pData->m_ppRepItems);
+      A3D_INITIALIZE_DATA(A3DRiSetData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SISet* pSISet = As<SISet>(pSet, kA3DTypeRiSet);
+   if (!pSISet) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_uiRepItemsSize = (A3DUns32)pSISet->m_apRepItems.size();
+   pData->m_ppRepItems = CopyArray(pSISet->m_apRepItems.data(), pData->m_uiRepItemsSize);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiPolyBrepModelCreate(const A3DRiPolyBrepModelData*, A3DRiPolyBrepModel** ppPolyBrep)
+{
+   STANDIN_RECORD_CALL("A3DRiPolyBrepModelCreate");
+   *ppPolyBrep = new SIRepresentationItem(kA3DTypeRiPolyBrepModel);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiBrepModelCreate(const A3DRiBrepModelData*, A3DRiBrepModel** ppBrep)
+{
+   STANDIN_RECORD_CALL("A3DRiBrepModelCreate");
+   *ppBrep = new SIRepresentationItem(kA3DTypeRiBrepModel);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiRepresentationItemGet(const A3DRiRepresentationItem* pRi, A3DRiRepresentationItemData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRiRepresentationItemGet");
+   if (!pRi)
+   {
+      A3D_INITIALIZE_DATA(A3DRiRepresentationItemData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SIRepresentationItem* pSIRi = AsRepresentationItem(pRi);
+   if (!pSIRi) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_pTessBase = pSIRi->m_pTessBase;
+   pData->m_pCoordinateSystem = pSIRi->m_pCoordinateSystem;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiRepresentationItemSet(A3DRiRepresentationItem* pRi, const A3DRiRepresentationItemData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRiRepresentationItemSet");
+   SIRepresentationItem* pSIRi = AsRepresentationItem(pRi);
+   if (!pSIRi) return A3D_INVALID_ENTITY_TYPE;
+   pSIRi->m_pTessBase = pData->m_pTessBase;
+   pSIRi->m_pCoordinateSystem = pData->m_pCoordinateSystem;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiCoordinateSystemCreate(const A3DRiCoordinateSystemData* pData,
+                                      A3DRiCoordinateSystem** ppCoordinateSystem)
+{
+   STANDIN_RECORD_CALL("A3DRiCoordinateSystemCreate");
+   SICoordinateSystem* pCoordinateSystem = new SICoordinateSystem;
+   pCoordinateSystem->m_pTransformation = pData->m_pTransformation;
+   *ppCoordinateSystem = pCoordinateSystem;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DRiCoordinateSystemGet(const A3DRiCoordinateSystem* pCoordinateSystem,
+                                   A3DRiCoordinateSystemData* pData)
+{
+   STANDIN_RECORD_CALL("A3DRiCoordinateSystemGet");
+   if (!pCoordinateSystem)
+   {
+      A3D_INITIALIZE_DATA(A3DRiCoordinateSystemData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SICoordinateSystem* pSICoordinateSystem = As<SICoordinateSystem>(pCoordinateSystem, kA3DTypeRiCoordinateSystem);
+   if (!pSICoordinateSystem) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_pTransformation = pSICoordinateSystem->m_pTransformation;
+   return A3D_SUCCESS;
+}
+
+/*********************************************************************/
+/***tessellation******************************************************/
+/*********************************************************************/
+
+A3DStatus A3DTess3DCreate(const A3DTess3DData* pData, A3DTess3D** ppTess3D)
+{
+   STANDIN_RECORD_CALL("A3DTess3DCreate");
+   SITess* pTess = new SITess;
+   pTess->m_adNormals.assign(pData->m_pdNormals, pData->m_pdNormals + pData->m_uiNormalSize);
+   pTess->m_adTextureCoords.assign(pData->m_pdTextureCoords, pData->m_pdTextureCoords + pData->m_uiTextureCoordSize);
+   pTess->m_auiTriangulatedIndexes.assign(pData->m_puiTriangulatedIndexes,
+                                          pData->m_puiTriangulatedIndexes + pData->m_uiTriangulatedIndexSize);
+   pTess->m_asFaces.resize(pData->m_uiFaceTessSize);
+   for (A3DUns32 ui = 0; ui < pData->m_uiFaceTessSize; ui++)
+   {
+      SIFace& sFace = pTess->m_asFaces[ui];
+      sFace.m_sData = pData->m_psFaceTessData[ui];
+      sFace.m_auiSizes.assign(sFace.m_sData.m_puiSizesTriangulated,
+                              sFace.m_sData.m_puiSizesTriangulated + sFace.m_sData.m_uiSizesTriangulatedSize);
+      sFace.m_sData.m_puiSizesTriangulated = NULL;
+      sFace.m_sData.m_uiSizesWiresSize = 0;
+      sFace.m_sData.m_puiSizesWires = NULL;
+      sFace.m_sData.m_uiStyleIndexesSize = 0;
+      sFace.m_sData.m_puiStyleIndexes = NULL;
+      sFace.m_sData.m_uiRGBAVerticesSize = 0;
+      sFace.m_sData.m_pucRGBAVertices = NULL;
+   }
+   *ppTess3D = pTess;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DTess3DGet(const A3DTess3D* pTess3D, A3DTess3DData* pData)
+{
+   STANDIN_RECORD_CALL("A3DTess3DGet");
+   if (!pTess3D)
+   {
+      free(pData->m_pdNormals);
+      free(pData->m_pdTextureCoords);
+      free(pData->m_puiTriangulatedIndexes);
+      for (A3DUns32 ui = 0; ui < pData->m_uiFaceTessSize; ui++)
+      {
+         free(pData->m_psFaceTessData[ui].m_puiSizesTriangulated);
+      }
+      free(pData->m_psFaceTessData);
+      A3D_INITIALIZE_DATA(A3DTess3DData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SITess* pTess = As<SITess>(pTess3D, kA3DTypeTess3D);
+   if (!pTess) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_uiNormalSize = (A3DUns32)pTess->m_adNormals.size();
+   pData->m_pdNormals = CopyArray(pTess->m_adNormals.data(), pData->m_uiNormalSize);
+   pData->m_uiTextureCoordSize = (A3DUns32)pTess->m_adTextureCoords.size();
+   pData->m_pdTextureCoords = CopyArray(pTess->m_adTextureCoords.data(), pData->m_uiTextureCoordSize);
+   pData->m_uiTriangulatedIndexSize = (A3DUns32)pTess->m_auiTriangulatedIndexes.size();
+   pData->m_puiTriangulatedIndexes = CopyArray(pTess->m_auiTriangulatedIndexes.data(), pData->m_uiTriangulatedIndexSize);
+   pData->m_uiFaceTessSize = (A3DUns32)pTess->m_asFaces.size();
+   pData->m_psFaceTessData = pData->m_uiFaceTessSize
+      ? static_cast<A3DTessFaceData*>(malloc(pData->m_uiFaceTessSize * sizeof(A3DTessFaceData))) : NULL;
+   for (A3DUns32 ui = 0; ui < pData->m_uiFaceTessSize; ui++)
+   {
+      const SIFace& sFace = pTess->m_asFaces[ui];
+      pData->m_psFaceTessData[ui] = sFace.m_sData;
+      pData->m_psFaceTessData[ui].m_uiSizesTriangulatedSize = (A3DUns32)sFace.m_auiSizes.size();
+      pData->m_psFaceTessData[ui].m_puiSizesTriangulated = CopyArray(sFace.m_auiSizes.data(), (A3DUns32)sFace.m_auiSizes.size());
+   }
+   pData->m_bHasFaces = pData->m_uiFaceTessSize ? TRUE : FALSE;
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DTessBaseSet(A3DTessBase* pTessBase, const A3DTessBaseData* pData)
+{
+   STANDIN_RECORD_CALL("A3DTessBaseSet");
+   SITess* pTess = As<SITess>(pTessBase, kA3DTypeTess3D);
+   if (!pTess) return A3D_INVALID_ENTITY_TYPE;
+   pTess->m_adCoords.assign(pData->m_pdCoords, pData->m_pdCoords + pData->m_uiCoordSize);
+   return A3D_SUCCESS;
+}
+
+A3DStatus A3DTessBaseGet(const A3DTessBase* pTessBase, A3DTessBaseData* pData)
+{
+   STANDIN_RECORD_CALL("A3DTessBaseGet");
+   if (!pTessBase)
+   {
+      free(pData->m_pdCoords);
+      A3D_INITIALIZE_DATA(A3DTessBaseData, (*pData));
+      return A3D_SUCCESS;
+   }
+   SITess* pTess = As<SITess>(pTessBase, kA3DTypeTess3D);
+   if (!pTess) return A3D_INVALID_ENTITY_TYPE;
+   pData->m_bIsCalculated = FALSE;
+   pData->m_uiCoordSize = (A3DUns32)pTess->m_adCoords.size();
+   pData->m_pdCoords = CopyArray(pTess->m_adCoords.data(), pData->m_uiCoordSize);
+   return A3D_SUCCESS;
+}
@@ -0,0 +1,805 @@
+/*
+*   Description:
+*
+*      Polygonica stand-in
+*      In-memory solids, worlds, groups and styles for the PF functions the bridge calls.
+*      PFSolidCreateFromMesh stitches coincident vertices and builds edge adjacency so its
+*      cost responds to mesh size, duplicated seam vertices and vertex locality.
+*      See pgapi.h.
+*/
+
+#include "StandInRecorderInternal.h"
+#include "pg/pgapi.h"
+#include "pg/pgrender.h"
+
+#include <atomic>
+#include <mutex>
+#include <string.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*********************************************************************/
+/***entities**********************************************************/
+/*********************************************************************/
+
+namespace
+{
+   enum PGKind
+   {
+      kPGEnvironment,
+      kPGWorld,
+      kPGWorldEntity,
+      kPGSolid,
+      kPGFace,
+      kPGEntityGroup,
+      kPGEntityList,
+      kPGRenderStyle,
+      kPGPolygonStyle,
+      kPGEdgeStyle
+   };
+
+   std::atomic<long long> g_llLiveBytes(0);
+   std::atomic<long long> g_llLiveEntities(0);
+   std::atomic<unsigned long long> g_ullStitchedVertices(0);
+
+   struct PGEntity
+   {
+      explicit PGEntity(PGKind eKind, size_t uBytes) : m_eKind(eKind), m_uBytes(uBytes)
+      {
+         g_llLiveBytes += (long long)m_uBytes;
+         g_llLiveEntities++;
+      }
+      virtual ~PGEntity()
+      {
+         g_llLiveBytes -= (long long)m_uBytes;
+         g_llLiveEntities--;
+      }
+      void Account(size_t uBytes)
+      {
+         g_llLiveBytes += (long long)uBytes;
+         m_uBytes += uBytes;
+      }
+
+      PGKind m_eKind;
+      size_t m_uBytes;
+   };
+
+   struct PGEnvironment : PGEntity
+   {
+      PGEnvironment() : PGEntity(kPGEnvironment, sizeof(PGEnvironment)) {}
+      PTPointer m_pErrorReportCb = NULL;
+   };
+
+   struct PGSolid;
+
+   struct PGFace : PGEntity
+   {
+      PGFace() : PGEntity(kPGFace, 0) {}
+      PGSolid* m_pSolid = NULL;
+      PTPointer m_pAppSurface = NULL;
+      PTNat32 m_auiVertices[3];
+      PTDouble m_adNormal[3] = { 0., 0., 0. };
+   };
+
+   struct PGSolid : PGEntity
+   {
+      PGSolid() : PGEntity(kPGSolid, sizeof(PGSolid)) {}
+      ~PGSolid()
+      {
+         delete[] m_pFaces;
+      }
+      PGEnvironment* m_pEnvironment = NULL;
+      PGFace* m_pFaces = NULL;
+      PTNat32 m_uiFaceCount = 0;
+      std::vector<PTDouble> m_adVertices;
+      std::vector<PTNat32> m_auiEdgeMates;
+      PTPointer m_pAppData = NULL;
+      PTBounds m_adBounds;
+   };
+
+   struct PGWorld;
+
+   struct PGWorldEntity : PGEntity
+   {
+      PGWorldEntity() : PGEntity(kPGWorldEntity, sizeof(PGWorldEntity)) {}
+      PGWorld* m_pWorld = NULL;
+      PTEntity m_pEntity = NULL;
+      PTEntity m_pStyle = NULL;
+      PTDouble m_adTransform[16];
+   };
+
+   struct PGWorld : PGEntity
+   {
+      PGWorld() : PGEntity(kPGWorld, sizeof(PGWorld)) {}
+      ~PGWorld()
+      {
+         for (PGWorldEntity* pWorldEntity : m_sEntities) delete pWorldEntity;
+      }
+      std::mutex m_mutex;
+      std::unordered_set<PGWorldEntity*> m_sEntities;
+   };
+
+   struct PGEntityGroup : PGEntity
+   {
+      PGEntityGroup() : PGEntity(kPGEntityGroup, sizeof(PGEntityGroup)) {}
+      std::vector<PTEntity> m_apEntities;
+   };
+
+   struct PGEntityList : PGEntity
+   {
+      PGEntityList() : PGEntity(kPGEntityList, sizeof(PGEntityList)) {}
+      std::vector<PTEntity> m_apEntities;
+      size_t m_uCursor = 0;
+   };
+
+   struct PGPolygonStyle : PGEntity
+   {
+      PGPolygonStyle() : PGEntity(kPGPolygonStyle, sizeof(PGPolygonStyle)) {}
+      PTFloat m_afColour[3] = { 1.f, 1.f, 1.f };
+      PTFloat m_afBackColour[3] = { 1.f, 1.f, 1.f };
+      PTNat32 m_uiTransparency = 0;
+      PTBoolean m_bTwoSided = 0;
+   };
+
+   struct PGEdgeStyle : PGEntity
+   {
+      PGEdgeStyle() : PGEntity(kPGEdgeStyle, sizeof(PGEdgeStyle)) {}
+      PTFloat m_afColour[3] = { 0.f, 0.f, 0.f };
+   };
+
+   struct PGRenderStyle : PGEntity
+   {
+      PGRenderStyle() : PGEntity(kPGRenderStyle, sizeof(PGRenderStyle)) {}
+      ~PGRenderStyle()
+      {
+         delete m_pPolygonStyle;
+         delete m_pEdgeStyle;
+      }
+      PGPolygonStyle* m_pPolygonStyle = NULL;
+      PGEdgeStyle* m_pEdgeStyle = NULL;
+   };
+
+   template <typename T>
+   T* As(PTEntity pEntity, PGKind eKind)
+   {
+      PGEntity* pBase = static_cast<PGEntity*>(pEntity);
+      return (pBase && pBase->m_eKind == eKind) ? static_cast<T*>(pBase) : NULL;
+   }
+
+   void ReadColour(PTNat32 uiType, const void* pColour, PTFloat* pafColour)
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         pafColour[i] = (uiType == PV_COLOUR_DOUBLE_RGB_ARRAY) ? (PTFloat)static_cast<const PTDouble*>(pColour)[i]
+                                                               : static_cast<const PTFloat*>(pColour)[i];
+      }
+   }
+
+   struct VertexKey
+   {
+      PTDouble m_adPoint[3];
+      bool operator==(const VertexKey& sOther) const
+      {
+         return memcmp(m_adPoint, sOther.m_adPoint, sizeof(m_adPoint)) == 0;
+      }
+   };
+
+   struct VertexKeyHash
+   {
+      size_t operator()(const VertexKey& sKey) const
+      {
+         unsigned long long aullBits[3];
+         memcpy(aullBits, sKey.m_adPoint, sizeof(aullBits));
+         unsigned long long ullHash = 1469598103934665603ULL;
+         for (unsigned long long ullBits : aullBits)
+         {
+            ullHash = (ullHash ^ ullBits) * 1099511628211ULL;
+         }
+         return (size_t)ullHash;
+      }
+   };
+}
+
+void StandInResetStitchedVertexCount()
+{
+   g_ullStitchedVertices = 0;
+}
+
+size_t StandInGetLivePGBytes()
+{
+   return (size_t)g_llLiveBytes.load();
+}
+
+size_t StandInGetLivePGEntities()
+{
+   return (size_t)g_llLiveEntities.load();
+}
+
+unsigned long long StandInGetStitchedVertexCount()
+{
+   return g_ullStitchedVertices.load();
+}
+
+bool StandInGetWorldEntityTransform(void* pWorldEntity, double adTransform[16])
+{
+   PGWorldEntity* pPGWorldEntity = As<PGWorldEntity>(pWorldEntity, kPGWorldEntity);
+   if (!pPGWorldEntity) return false;
+   memcpy(adTransform, pPGWorldEntity->m_adTransform, 16 * sizeof(double));
+   return true;
+}
+
+bool StandInGetFaceGeometry(void* pFace, double adPoints[9], double adNormal[3])
+{
+   PGFace* pPGFace = As<PGFace>(pFace, kPGFace);
+   if (!pPGFace) return false;
+   for (int i = 0; i < 3; i++)
+   {
+      memcpy(adPoints + 3 * i, &pPGFace->m_pSolid->m_adVertices[3 * (size_t)pPGFace->m_auiVertices[i]], 3 * sizeof(double));
+   }
+   memcpy(adNormal, pPGFace->m_adNormal, 3 * sizeof(double));
+   return true;
+}
+
+/*********************************************************************/
+/***option initialisers***********************************************/
+/*********************************************************************/
+
+void PMInitInitialiseOpts(PTInitialiseOpts* opts)
+{
+   memset(opts, 0, sizeof(PTInitialiseOpts));
+}
+
+void PMInitEnvironmentOpts(PTEnvironmentOpts* opts)
+{
+   memset(opts, 0, sizeof(PTEnvironmentOpts));
+}
+
+void PMInitMeshSolidOpts(PTMeshSolidOpts* opts)
+{
+   memset(opts, 0, sizeof(PTMeshSolidOpts));
+}
+
+void PMInitTransformMatrix(PTTransformMatrix matrix)
+{
+   for (int i = 0; i < 4; i++)
+   {
+      for (int j = 0; j < 4; j++)
+      {
+         matrix[i][j] = (i == j) ? 1. : 0.;
+      }
+   }
+}
+
+/*********************************************************************/
+/***environment and world*********************************************/
+/*********************************************************************/
+
+PTStatus PFInitialise(const char*, PTInitialiseOpts*)
+{
+   STANDIN_RECORD_CALL("PFInitialise");
+   return PV_STATUS_OK;
+}
+
+PTStatus PFTerminate()
+{
+   STANDIN_RECORD_CALL("PFTerminate");
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEnvironmentCreate(PTEnvironmentOpts*, PTEnvironment* env)
+{
+   STANDIN_RECORD_CALL("PFEnvironmentCreate");
+   *env = new PGEnvironment;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEnvironmentDestroy(PTEnvironment env)
+{
+   STANDIN_RECORD_CALL("PFEnvironmentDestroy");
+   PGEnvironment* pEnvironment = As<PGEnvironment>(env, kPGEnvironment);
+   if (!pEnvironment) return PV_STATUS_BAD_CALL;
+   delete pEnvironment;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFWorldCreate(PTEnvironment, PTWorldOpts*, PTWorld* world)
+{
+   STANDIN_RECORD_CALL("PFWorldCreate");
+   *world = new PGWorld;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFWorldDestroy(PTWorld world)
+{
+   STANDIN_RECORD_CALL("PFWorldDestroy");
+   PGWorld* pWorld = As<PGWorld>(world, kPGWorld);
+   if (!pWorld) return PV_STATUS_BAD_CALL;
+   delete pWorld;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFWorldAddEntity(PTWorld world, PTEntity entity, PTWorldEntity* world_entity)
+{
+   STANDIN_RECORD_CALL("PFWorldAddEntity");
+   PGWorld* pWorld = As<PGWorld>(world, kPGWorld);
+   if (!pWorld || !As<PGSolid>(entity, kPGSolid)) return PV_STATUS_BAD_CALL;
+   PGWorldEntity* pWorldEntity = new PGWorldEntity;
+   pWorldEntity->m_pWorld = pWorld;
+   pWorldEntity->m_pEntity = entity;
+   PMInitTransformMatrix(*reinterpret_cast<PTTransformMatrix*>(pWorldEntity->m_adTransform));
+   {
+      std::lock_guard<std::mutex> sLock(pWorld->m_mutex);
+      pWorld->m_sEntities.insert(pWorldEntity);
+   }
+   *world_entity = pWorldEntity;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFWorldRemoveEntity(PTWorldEntity world_entity)
+{
+   STANDIN_RECORD_CALL("PFWorldRemoveEntity");
+   PGWorldEntity* pWorldEntity = As<PGWorldEntity>(world_entity, kPGWorldEntity);
+   if (!pWorldEntity) return PV_STATUS_BAD_CALL;
+   {
+      std::lock_guard<std::mutex> sLock(pWorldEntity->m_pWorld->m_mutex);
+      pWorldEntity->m_pWorld->m_sEntities.erase(pWorldEntity);
+   }
+   delete pWorldEntity;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFWorldEntitySetTransform(PTWorldEntity world_entity, PTTransformMatrix matrix, PTPointer)
+{
+   STANDIN_RECORD_CALL("PFWorldEntitySetTransform");
+   PGWorldEntity* pWorldEntity = As<PGWorldEntity>(world_entity, kPGWorldEntity);
+   if (!pWorldEntity) return PV_STATUS_BAD_CALL;
+   memcpy(pWorldEntity->m_adTransform, matrix, sizeof(pWorldEntity->m_adTransform));
+   return PV_STATUS_OK;
+}
+
+/*********************************************************************/
+/***solids************************************************************/
+/*********************************************************************/
+
+PTStatus PFSolidCreateFromMesh(PTEnvironment env,
+                               PTNat32 n_faces,
+                               PTNat32* n_loops,
+                               PTNat32* n_vertices,
+                               PTNat32* indices,
+                               PTDouble* vertices,
+                               PTMeshSolidOpts* opts,
+                               PTSolid* solid)
+{
+   STANDIN_RECORD_CALL("PFSolidCreateFromMesh");
+   PGEnvironment* pEnvironment = As<PGEnvironment>(env, kPGEnvironment);
+   if (!pEnvironment || n_loops || n_vertices || (n_faces && (!indices || !vertices))) return PV_STATUS_BAD_CALL;
+
+   PGSolid* pSolid = new PGSolid;
+   pSolid->m_pEnvironment = pEnvironment;
+   pSolid->m_uiFaceCount = n_faces;
+   pSolid->m_pFaces = n_faces ? new PGFace[n_faces] : NULL;
+
+   // Stitch coincident vertices; the solid owns one copy of each distinct point
+   std::unordered_map<PTNat32, PTNat32> sInputToSolid;
+   std::unordered_map<VertexKey, PTNat32, VertexKeyHash> sPointToSolid;
+   unsigned long long ullStitched = 0;
+   for (PTNat32 uiCorner = 0; uiCorner < 3 * n_faces; uiCorner++)
+   {
+      PTNat32 uiInput = indices[uiCorner];
+      auto sFound = sInputToSolid.find(uiInput);
+      if (sFound == sInputToSolid.end())
+      {
+         VertexKey sKey;
+         memcpy(sKey.m_adPoint, vertices + 3 * (size_t)uiInput, sizeof(sKey.m_adPoint));
+         auto sInserted = sPointToSolid.insert(std::make_pair(sKey, (PTNat32)(pSolid->m_adVertices.size() / 3)));
+         if (sInserted.second)
+         {
+            pSolid->m_adVertices.insert(pSolid->m_adVertices.end(), sKey.m_adPoint, sKey.m_adPoint + 3);
+         }
+         else
+         {
+            ullStitched++;
+         }
+         sFound = sInputToSolid.insert(std::make_pair(uiInput, sInserted.first->second)).first;
+      }
+      PGFace& sFace = pSolid->m_pFaces[uiCorner / 3];
+      sFace.m_auiVertices[uiCorner % 3] = sFound->second;
+   }
+   g_ullStitchedVertices += ullStitched;
+
+   // Build edge adjacency; every half edge records the face across it
+   std::unordered_map<unsigned long long, PTNat32> sHalfEdges;
+   sHalfEdges.reserve(3 * (size_t)n_faces);
+   pSolid->m_auiEdgeMates.assign(3 * (size_t)n_faces, (PTNat32)-1);
+   for (PTNat32 uiFace = 0; uiFace < n_faces; uiFace++)
+   {
+      PGFace& sFace = pSolid->m_pFaces[uiFace];
+      sFace.m_pSolid = pSolid;
+      sFace.m_pAppSurface = (opts && opts->app_surfaces) ? opts->app_surfaces[uiFace] : NULL;
+      for (int i = 0; i < 3; i++)
+      {
+         PTNat32 uiFrom = sFace.m_auiVertices[i];
+         PTNat32 uiTo = sFace.m_auiVertices[(i + 1) % 3];
+         auto sMate = sHalfEdges.find(((unsigned long long)uiTo << 32) | uiFrom);
+         if (sMate != sHalfEdges.end())
+         {
+            pSolid->m_auiEdgeMates[3 * uiFace + i] = sMate->second / 3;
+            pSolid->m_auiEdgeMates[sMate->second] = uiFace;
+         }
+         sHalfEdges[((unsigned long long)uiFrom << 32) | uiTo] = 3 * uiFace + i;
+      }
+      if (opts && opts->normals && opts->normal_indices)
+      {
+         memcpy(sFace.m_adNormal, opts->normals[opts->normal_indices[3 * uiFace]], sizeof(sFace.m_adNormal));
+      }
+   }
+
+   for (int i = 0; i < 3; i++)
+   {
+      pSolid->m_adBounds[i] = n_faces ? 1e300 : 0.;
+      pSolid->m_adBounds[i + 3] = n_faces ? -1e300 : 0.;
+   }
+   for (size_t uVertex = 0; uVertex < pSolid->m_adVertices.size(); uVertex += 3)
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         if (pSolid->m_adVertices[uVertex + i] < pSolid->m_adBounds[i]) pSolid->m_adBounds[i] = pSolid->m_adVertices[uVertex + i];
+         if (pSolid->m_adVertices[uVertex + i] > pSolid->m_adBounds[i + 3]) pSolid->m_adBounds[i + 3] = pSolid->m_adVertices[uVertex + i];
+      }
+   }
+
+   pSolid->Account(n_faces * sizeof(PGFace)
+                   + pSolid->m_adVertices.capacity() * sizeof(PTDouble)
+                   + pSolid->m_auiEdgeMates.capacity() * sizeof(PTNat32));
+   *solid = pSolid;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFSolidDestroy(PTSolid solid)
+{
+   STANDIN_RECORD_CALL("PFSolidDestroy");
+   PGSolid* pSolid = As<PGSolid>(solid, kPGSolid);
+   if (!pSolid) return PV_STATUS_BAD_CALL;
+   delete pSolid;
+   return PV_STATUS_OK;
+}
+
+/*********************************************************************/
+/***groups and lists**************************************************/
+/*********************************************************************/
+
+PTStatus PFEntityGroupCreate(PTEnvironment, PTEntityGroup* group)
+{
+   STANDIN_RECORD_CALL("PFEntityGroupCreate");
+   *group = new PGEntityGroup;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEntityGroupAddEntity(PTEntityGroup group, PTEntity entity)
+{
+   STANDIN_RECORD_CALL("PFEntityGroupAddEntity");
+   PGEntityGroup* pGroup = As<PGEntityGroup>(group, kPGEntityGroup);
+   if (!pGroup || !entity) return PV_STATUS_BAD_CALL;
+   pGroup->m_apEntities.push_back(entity);
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEntityGroupDestroy(PTEntityGroup group)
+{
+   STANDIN_RECORD_CALL("PFEntityGroupDestroy");
+   PGEntityGroup* pGroup = As<PGEntityGroup>(group, kPGEntityGroup);
+   if (!pGroup) return PV_STATUS_BAD_CALL;
+   delete pGroup;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEntityCreateEntityList(PTEntity entity, PTNat32 type, PTPointer, PTEntityList* list)
+{
+   STANDIN_RECORD_CALL("PFEntityCreateEntityList");
+   PGEntityList* pList = new PGEntityList;
+   if (type == PV_ENTITY_TYPE_FACE)
+   {
+      if (PGSolid* pSolid = As<PGSolid>(entity, kPGSolid))
+      {
+         pList->m_apEntities.reserve(pSolid->m_uiFaceCount);
+         for (PTNat32 ui = 0; ui < pSolid->m_uiFaceCount; ui++)
+         {
+            pList->m_apEntities.push_back(&pSolid->m_pFaces[ui]);
+         }
+      }
+      else if (PGEntityGroup* pGroup = As<PGEntityGroup>(entity, kPGEntityGroup))
+      {
+         for (PTEntity pMember : pGroup->m_apEntities)
+         {
+            if (As<PGFace>(pMember, kPGFace)) pList->m_apEntities.push_back(pMember);
+         }
+      }
+   }
+   *list = pList;
+   return PV_STATUS_OK;
+}
+
+PTEntity PFEntityListGetFirst(PTEntityList list)
+{
+   STANDIN_RECORD_CALL("PFEntityListGetFirst");
+   PGEntityList* pList = As<PGEntityList>(list, kPGEntityList);
+   if (!pList || pList->m_apEntities.empty()) return PV_ENTITY_NULL;
+   pList->m_uCursor = 0;
+   return pList->m_apEntities[0];
+}
+
+PTEntity PFEntityListGetNext(PTEntityList list, PTEntity entity)
+{
+   STANDIN_RECORD_CALL("PFEntityListGetNext");
+   PGEntityList* pList = As<PGEntityList>(list, kPGEntityList);
+   if (!pList) return PV_ENTITY_NULL;
+   size_t uPosition = pList->m_uCursor;
+   if (uPosition >= pList->m_apEntities.size() || pList->m_apEntities[uPosition] != entity)
+   {
+      for (uPosition = 0; uPosition < pList->m_apEntities.size() && pList->m_apEntities[uPosition] != entity; uPosition++);
+   }
+   if (uPosition + 1 >= pList->m_apEntities.size()) return PV_ENTITY_NULL;
+   pList->m_uCursor = uPosition + 1;
+   return pList->m_apEntities[uPosition + 1];
+}
+
+PTStatus PFEntityListDestroy(PTEntityList list, PTNat32)
+{
+   STANDIN_RECORD_CALL("PFEntityListDestroy");
+   PGEntityList* pList = As<PGEntityList>(list, kPGEntityList);
+   if (!pList) return PV_STATUS_BAD_CALL;
+   delete pList;
+   return PV_STATUS_OK;
+}
+
+/*********************************************************************/
+/***properties********************************************************/
+/*********************************************************************/
+
+PTPointer PFEntityGetPointerProperty(PTEntity entity, PTNat32 property)
+{
+   STANDIN_RECORD_CALL("PFEntityGetPointerProperty");
+   if (property == PV_FACE_PROP_APP_SURFACE)
+   {
+      PGFace* pFace = As<PGFace>(entity, kPGFace);
+      return pFace ? pFace->m_pAppSurface : NULL;
+   }
+   if (property == PV_SOLID_PROP_APP_DATA)
+   {
+      PGSolid* pSolid = As<PGSolid>(entity, kPGSolid);
+      return pSolid ? pSolid->m_pAppData : NULL;
+   }
+   if (property == PV_ENV_PROP_ERROR_REPORT_CB)
+   {
+      PGEnvironment* pEnvironment = As<PGEnvironment>(entity, kPGEnvironment);
+      return pEnvironment ? pEnvironment->m_pErrorReportCb : NULL;
+   }
+   return NULL;
+}
+
+PTStatus PFEntitySetPointerProperty(PTEntity entity, PTNat32 property, PTPointer value)
+{
+   STANDIN_RECORD_CALL("PFEntitySetPointerProperty");
+   if (property == PV_FACE_PROP_APP_SURFACE)
+   {
+      PGFace* pFace = As<PGFace>(entity, kPGFace);
+      if (!pFace) return PV_STATUS_BAD_CALL;
+      pFace->m_pAppSurface = value;
+      return PV_STATUS_OK;
+   }
+   if (property == PV_SOLID_PROP_APP_DATA)
+   {
+      PGSolid* pSolid = As<PGSolid>(entity, kPGSolid);
+      if (!pSolid) return PV_STATUS_BAD_CALL;
+      pSolid->m_pAppData = value;
+      return PV_STATUS_OK;
+   }
+   if (property == PV_ENV_PROP_ERROR_REPORT_CB)
+   {
+      PGEnvironment* pEnvironment = As<PGEnvironment>(entity, kPGEnvironment);
+      if (!pEnvironment) return PV_STATUS_BAD_CALL;
+      pEnvironment->m_pErrorReportCb = value;
+      return PV_STATUS_OK;
+   }
+   return PV_STATUS_BAD_CALL;
+}
+
+PTEntity PFEntityGetEntityProperty(PTEntity entity, PTNat32 property)
+{
+   STANDIN_RECORD_CALL("PFEntityGetEntityProperty");
+   switch (property)
+   {
+      case PV_FACE_PROP_SOLID:
+      {
+         PGFace* pFace = As<PGFace>(entity, kPGFace);
+         return pFace ? pFace->m_pSolid : PV_ENTITY_NULL;
+      }
+      case PV_SOLID_PROP_ENVIRONMENT:
+      {
+         PGSolid* pSolid = As<PGSolid>(entity, kPGSolid);
+         return pSolid ? pSolid->m_pEnvironment : PV_ENTITY_NULL;
+      }
+      case PV_WENTITY_PROP_ENTITY:
+      {
+         PGWorldEntity* pWorldEntity = As<PGWorldEntity>(entity, kPGWorldEntity);
+         return pWorldEntity ? pWorldEntity->m_pEntity : PV_ENTITY_NULL;
+      }
+      case PV_WENTITY_PROP_STYLE:
+      {
+         PGWorldEntity* pWorldEntity = As<PGWorldEntity>(entity, kPGWorldEntity);
+         return pWorldEntity ? pWorldEntity->m_pStyle : PV_ENTITY_NULL;
+      }
+      case PV_RSTYLE_PROP_POLYGON_STYLE:
+      {
+         PGRenderStyle* pStyle = As<PGRenderStyle>(entity, kPGRenderStyle);
+         if (!pStyle) return PV_ENTITY_NULL;
+         if (!pStyle->m_pPolygonStyle) pStyle->m_pPolygonStyle = new PGPolygonStyle;
+         return pStyle->m_pPolygonStyle;
+      }
+      case PV_RSTYLE_PROP_EDGE_STYLE:
+      {
+         PGRenderStyle* pStyle = As<PGRenderStyle>(entity, kPGRenderStyle);
+         if (!pStyle) return PV_ENTITY_NULL;
+         if (!pStyle->m_pEdgeStyle) pStyle->m_pEdgeStyle = new PGEdgeStyle;
+         return pStyle->m_pEdgeStyle;
+      }
+      default:
+         return PV_ENTITY_NULL;
+   }
+}
+
+PTStatus PFEntitySetEntityProperty(PTEntity entity, PTNat32 property, PTEntity value)
+{
+   STANDIN_RECORD_CALL("PFEntitySetEntityProperty");
+   switch (property)
+   {
+      case PV_WENTITY_PROP_STYLE:
+      {
+         PGWorldEntity* pWorldEntity = As<PGWorldEntity>(entity, kPGWorldEntity);
+         if (!pWorldEntity) return PV_STATUS_BAD_CALL;
+         pWorldEntity->m_pStyle = value;
+         return PV_STATUS_OK;
+      }
+      case PV_RSTYLE_PROP_POLYGON_STYLE:
+      {
+         PGRenderStyle* pStyle = As<PGRenderStyle>(entity, kPGRenderStyle);
+         PGPolygonStyle* pPolygonStyle = As<PGPolygonStyle>(value, kPGPolygonStyle);
+         if (!pStyle) return PV_STATUS_BAD_CALL;
+         if (!pStyle->m_pPolygonStyle) pStyle->m_pPolygonStyle = new PGPolygonStyle;
+         if (pPolygonStyle)
+         {
+            memcpy(pStyle->m_pPolygonStyle->m_afColour, pPolygonStyle->m_afColour, sizeof(pPolygonStyle->m_afColour));
+            memcpy(pStyle->m_pPolygonStyle->m_afBackColour, pPolygonStyle->m_afBackColour, sizeof(pPolygonStyle->m_afBackColour));
+            pStyle->m_pPolygonStyle->m_uiTransparency = pPolygonStyle->m_uiTransparency;
+            pStyle->m_pPolygonStyle->m_bTwoSided = pPolygonStyle->m_bTwoSided;
+         }
+         return PV_STATUS_OK;
+      }
+      case PV_RSTYLE_PROP_EDGE_STYLE:
+      {
+         PGRenderStyle* pStyle = As<PGRenderStyle>(entity, kPGRenderStyle);
+         if (!pStyle) return PV_STATUS_BAD_CALL;
+         if (!value)
+         {
+            delete pStyle->m_pEdgeStyle;
+            pStyle->m_pEdgeStyle = NULL;
+         }
+         return PV_STATUS_OK;
+      }
+      default:
+         return PV_STATUS_BAD_CALL;
+   }
+}
+
+PTStatus PFEntitySetColourProperty(PTEntity entity, PTNat32 property, PTNat32 type, const void* colour)
+{
+   STANDIN_RECORD_CALL("PFEntitySetColourProperty");
+   if (PGPolygonStyle* pPolygonStyle = As<PGPolygonStyle>(entity, kPGPolygonStyle))
+   {
+      ReadColour(type, colour, property == PV_PSTYLE_PROP_BACK_COLOUR ? pPolygonStyle->m_afBackColour : pPolygonStyle->m_afColour);
+      return PV_STATUS_OK;
+   }
+   if (PGEdgeStyle* pEdgeStyle = As<PGEdgeStyle>(entity, kPGEdgeStyle))
+   {
+      ReadColour(type, colour, pEdgeStyle->m_afColour);
+      return PV_STATUS_OK;
+   }
+   return PV_STATUS_BAD_CALL;
+}
+
+PTStatus PFEntitySetNat32Property(PTEntity entity, PTNat32 property, PTNat32 value)
+{
+   STANDIN_RECORD_CALL("PFEntitySetNat32Property");
+   PGPolygonStyle* pPolygonStyle = As<PGPolygonStyle>(entity, kPGPolygonStyle);
+   if (!pPolygonStyle || property != PV_PSTYLE_PROP_TRANSPARENCY) return PV_STATUS_BAD_CALL;
+   pPolygonStyle->m_uiTransparency = value;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEntitySetBooleanProperty(PTEntity entity, PTNat32 property, PTBoolean value)
+{
+   STANDIN_RECORD_CALL("PFEntitySetBooleanProperty");
+   PGPolygonStyle* pPolygonStyle = As<PGPolygonStyle>(entity, kPGPolygonStyle);
+   if (!pPolygonStyle || property != PV_PSTYLE_PROP_2_SIDES) return PV_STATUS_BAD_CALL;
+   pPolygonStyle->m_bTwoSided = value;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFEntityGetBoundsProperty(PTEntity entity, PTNat32 property, PTBounds bounds)
+{
+   STANDIN_RECORD_CALL("PFEntityGetBoundsProperty");
+   if (PGSolid* pSolid = As<PGSolid>(entity, kPGSolid))
+   {
+      memcpy(bounds, pSolid->m_adBounds, sizeof(PTBounds));
+      return PV_STATUS_OK;
+   }
+   PGWorld* pWorld = As<PGWorld>(entity, kPGWorld);
+   if (!pWorld || property != PV_WORLD_PROP_BOUNDS) return PV_STATUS_BAD_CALL;
+
+   // Bounds of the transformed solid bounds of every world entity
+   for (int i = 0; i < 3; i++)
+   {
+      bounds[i] = 1e300;
+      bounds[i + 3] = -1e300;
+   }
+   std::lock_guard<std::mutex> sLock(pWorld->m_mutex);
+   for (PGWorldEntity* pWorldEntity : pWorld->m_sEntities)
+   {
+      PGSolid* pSolid = As<PGSolid>(pWorldEntity->m_pEntity, kPGSolid);
+      if (!pSolid || !pSolid->m_uiFaceCount) continue;
+      const PTDouble* m = pWorldEntity->m_adTransform;
+      for (int iCorner = 0; iCorner < 8; iCorner++)
+      {
+         PTDouble adPoint[3] = { pSolid->m_adBounds[(iCorner & 1) ? 3 : 0],
+                                 pSolid->m_adBounds[(iCorner & 2) ? 4 : 1],
+                                 pSolid->m_adBounds[(iCorner & 4) ? 5 : 2] };
+         for (int i = 0; i < 3; i++)
+         {
+            PTDouble dValue = m[i] * adPoint[0] + m[4 + i] * adPoint[1] + m[8 + i] * adPoint[2] + m[12 + i];
+            if (dValue < bounds[i]) bounds[i] = dValue;
+            if (dValue > bounds[i + 3]) bounds[i + 3] = dValue;
+         }
+      }
+   }
+   return PV_STATUS_OK;
+}
+
+/*********************************************************************/
+/***render styles*****************************************************/
+/*********************************************************************/
+
+PTStatus PFRenderStyleCreate(PTEnvironment, PTRenderStyle* style)
+{
+   STANDIN_RECORD_CALL("PFRenderStyleCreate");
+   PGRenderStyle* pStyle = new PGRenderStyle;
+   pStyle->m_pPolygonStyle = new PGPolygonStyle;
+   pStyle->m_pEdgeStyle = new PGEdgeStyle;
+   *style = pStyle;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFRenderStyleDestroy(PTRenderStyle style)
+{
+   STANDIN_RECORD_CALL("PFRenderStyleDestroy");
+   PGRenderStyle* pStyle = As<PGRenderStyle>(style, kPGRenderStyle);
+   if (!pStyle) return PV_STATUS_BAD_CALL;
+   delete pStyle;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFPolygonStyleCreate(PTEnvironment, PTPolygonStyle* style)
+{
+   STANDIN_RECORD_CALL("PFPolygonStyleCreate");
+   *style = new PGPolygonStyle;
+   return PV_STATUS_OK;
+}
+
+PTStatus PFPolygonStyleDestroy(PTPolygonStyle style)
+{
+   STANDIN_RECORD_CALL("PFPolygonStyleDestroy");
+   PGPolygonStyle* pStyle = As<PGPolygonStyle>(style, kPGPolygonStyle);
+   if (!pStyle) return PV_STATUS_BAD_CALL;
+   delete pStyle;
+   return PV_STATUS_OK;
+}
@@ -0,0 +1,126 @@
+/*
+*   Description:
+*
+*      Exchange and Polygonica stand-in recorder
+*      Call counters shared by the stand-in implementations.
+*/
+
+#include "StandInRecorderInternal.h"
+
+#include <atomic>
+#include <mutex>
+#include <string.h>
+
+namespace
+{
+   const int kMaxCalls = 256;
+
+   struct CallTable
+   {
+      std::mutex m_mutex;
+      int m_iSize = 0;
+      const char* m_apcNames[kMaxCalls];
+      std::atomic<unsigned long long> m_aullCounts[kMaxCalls];
+   };
+
+   CallTable& GetCallTable()
+   {
+      static CallTable sTable;
+      return sTable;
+   }
+}
+
+int StandInRegisterCall(const char* pcName)
+{
+   CallTable& sTable = GetCallTable();
+   std::lock_guard<std::mutex> sLock(sTable.m_mutex);
+   for (int i = 0; i < sTable.m_iSize; i++)
+   {
+      if (strcmp(sTable.m_apcNames[i], pcName) == 0)
+      {
+         return i;
+      }
+   }
+   if (sTable.m_iSize == kMaxCalls)
+   {
+      return kMaxCalls - 1;
+   }
+   sTable.m_apcNames[sTable.m_iSize] = pcName;
+   sTable.m_aullCounts[sTable.m_iSize] = 0;
+   return sTable.m_iSize++;
+}
+
+void StandInCountCall(int iCall)
+{
+   GetCallTable().m_aullCounts[iCall].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<StandInCallCount> StandInGetCallCounts()
+{
+   CallTable& sTable = GetCallTable();
+   std::lock_guard<std::mutex> sLock(sTable.m_mutex);
+   std::vector<StandInCallCount> asCounts;
+   for (int i = 0; i < sTable.m_iSize; i++)
+   {
+      unsigned long long ullCount = sTable.m_aullCounts[i].load();
+      if (ullCount)
+      {
+         asCounts.push_back({ sTable.m_apcNames[i], ullCount });
+      }
+   }
+   return asCounts;
+}
+
+unsigned long long StandInGetCallCount(const char* pcName)
+{
+   for (const StandInCallCount& sCount : StandInGetCallCounts())
+   {
+      if (strcmp(sCount.m_pcName, pcName) == 0)
+      {
+         return sCount.m_ullCount;
+      }
+   }
+   return 0;
+}
+
+static unsigned long long stSumCallsWithPrefix(const char* pcPrefix)
+{
+   unsigned long long ullTotal = 0;
+   for (const StandInCallCount& sCount : StandInGetCallCounts())
+   {
+      if (strncmp(sCount.m_pcName, pcPrefix, strlen(pcPrefix)) == 0)
+      {
+         ullTotal += sCount.m_ullCount;
+      }
+   }
+   return ullTotal;
+}
+
+unsigned long long StandInGetExchangeCallCount()
+{
+   return stSumCallsWithPrefix("A3D");
+}
+
+unsigned long long StandInGetPolygonicaCallCount()
+{
+   return stSumCallsWithPrefix("PF");
+}
+
+void StandInResetCallCounts()
+{
+   CallTable& sTable = GetCallTable();
+   std::lock_guard<std::mutex> sLock(sTable.m_mutex);
+   for (int i = 0; i < sTable.m_iSize; i++)
+   {
+      sTable.m_aullCounts[i] = 0;
+   }
+   StandInResetStitchedVertexCount();
+}
+
+void StandInPrintCallCounts(FILE* pFile)
+{
+   for (const StandInCallCount& sCount : StandInGetCallCounts())
+   {
+      fprintf(pFile, "%-40s %llu\n", sCount.m_pcName, sCount.m_ullCount);
+   }
+}
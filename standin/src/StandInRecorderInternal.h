@@ -0,0 +1,18 @@
+/*
+*   Description:
+*
+*      Exchange and Polygonica stand-in recorder
+*      Internal helpers shared by the stand-in implementations.
+*/
+#pragma once
+
+#include "StandInRecorder.h"
+
+int StandInRegisterCall(const char* pcName);
+void StandInCountCall(int iCall);
+void StandInResetStitchedVertexCount();
+
+/* Counts one call of the enclosing stand-in function */
+#define STANDIN_RECORD_CALL(name)                              \
+   static const int s_iStandInCall = StandInRegisterCall(name); \
+   StandInCountCall(s_iStandInCall)